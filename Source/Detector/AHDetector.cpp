@@ -6,12 +6,21 @@
 #include <cassert>
 #include <cmath>
 #include <complex>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <random>
+#include <string>
+
+#include "Engine/NoiseAugmentation.hpp"
 
 #include "AHDetector.hpp"
+#include "FFTWPlannerLock.hpp"
+#include "Hasher.hpp"
+#include "NeuralNetworkTrainer.hpp"
+#include "Trace.hpp"
 
 
 AHDetector::AHDetector()
@@ -19,11 +28,17 @@ AHDetector::AHDetector()
   , realBuffer(bufferSize)
   , complexBuffer(bufferSize / 2 + 1)
   , amplitudeBuffer(bufferSize / 2 + 1)
-  , fftPlan(fftw_plan_dft_r2c_1d(bufferSize, realBuffer.data(), reinterpret_cast<fftw_complex*>(complexBuffer.data()), FFTW_ESTIMATE))
+  , amplitudePrefixSums(bufferSize / 2 + 2)
   , training(false)
+  , currentTrainingFile(0)
+  , trainingData(numOfFeatures)
   , ann(nullptr)
 {
   static_assert(bufferSize % 2 == 0, "The buffer size has to be even!");
+  {
+    FFTWPlannerLock lock;
+    fftPlan = fftw_plan_dft_r2c_1d(bufferSize, realBuffer.data(), reinterpret_cast<fftw_complex*>(complexBuffer.data()), FFTW_ESTIMATE);
+  }
   if (useNN)
   {
     ann = fann_create_from_file("../NeuralNetworks/AHDetector.net");
@@ -65,6 +80,14 @@ AHDetector::AHDetector()
         ann = nullptr;
       }
     }
+    if (ann != nullptr && !network.load(ann, means.data(), stddevs.data()))
+    {
+      std::cerr << "AHDetector: Falling back to FANN for inference!\n";
+    }
+  }
+  else if (!tree.load("../DecisionTrees/AHDetector.tree", numOfFeatures))
+  {
+    std::cerr << "AHDetector: Could not load decision tree, using the built-in one!\n";
   }
   for (unsigned int i = 0; i < bufferSize; i++)
   {
@@ -75,193 +98,226 @@ AHDetector::AHDetector()
 
 AHDetector::~AHDetector()
 {
-  if (useNN && ann != nullptr)
+  if (ann != nullptr)
   {
-    fann_save(ann, "../NeuralNetworks/AHDetector.net");
     fann_destroy(ann);
     ann = nullptr;
-
-    std::ofstream norm("../NeuralNetworks/AHDetector.norm");
-    if (norm.is_open())
-    {
-      for (unsigned int i = 0; i < numOfFeatures; i++)
-      {
-        norm << means[i] << ' ' << stddevs[i] << '\n';
-      }
-      norm.close();
-    }
-    else
-    {
-      std::cerr << "AHDetector: Could not save normalization parameters!\n";
-    }
   }
-  assert(ann == nullptr);
+  FFTWPlannerLock lock;
   fftw_destroy_plan(fftPlan);
 }
 
-void AHDetector::evaluate(EvaluationHandle& eh)
+bool AHDetector::setup(const unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize)
 {
   if (useNN && !training && ann == nullptr)
   {
-    return;
+    return false;
   }
-  std::array<float, bufferSize> samples;
-  const std::vector<std::complex<double>>& freqData = complexBuffer;
-  const double freqResolution = static_cast<double>(bufferSize) / eh.getSampleRate();
-  const unsigned int minFreqIndex = static_cast<unsigned int>(std::ceil(minFrequency * freqResolution));
-  const unsigned int maxFreqIndex = static_cast<unsigned int>(std::ceil(maxFrequency * freqResolution));
+  const unsigned int hopSize = parameters.hopSize;
+  if (hopSize == 0 || bufferSize % hopSize != 0)
+  {
+    std::cerr << "AHDetector: The buffer size has to be a multiple of the hop size!\n";
+    return false;
+  }
+  const double freqResolution = static_cast<double>(bufferSize) / sampleRate;
+  minFreqIndex = static_cast<unsigned int>(std::ceil(parameters.minFrequency * freqResolution));
+  maxFreqIndex = static_cast<unsigned int>(std::ceil(parameters.maxFrequency * freqResolution));
   if (maxFreqIndex >= complexBuffer.size())
   {
     std::cerr << "AHDetector: maxFreqIndex " << maxFreqIndex << " is larger than the Nyquist frequency!\n";
-    return;
+    return false;
   }
+  // Consecutive buffers overlap by all but one hop.
+  streamWindowSize = bufferSize;
+  streamHopSize = hopSize;
+  return true;
+}
+
+void AHDetector::processWindow(const float* window)
+{
+  const std::vector<std::complex<double>>& freqData = complexBuffer;
+  TRACE_SCOPE("AHDetector::processWindow");
 
-  while (eh.readSingleChannel(samples.data(), bufferSize) == bufferSize)
+  // 1. Perform discrete fourier (with Hann window) transform to obtain frequency spectrum.
+  TRACE_STAGE(stage, "AHDetector: 1. FFT");
+  for (unsigned int i = 0; i < bufferSize; i++)
   {
-    // 1. Perform discrete fourier (with Hann window) transform to obtain frequency spectrum.
-    for (unsigned int i = 0; i < realBuffer.size(); i++)
-    {
-      realBuffer[i] = samples[i] * hannWindow[i];
-    }
-    fftw_execute(fftPlan);
+    realBuffer[i] = window[i] * hannWindow[i];
+  }
+  fftw_execute(fftPlan);
 
-    // 2. Precompute the absolute values of the spectrum (normalized by buffer size).
-    for (unsigned int i = 0; i < freqData.size(); i++)
-    {
-      amplitudeBuffer[i] = std::abs(freqData[i]) / (bufferSize / 2);
-    }
+  // 2. Precompute the absolute values of the spectrum (normalized by buffer size) and their prefix sums.
+  // The prefix sums turn all band sums below into two lookups instead of loops over the bands.
+  TRACE_NEXT_STAGE(stage, "AHDetector: 2. Amplitudes");
+  amplitudePrefixSums[0] = 0;
+  for (unsigned int i = 0; i < freqData.size(); i++)
+  {
+    amplitudeBuffer[i] = std::abs(freqData[i]) / (bufferSize / 2);
+    amplitudePrefixSums[i + 1] = amplitudePrefixSums[i] + amplitudeBuffer[i];
+  }
 
-    // 3. Find the frequency at which the amplitude is highest in a configurable band.
-    double maxAmplitude = minRequiredAmplitude;
-    unsigned int maxAmplitudeFreqIndex = 0;
-    for (unsigned int i = minFreqIndex; i < maxFreqIndex; i++)
+  // 3. Find the frequency at which the amplitude is highest in a configurable band.
+  TRACE_NEXT_STAGE(stage, "AHDetector: 3-4. Peak");
+  double maxAmplitude = parameters.minRequiredAmplitude;
+  unsigned int maxAmplitudeFreqIndex = 0;
+  for (unsigned int i = minFreqIndex; i < maxFreqIndex; i++)
+  {
+    const double amplitude = amplitudeBuffer[i];
+    if (amplitude > maxAmplitude)
     {
-      const double amplitude = amplitudeBuffer[i];
-      if (amplitude > maxAmplitude)
-      {
-        maxAmplitude = amplitude;
-        maxAmplitudeFreqIndex = i;
-      }
+      maxAmplitude = amplitude;
+      maxAmplitudeFreqIndex = i;
     }
+  }
 
-    // 4. If a configurable amplitude has not been surpassed, the buffer is rejected.
-    if (maxAmplitudeFreqIndex == 0)
-    {
-      continue;
-    }
+  // 4. If a configurable amplitude has not been surpassed, the buffer is rejected.
+  if (maxAmplitudeFreqIndex == 0)
+  {
+    score(0.f, -static_cast<int>(bufferSize) / 2);
+    return;
+  }
 
-    // 5. Determine power in the range of the base frequency while detecting its boundaries.
-    double whistlePower[2] = { amplitudeBuffer[maxAmplitudeFreqIndex], 0 };
-    double stopBandPower[2] = { 0, 0 };
-    const unsigned int i2 = (maxFreqIndex - minFreqIndex) / 2;
-    const unsigned int lowerBoundLowerBound = std::max(maxAmplitudeFreqIndex - i2, 1U);
-    const unsigned int upperBoundUpperBound = std::min(maxAmplitudeFreqIndex + i2, static_cast<unsigned int>(freqData.size()));
-    unsigned int upperBound, lowerBound;
-    unsigned int lowerBoundAtMinLowerPower = 0, upperBoundAtMinUpperPower = 0;
-    double minLowerPower = std::numeric_limits<double>::max(), minUpperPower = std::numeric_limits<double>::max();
-    double whistlePowerAtMinLowerPower = 0.f, whistlePowerAtMinUpperPower = 0.f;
-    for (lowerBound = maxAmplitudeFreqIndex - 1; lowerBound > lowerBoundLowerBound; lowerBound--)
+  // 5. Determine power in the range of the base frequency while detecting its boundaries.
+  TRACE_NEXT_STAGE(stage, "AHDetector: 5. Fundamental band");
+  double whistlePower[2] = { amplitudeBuffer[maxAmplitudeFreqIndex], 0 };
+  double stopBandPower[2] = { 0, 0 };
+  const unsigned int i2 = (maxFreqIndex - minFreqIndex) / 2;
+  const unsigned int lowerBoundLowerBound = std::max(maxAmplitudeFreqIndex - i2, 1U);
+  const unsigned int upperBoundUpperBound = std::min(maxAmplitudeFreqIndex + i2, static_cast<unsigned int>(freqData.size()));
+  unsigned int upperBound, lowerBound;
+  unsigned int lowerBoundAtMinLowerPower = 0, upperBoundAtMinUpperPower = 0;
+  double minLowerPower = std::numeric_limits<double>::max(), minUpperPower = std::numeric_limits<double>::max();
+  double whistlePowerAtMinLowerPower = 0.f, whistlePowerAtMinUpperPower = 0.f;
+  for (lowerBound = maxAmplitudeFreqIndex - 1; lowerBound > lowerBoundLowerBound; lowerBound--)
+  {
+    whistlePower[0] += amplitudeBuffer[lowerBound];
+    if (amplitudeBuffer[lowerBound] < maxAmplitude * parameters.minAmplitudeOverMaxAmplitude)
     {
-      whistlePower[0] += amplitudeBuffer[lowerBound];
-      if (amplitudeBuffer[lowerBound] < maxAmplitude * minAmplitudeOverMaxAmplitude)
-      {
-        break;
-      }
-      if (amplitudeBuffer[lowerBound] < minLowerPower)
-      {
-        minLowerPower = amplitudeBuffer[lowerBound];
-        lowerBoundAtMinLowerPower = lowerBound;
-        whistlePowerAtMinLowerPower = whistlePower[0];
-      }
+      break;
     }
-    if (lowerBound == lowerBoundLowerBound)
+    if (amplitudeBuffer[lowerBound] < minLowerPower)
     {
-      lowerBound = lowerBoundAtMinLowerPower;
-      whistlePower[0] = whistlePowerAtMinLowerPower;
+      minLowerPower = amplitudeBuffer[lowerBound];
+      lowerBoundAtMinLowerPower = lowerBound;
+      whistlePowerAtMinLowerPower = whistlePower[0];
     }
-    for (upperBound = maxAmplitudeFreqIndex + 1; upperBound < upperBoundUpperBound; upperBound++)
+  }
+  if (lowerBound == lowerBoundLowerBound)
+  {
+    lowerBound = lowerBoundAtMinLowerPower;
+    whistlePower[0] = whistlePowerAtMinLowerPower;
+  }
+  for (upperBound = maxAmplitudeFreqIndex + 1; upperBound < upperBoundUpperBound; upperBound++)
+  {
+    whistlePower[0] += amplitudeBuffer[upperBound];
+    if (amplitudeBuffer[upperBound] < maxAmplitude * parameters.minAmplitudeOverMaxAmplitude)
     {
-      whistlePower[0] += amplitudeBuffer[upperBound];
-      if (amplitudeBuffer[upperBound] < maxAmplitude * minAmplitudeOverMaxAmplitude)
-      {
-        break;
-      }
-      if (amplitudeBuffer[upperBound] < minUpperPower)
-      {
-        minUpperPower = amplitudeBuffer[upperBound];
-        upperBoundAtMinUpperPower = upperBound;
-        whistlePowerAtMinUpperPower = whistlePower[0];
-      }
+      break;
     }
-    if (upperBound == upperBoundUpperBound)
+    if (amplitudeBuffer[upperBound] < minUpperPower)
     {
-      upperBound = upperBoundAtMinUpperPower;
-      whistlePower[0] = whistlePowerAtMinUpperPower;
+      minUpperPower = amplitudeBuffer[upperBound];
+      upperBoundAtMinUpperPower = upperBound;
+      whistlePowerAtMinUpperPower = whistlePower[0];
     }
-    assert(upperBound > lowerBound);
+  }
+  if (upperBound == upperBoundUpperBound)
+  {
+    upperBound = upperBoundAtMinUpperPower;
+    whistlePower[0] = whistlePowerAtMinUpperPower;
+  }
+  assert(upperBound > lowerBound);
 
-    // 6. Determine power in the rest the second harmonic band and in between and above.
-    const int minFreqIndex2 = 2 * maxAmplitudeFreqIndex - (upperBound - lowerBound) / 4;
-    const int maxFreqIndex2 = 2 * maxAmplitudeFreqIndex + (upperBound - lowerBound) / 4;
-    assert(minFreqIndex2 >= 0 && maxFreqIndex2 <= static_cast<int>(freqData.size()));
-    for (int i = upperBound; i < minFreqIndex2; i++)
-    {
-      stopBandPower[0] += amplitudeBuffer[i];
-    }
-    for (int i = minFreqIndex2; i < maxFreqIndex2; i++)
-    {
-      whistlePower[1] += amplitudeBuffer[i];
-    }
-    for (int i = maxFreqIndex2; i < static_cast<int>(freqData.size()); i++)
-    {
-      stopBandPower[1] += amplitudeBuffer[i];
-    }
+  // 6. Determine power in the rest the second harmonic band and in between and above.
+  TRACE_NEXT_STAGE(stage, "AHDetector: 6-8. Features");
+  const int minFreqIndex2 = 2 * maxAmplitudeFreqIndex - (upperBound - lowerBound) / 4;
+  const int maxFreqIndex2 = 2 * maxAmplitudeFreqIndex + (upperBound - lowerBound) / 4;
+  assert(minFreqIndex2 >= 0 && maxFreqIndex2 <= static_cast<int>(freqData.size()));
+  stopBandPower[0] += bandSum(upperBound, static_cast<unsigned int>(std::max(minFreqIndex2, static_cast<int>(upperBound))));
+  whistlePower[1] += bandSum(static_cast<unsigned int>(minFreqIndex2), static_cast<unsigned int>(maxFreqIndex2));
+  stopBandPower[1] += bandSum(static_cast<unsigned int>(maxFreqIndex2), static_cast<unsigned int>(freqData.size()));
 
-    // 7. Normalize the power to their ranges.
-    const double whistleBandRange = std::max(upperBound - lowerBound, 1U);
-    const double stopBandRange = std::max(minFreqIndex2 - upperBound, 1U);
-    const double whistleBandRange2 = std::max(maxFreqIndex2 - minFreqIndex2, 1);
-    const double stopBandRange2 = std::max(static_cast<int>(freqData.size()) - maxFreqIndex2, 1);
-    whistlePower[0] /= whistleBandRange;
-    whistlePower[1] /= whistleBandRange2;
-    stopBandPower[0] /= stopBandRange;
-    stopBandPower[1] /= stopBandRange2;
+  // 7. Normalize the power to their ranges.
+  const double whistleBandRange = std::max(upperBound - lowerBound, 1U);
+  const double stopBandRange = std::max(minFreqIndex2 - upperBound, 1U);
+  const double whistleBandRange2 = std::max(maxFreqIndex2 - minFreqIndex2, 1);
+  const double stopBandRange2 = std::max(static_cast<int>(freqData.size()) - maxFreqIndex2, 1);
+  whistlePower[0] /= whistleBandRange;
+  whistlePower[1] /= whistleBandRange2;
+  stopBandPower[0] /= stopBandRange;
+  stopBandPower[1] /= stopBandRange2;
 
-    // 8. Compute feature vector.
-    FeatureVector features;
-    features[0] = maxAmplitude;
-    features[1] = whistlePower[0] / stopBandPower[0];
-    features[2] = whistlePower[1] / stopBandPower[0];
-    features[3] = (whistlePower[0] + whistlePower[1]) / (stopBandPower[0] + stopBandPower[1]);
-    features[4] = stopBandPower[0] / stopBandPower[1];
-    features[5] = whistlePower[0] / whistlePower[1];
+  // 8. Compute feature vector.
+  FeatureVector features;
+  features[0] = maxAmplitude;
+  features[1] = whistlePower[0] / stopBandPower[0];
+  features[2] = whistlePower[1] / stopBandPower[0];
+  features[3] = (whistlePower[0] + whistlePower[1]) / (stopBandPower[0] + stopBandPower[1]);
+  features[4] = stopBandPower[0] / stopBandPower[1];
+  features[5] = whistlePower[0] / whistlePower[1];
 
-    // 8b. During training, store the feature vector including its annotated result.
-    if (training)
-    {
-      const int label = eh.insideWhistle(-static_cast<int>(bufferSize) / 2);
-      trainingExamples.emplace_back();
-      TrainingExample& te = trainingExamples.back();
-      te.input = features;
-      te.output = (label != 0);
-      continue;
-    }
+  // 8b. During training, store the feature vector including its annotated result.
+  if (training)
+  {
+    const int offset = -static_cast<int>(bufferSize) / 2;
+    trainingData.append(features.data(), insideWhistle(offset) != 0, currentTrainingFile, 0,
+                        static_cast<unsigned int>(static_cast<int>(getPosition()) + offset));
+    return;
+  }
 
-    // 9. Run classifier.
-    const bool isWhistle = useNN ? classifyNN(features) : classifyJ48(features);
-    if (isWhistle)
-    {
-      eh.report(-static_cast<int>(bufferSize) / 2);
-    }
+  // 9. Run classifier.
+  TRACE_NEXT_STAGE(stage, "AHDetector: 9. Classifier");
+  // The decision tree only yields a binary decision, so its score is either 0 or 1.
+  const float value = useNN ? runNN(features) : (classifyJ48(features) ? 1.f : 0.f);
+  score(value, -static_cast<int>(bufferSize) / 2);
+  if (useNN ? value > nnThreshold : value > 0.f)
+  {
+    report(-static_cast<int>(bufferSize) / 2);
   }
 }
 
-void AHDetector::trainOnDatabase(const SampleDatabase& db)
+void AHDetector::trainOnDatabase(const SampleDatabase& db, const NoiseAugmentation* augmentation)
 {
-  // 1. Evaluate this detector in training mode.
-  training = true;
-  evaluateOnDatabase(db);
-  training = false;
+  // 1. Read the features from the cache or evaluate this detector in training mode (also on the noisy copies) and cache them.
+  ParameterMap extractorParameters = parameters.get();
+  extractorParameters["bufferSize"] = bufferSize;
+  std::uint64_t cacheKey = FeatureCache::computeKey(db, "AHDetector", featureVersion, extractorParameters);
+  if (augmentation != nullptr)
+  {
+    Hasher hasher;
+    hasher.add(cacheKey);
+    hasher.add(augmentation->key);
+    cacheKey = hasher.hash;
+  }
+  const std::string cacheFileName = FeatureCache::getFileName("../FeatureCaches", "AHDetector", cacheKey);
+  if (trainingData.open(cacheFileName, cacheKey))
+  {
+    std::cout << "AHDetector: Read " << trainingData.size() << " feature vectors from " << cacheFileName << "!\n";
+  }
+  else
+  {
+    trainingData.clear();
+    training = true;
+    // Every feature vector records the index of its file in the database, also if it stems from a noisy copy.
+    for (int i = 0; i < db.audioFiles.size(); i++)
+    {
+      currentTrainingFile = static_cast<unsigned int>(i);
+      EvaluationHandle eh(db.audioFiles[i]);
+      evaluate(eh);
+    }
+    if (augmentation != nullptr)
+    {
+      augmentation->augment(*this, db, [this](const unsigned int file)
+      {
+        currentTrainingFile = file;
+      });
+    }
+    training = false;
+    if (!trainingData.save(cacheFileName, cacheKey))
+    {
+      std::cerr << "AHDetector: Could not save feature cache!\n";
+    }
+  }
 
   // 2. Call the classifier-specific training method.
   if (useNN)
@@ -274,11 +330,56 @@ void AHDetector::trainOnDatabase(const SampleDatabase& db)
   }
 
   // 3. Clear the collected training examples.
-  trainingExamples.clear();
+  trainingData.clear();
+}
+
+DetectorParameters& AHDetector::getParameters()
+{
+  return parameters;
+}
+
+std::uint64_t AHDetector::getVersion() const
+{
+  Hasher hasher;
+  hasher.add(static_cast<std::uint64_t>(outputVersion));
+  const auto addFile = [&hasher](const char* fileName)
+  {
+    std::ifstream file(fileName, std::ios::binary);
+    hasher.add(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+  };
+  if (useNN)
+  {
+    addFile("../NeuralNetworks/AHDetector.net");
+    addFile("../NeuralNetworks/AHDetector.norm");
+  }
+  else
+  {
+    addFile("../DecisionTrees/AHDetector.tree");
+  }
+  return hasher.hash;
+}
+
+void AHDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("hopSize", hopSize);
+  visitor.visit("minFrequency", minFrequency);
+  visitor.visit("maxFrequency", maxFrequency);
+  visitor.visit("minRequiredAmplitude", minRequiredAmplitude);
+  visitor.visit("minAmplitudeOverMaxAmplitude", minAmplitudeOverMaxAmplitude);
+}
+
+double AHDetector::bandSum(const unsigned int begin, const unsigned int end) const
+{
+  assert(begin <= end && end < amplitudePrefixSums.size());
+  return amplitudePrefixSums[end] - amplitudePrefixSums[begin];
 }
 
 bool AHDetector::classifyJ48(const FeatureVector& features) const
 {
+  if (tree.isTrained())
+  {
+    return tree.classify(features.data());
+  }
   // C5.0 generated decision tree
   if (features[1] <= 6.55235)
   {
@@ -305,8 +406,12 @@ bool AHDetector::classifyJ48(const FeatureVector& features) const
   return false;
 }
 
-bool AHDetector::classifyNN(const FeatureVector& features) const
+float AHDetector::runNN(const FeatureVector& features) const
 {
+  if (network.isLoaded())
+  {
+    return network.run(features.data());
+  }
   assert(ann != nullptr);
   fann_type input[numOfFeatures];
   for (unsigned int i = 0; i < numOfFeatures; i++)
@@ -314,99 +419,55 @@ bool AHDetector::classifyNN(const FeatureVector& features) const
     input[i] = static_cast<float>((features[i] - means[i]) / stddevs[i]);
   }
   fann_type* output = fann_run(ann, input);
-  return *output > 0.9f;
+  return *output;
 }
 
 void AHDetector::trainJ48()
 {
-  std::ofstream csv("../DecisionTrees/AHDetector.csv");
-  if (!csv.is_open())
+  const unsigned int numOfExamples = trainingData.size();
+  std::vector<double> features(numOfExamples * numOfFeatures);
+  std::vector<bool> labels(numOfExamples);
+  for (unsigned int j = 0; j < numOfFeatures; j++)
   {
-    std::cerr << "AHDetector: Could not open CSV file for writing!\n";
-    return;
-  }
-  for (unsigned int i = 0; i < numOfFeatures; i++)
-  {
-    csv << "feature" << i << ',';
-  }
-  csv << "whistle\n";
-  for (auto& te : trainingExamples)
-  {
-    for (unsigned int i = 0; i < numOfFeatures; i++)
+    const double* column = trainingData.getFeature(j);
+    for (unsigned int i = 0; i < numOfExamples; i++)
     {
-      csv << te.input[i] << ',';
+      features[i * numOfFeatures + j] = column[i];
     }
-    csv << (te.output ? "YES" : "NO") << '\n';
-  }
-  csv.close();
-
-  std::ofstream names("../DecisionTrees/AHDetector.names");
-  if (!names.is_open())
-  {
-    std::cerr << "AHDetector: Could not open C5.0 names file for writing!\n";
-    return;
   }
-  names << "whistle.\n";
-  for (unsigned int i = 0; i < numOfFeatures; i++)
-  {
-    names << "feature" << i << ": continuous.\n";
-  }
-  names << "whistle: YES, NO.\n";
-  names.close();
-
-  std::ofstream data("../DecisionTrees/AHDetector.data");
-  if (!data.is_open())
+  const std::uint8_t* cachedLabels = trainingData.getLabels();
+  for (unsigned int i = 0; i < numOfExamples; i++)
   {
-    std::cerr << "AHDetector: Could not open C5.0 data file for writing!\n";
-    return;
+    labels[i] = cachedLabels[i] != 0;
   }
-  for (auto& te : trainingExamples)
-  {
-    for (unsigned int i = 0; i < numOfFeatures; i++)
-    {
-      data << te.input[i] << ',';
-    }
-    data << (te.output ? "YES" : "NO") << '\n';
-  }
-  data.close();
-
-  std::ofstream costs("../DecisionTrees/AHDetector.costs");
-  if (!costs.is_open())
+  std::cout << "AHDetector: Will train with " << numOfExamples << " training examples!\n";
+  tree.train(features, labels, numOfFeatures, falsePositiveCost, maxTreeDepth, minExamplesPerLeaf);
+  std::cout << "AHDetector: Trained decision tree with " << tree.getNumberOfNodes() << " nodes!\n";
+  if (!tree.save("../DecisionTrees/AHDetector.tree"))
   {
-    std::cerr << "AHDetector: Could not open C5.0 costs file for writing!\n";
-    return;
+    std::cerr << "AHDetector: Could not save decision tree!\n";
   }
-  costs << "YES, NO: 10\n";
-  costs << "NO, YES: 1\n";
-  costs.close();
 }
 
 void AHDetector::trainNN()
 {
   // 1. Find out mean and standard deviation of the features.
-  means.fill(0);
-  stddevs.fill(0);
-  for (auto& te : trainingExamples)
+  const unsigned int numOfExamples = trainingData.size();
+  for (unsigned int j = 0; j < numOfFeatures; j++)
   {
-    for (unsigned int i = 0; i < numOfFeatures; i++)
+    const double* column = trainingData.getFeature(j);
+    double sum = 0;
+    for (unsigned int i = 0; i < numOfExamples; i++)
     {
-      means[i] += te.input[i];
+      sum += column[i];
     }
-  }
-  for (unsigned int i = 0; i < numOfFeatures; i++)
-  {
-    means[i] /= static_cast<double>(trainingExamples.size());
-  }
-  for (auto& te : trainingExamples)
-  {
-    for (unsigned int i = 0; i < numOfFeatures; i++)
+    means[j] = sum / static_cast<double>(numOfExamples);
+    double squaredSum = 0;
+    for (unsigned int i = 0; i < numOfExamples; i++)
     {
-      stddevs[i] += (te.input[i] - means[i]) * (te.input[i] - means[i]);
+      squaredSum += (column[i] - means[j]) * (column[i] - means[j]);
     }
-  }
-  for (unsigned int i = 0; i < numOfFeatures; i++)
-  {
-    stddevs[i] = std::sqrt(stddevs[i] / static_cast<double>(trainingExamples.size()));
+    stddevs[j] = std::sqrt(squaredSum / static_cast<double>(numOfExamples));
   }
 
   // 2. Create / overwrite neural network.
@@ -414,7 +475,8 @@ void AHDetector::trainNN()
   {
     fann_destroy(ann);
   }
-  ann = fann_create_standard(3, numOfFeatures, 8, 1);
+  network = NeuralNetwork();
+  ann = fann_create_standard(3, numOfFeatures, numOfHiddenNeurons, 1);
   if (ann == nullptr)
   {
     std::cerr << "AHDetector: Could not create new neural network!\n";
@@ -422,43 +484,102 @@ void AHDetector::trainNN()
   }
   fann_set_activation_function_hidden(ann, FANN_SIGMOID_SYMMETRIC);
   fann_set_activation_function_output(ann, FANN_SIGMOID);
-  fann_randomize_weights(ann, -1.0f, 1.0f);
 
   // 3. Shuffle training examples to create a diverse but balanced training set.
-  std::vector<TrainingExample*> positives, negatives;
-  for (unsigned int i = 0; i < trainingExamples.size(); i++)
+  std::vector<unsigned int> positives, negatives;
+  const std::uint8_t* labels = trainingData.getLabels();
+  for (unsigned int i = 0; i < numOfExamples; i++)
   {
-    if (trainingExamples[i].output)
-    {
-      positives.push_back(&trainingExamples[i]);
-    }
-    else
-    {
-      negatives.push_back(&trainingExamples[i]);
-    }
+    (labels[i] ? positives : negatives).push_back(i);
   }
   std::random_device rd;
   std::mt19937 g(rd());
   std::shuffle(positives.begin(), positives.end(), g);
   std::shuffle(negatives.begin(), negatives.end(), g);
   const unsigned int numOfTrainingExamples = 2 * static_cast<unsigned int>(std::min(positives.size(), negatives.size()));
-  // 4. Setup data and train the neural network.
+  // 4. Setup data and train the neural network (the trainer holds out the examples of some files for validation and keeps
+  //    the best weights).
   std::cout << "AHDetector: Will train with " << numOfTrainingExamples << " training examples!\n";
-  fann_train_data* data = fann_create_train(numOfTrainingExamples, numOfFeatures, 1);
-  if (data == nullptr)
-  {
-    std::cerr << "AHDetector: Could not create train data!\n";
-    return;
-  }
+  std::vector<float> inputs(numOfTrainingExamples * numOfFeatures);
+  std::vector<float> targets(numOfTrainingExamples);
+  std::vector<unsigned int> files(numOfTrainingExamples);
   for (unsigned int i = 0; i < numOfTrainingExamples; i++)
   {
-    TrainingExample* ex = (i < (numOfTrainingExamples / 2)) ? negatives[i] : positives[i - numOfTrainingExamples / 2];
+    const unsigned int ex = (i < (numOfTrainingExamples / 2)) ? negatives[i] : positives[i - numOfTrainingExamples / 2];
     for (unsigned int j = 0; j < numOfFeatures; j++)
     {
-      data->input[i][j] = static_cast<float>((ex->input[j] - means[j]) / stddevs[j]);
+      inputs[i * numOfFeatures + j] = static_cast<float>((trainingData.getFeature(j)[ex] - means[j]) / stddevs[j]);
+    }
+    targets[i] = labels[ex] ? 1.0f : 0.0f;
+    files[i] = trainingData.getFiles()[ex];
+  }
+  // 5. Save the neural network and the normalization parameters whenever the network improves, so that an interrupted
+  //    training leaves the best network so far (this is not done in the destructor because many detector instances
+  //    may exist at the same time, e.g. during a parameter sweep).
+  NeuralNetworkTrainer trainer(numOfFeatures, numOfHiddenNeurons, fann_get_activation_steepness(ann, 1, 0),
+                               fann_get_activation_steepness(ann, 2, 0), NeuralNetworkTrainer::Options());
+  const auto save = [this, &trainer]
+  {
+    // Both files are written to temporary files first, so that an interruption never leaves a truncated file. The old
+    // network is kept as backup until both files have been replaced, so that a failed rename never pairs a network with
+    // the normalization parameters of another one.
+    const std::string netFileName = "../NeuralNetworks/AHDetector.net";
+    const std::string normFileName = "../NeuralNetworks/AHDetector.norm";
+    if (!trainer.writeTo(ann) || fann_save(ann, (netFileName + ".tmp").c_str()) != 0)
+    {
+      std::cerr << "AHDetector: Could not save the neural network!\n";
+      return;
     }
-    data->output[i][0] = ex->output ? 1.0f : 0.0f;
+    std::ofstream norm(normFileName + ".tmp");
+    for (unsigned int i = 0; i < numOfFeatures; i++)
+    {
+      norm << means[i] << ' ' << stddevs[i] << '\n';
+    }
+    norm.close();
+    if (!norm)
+    {
+      std::cerr << "AHDetector: Could not save normalization parameters!\n";
+      std::remove((netFileName + ".tmp").c_str());
+      std::remove((normFileName + ".tmp").c_str());
+      return;
+    }
+    // There is no backup before the first network has been saved.
+    const bool hasBackup = std::rename(netFileName.c_str(), (netFileName + ".bak").c_str()) == 0;
+    bool saved = false;
+    if (std::rename((netFileName + ".tmp").c_str(), netFileName.c_str()) != 0)
+    {
+      std::cerr << "AHDetector: Could not save the neural network!\n";
+    }
+    else if (std::rename((normFileName + ".tmp").c_str(), normFileName.c_str()) != 0)
+    {
+      std::cerr << "AHDetector: Could not save normalization parameters!\n";
+      std::remove(netFileName.c_str());
+    }
+    else
+    {
+      saved = true;
+    }
+    if (saved)
+    {
+      std::remove((netFileName + ".bak").c_str());
+      return;
+    }
+    if (hasBackup)
+    {
+      std::rename((netFileName + ".bak").c_str(), netFileName.c_str());
+    }
+    std::remove((netFileName + ".tmp").c_str());
+    std::remove((normFileName + ".tmp").c_str());
+  };
+  trainer.train(inputs, targets, files, save);
+  if (!trainer.writeTo(ann))
+  {
+    std::cerr << "AHDetector: Could not copy the trained weights to the neural network!\n";
+    return;
+  }
+  save();
+  if (!network.load(ann, means.data(), stddevs.data()))
+  {
+    std::cerr << "AHDetector: Falling back to FANN for inference!\n";
   }
-  fann_train_on_data(ann, data, 10000, 1000, 0.0f);
-  fann_destroy_train(data);
 }
@@ -11,13 +11,16 @@
 
 #include <fftw3.h>
 
+#include "DecisionTree.hpp"
+#include "FeatureCache.hpp"
+#include "NeuralNetwork.hpp"
 #include "WhistleDetector.hpp"
 
 
 /**
  * @class AHDetector is one of the whistle detectors developed for this thesis
  */
-class AHDetector : public WhistleDetector<AHDetector>
+class AHDetector : public WhistleDetector<AHDetector, StreamingWhistleDetectorBase>
 {
 public:
   /**
@@ -25,47 +28,88 @@ public:
    */
   AHDetector();
   /**
-   * @brief ~AHDetector destroys FFTW plan
+   * @brief ~AHDetector destroys FFTW plan and neural network
    */
   ~AHDetector();
-  /**
-   * @brief evaluate evaluates the AHDetector on a given file
-   * @param eh delivers and collects data for the evaluation
-   */
-  void evaluate(EvaluationHandle& eh) override;
   /**
    * @brief trainOnDatabase trains the AHDetector on a given database
    * @param db the database on which the detector is trained
+   * @param augmentation the noise that is added to additional copies of the files (nullptr if only the files are used)
    */
-  void trainOnDatabase(const SampleDatabase& db) override;
+  void trainOnDatabase(const SampleDatabase& db, const NoiseAugmentation* augmentation = nullptr) override;
+  /**
+   * @brief getParameters returns the runtime parameters of the AHDetector
+   * @return a reference to the parameters
+   */
+  DetectorParameters& getParameters() override;
+  /**
+   * @brief getVersion combines the version of the classification with the trained model from which the classifier is loaded
+   * @return the version of the AHDetector
+   */
+  std::uint64_t getVersion() const override;
 private:
+  /**
+   * @brief setup computes the searched band for a sample rate
+   * @param sampleRate the sample rate of the stream
+   * @param streamWindowSize is set to the buffer size
+   * @param streamHopSize is set to the hop size
+   * @return whether the classifier is available and the parameters are valid
+   */
+  bool setup(unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize) override;
+  /**
+   * @brief processWindow extracts the features of a buffer and classifies them (or stores them during training)
+   * @param window the samples of the buffer
+   */
+  void processWindow(const float* window) override;
+  /**
+   * @struct Parameters contains the runtime parameters of the AHDetector
+   */
+  struct Parameters final : public DetectorParameters
+  {
+    /**
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
+     */
+    void visit(ParameterVisitor& visitor) override;
+    /// the number of samples by which consecutive buffers are shifted (must divide the buffer size)
+    unsigned int hopSize = 512;
+    /// the minimum frequency of the whistle band
+    double minFrequency = 2000;
+    /// the maximum frequency of the whistle band
+    double maxFrequency = 4000;
+    /// the minimum amplitude for the fundamental whistle frequency
+    double minRequiredAmplitude = 0.05;
+    /// the minimum factor the amplitude may be below the maximum amplitude before ending boundary search
+    double minAmplitudeOverMaxAmplitude = 0.01;
+  };
   /// the number of features that are available for the classifier
   static constexpr unsigned int numOfFeatures = 6;
   typedef std::array<double, numOfFeatures> FeatureVector;
+  /// the version of the feature extraction (has to be increased whenever the features change, so that caches are invalidated)
+  static constexpr unsigned int featureVersion = 1;
+  /// the version of the classification (has to be increased whenever the output changes for the same model, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
   /**
-   * @struct TrainingExample contains pairs of input and desired output of the classifier
+   * @brief bandSum returns the sum of the amplitudes in a range of bins of the current buffer
+   * @param begin the first bin of the range
+   * @param end the first bin after the range
+   * @return the sum of the amplitudes in the range
    */
-  struct TrainingExample
-  {
-    /// the input of the classifier
-    FeatureVector input;
-    /// the desired output of the classifier
-    bool output;
-  };
+  double bandSum(unsigned int begin, unsigned int end) const;
   /**
-   * @brief classifyJ48 determines whether there is a whistle by some features (in this case by a J48-trained decision tree)
+   * @brief classifyJ48 determines whether there is a whistle by some features (in this case by a decision tree)
    * @param features the features that are available to the classifier
    * @return whether there is a whistle in the features
    */
   bool classifyJ48(const FeatureVector& features) const;
   /**
-   * @brief classifyNN determines whether there is a whistle by some features (in this case an artificial neural network)
+   * @brief runNN computes the confidence that there is a whistle by some features (in this case an artificial neural network)
    * @param features the features that are available to the classifier
-   * @return whether there is a whistle in the features
+   * @return the output of the neural network (between 0 and 1, a whistle is assumed above nnThreshold)
    */
-  bool classifyNN(const FeatureVector& features) const;
+  float runNN(const FeatureVector& features) const;
   /**
-   * @brief trainJ48 trains a decision tree
+   * @brief trainJ48 trains a decision tree and saves it
    */
   void trainJ48();
   /**
@@ -74,16 +118,20 @@ private:
   void trainNN();
   /// whether the artificial neural network should be used for classification (instead of the decision tree)
   static constexpr bool useNN = true;
+  /// the output of the neural network above which a whistle is reported
+  static constexpr float nnThreshold = 0.9f;
+  /// the number of hidden neurons of the neural network
+  static constexpr unsigned int numOfHiddenNeurons = 8;
+  /// the cost of a false positive relative to a false negative when training the decision tree
+  static constexpr double falsePositiveCost = 10.0;
+  /// the maximum depth of the decision tree
+  static constexpr unsigned int maxTreeDepth = 8;
+  /// the minimum number of training examples in each leaf of the decision tree
+  static constexpr unsigned int minExamplesPerLeaf = 20;
   /// the buffer size (a parameter)
   static constexpr unsigned int bufferSize = 2048;
-  /// the minimum frequency of the whistle band (a parameter)
-  static constexpr double minFrequency = 2000;
-  /// the maximum frequency of the whistle band (a parameter)
-  static constexpr double maxFrequency = 4000;
-  /// the minimum amplitude for the fundamental whistle frequency
-  static constexpr double minRequiredAmplitude = 0.05;
-  /// the minimum factor the amplitude may be below the maximum amplitude before ending boundary search
-  static constexpr double minAmplitudeOverMaxAmplitude = 0.01;
+  /// the runtime parameters
+  Parameters parameters;
   /// a buffer for the precomputed Hann window
   std::vector<double> hannWindow;
   /// a buffer for the real input of the FFT
@@ -92,14 +140,26 @@ private:
   std::vector<std::complex<double>> complexBuffer;
   /// a buffer for the amplitude at each frequency
   std::vector<double> amplitudeBuffer;
+  /// the prefix sums of the amplitudes (i.e. entry i is the sum of the amplitudes of all bins below i)
+  std::vector<double> amplitudePrefixSums;
   /// a plan for FFTW for the FFT
   fftw_plan fftPlan;
   /// whether the detector is in training mode
   bool training;
-  /// the collected data during training
-  std::vector<TrainingExample> trainingExamples;
+  /// the index of the file in the database that is currently evaluated during training
+  unsigned int currentTrainingFile;
+  /// the first bin of the band in which the peak is searched
+  unsigned int minFreqIndex = 0;
+  /// the first bin above the band in which the peak is searched
+  unsigned int maxFreqIndex = 0;
+  /// the collected (or cached) features and labels during training
+  FeatureCache trainingData;
   /// the neural network (only if the neural network classifier should be used)
   fann* ann;
+  /// the decision tree (if it has not been trained or loaded, a hardcoded C5.0 tree is used)
+  DecisionTree tree;
+  /// the inference engine for the neural network (used instead of FANN if it could be loaded)
+  NeuralNetwork network;
   /// the means of the features
   FeatureVector means;
   /// the standard deviations of the features
@@ -0,0 +1,144 @@
+/**
+ * @file AllocationTracker.cpp implements methods of the AllocationTracker class and the replaced global allocation functions
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "AllocationTracker.hpp"
+
+
+namespace
+{
+  // The counters are trivial, so that they are initialized statically and can be used by operator new at any time.
+  /// the number of allocations of the thread
+  thread_local std::uint64_t threadAllocations = 0;
+  /// the number of bytes allocated by the thread
+  thread_local std::uint64_t threadBytes = 0;
+  /// the number of active pauses of the thread
+  thread_local unsigned int threadPauses = 0;
+}
+
+constexpr bool AllocationTracker::enabled;
+
+AllocationTracker::Pause::Pause()
+{
+  threadPauses++;
+}
+
+AllocationTracker::Pause::~Pause()
+{
+  threadPauses--;
+}
+
+AllocationTracker::Counts AllocationTracker::get()
+{
+  Counts counts;
+  counts.allocations = threadAllocations;
+  counts.bytes = threadBytes;
+  return counts;
+}
+
+void AllocationTracker::count(const std::size_t size)
+{
+  if (threadPauses > 0)
+  {
+    return;
+  }
+  threadAllocations++;
+  threadBytes += size;
+}
+
+#ifdef WHISTLELAB_ALLOCATION_TRACKING
+namespace
+{
+  /**
+   * @brief allocate counts and performs an allocation like the default operator new
+   * @param size the number of bytes
+   * @return the allocated memory
+   * @throw std::bad_alloc if the memory cannot be allocated
+   */
+  void* allocate(std::size_t size)
+  {
+    AllocationTracker::count(size);
+    size = size != 0 ? size : 1;
+    while (true)
+    {
+      if (void* p = std::malloc(size))
+      {
+        return p;
+      }
+      std::new_handler handler = std::get_new_handler();
+      if (handler == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      handler();
+    }
+  }
+}
+
+void* operator new(const std::size_t size)
+{
+  return allocate(size);
+}
+
+void* operator new[](const std::size_t size)
+{
+  return allocate(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return allocate(size);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept
+{
+  try
+  {
+    return allocate(size);
+  }
+  catch (const std::bad_alloc&)
+  {
+    return nullptr;
+  }
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  std::free(p);
+}
+#endif
@@ -0,0 +1,68 @@
+/**
+ * @file AllocationTracker.hpp declares the AllocationTracker class
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @class AllocationTracker counts the allocations of each thread through the global operator new
+ *
+ * The replacements of the global operators new and delete are only compiled in if WHISTLELAB_ALLOCATION_TRACKING is
+ * defined (see the CMake option of the same name). Memory that is allocated with malloc directly (e.g. by Qt
+ * containers or fftw_malloc) is not counted. The counters are thread local, so that detectors that are evaluated in
+ * parallel do not see the allocations of each other.
+ */
+class AllocationTracker final
+{
+public:
+  /**
+   * @struct Counts are the numbers of allocations and allocated bytes of a thread
+   */
+  struct Counts
+  {
+    /// the number of allocations
+    std::uint64_t allocations = 0;
+    /// the number of allocated bytes
+    std::uint64_t bytes = 0;
+  };
+  /**
+   * @class Pause stops counting the allocations of the calling thread during its lifetime
+   *
+   * This is used by instrumentation that runs inside of the tracked code (e.g. trace zones), so that its allocations
+   * are not attributed to the detectors.
+   */
+  class Pause final
+  {
+  public:
+    /**
+     * @brief Pause stops counting
+     */
+    Pause();
+    /**
+     * @brief ~Pause resumes counting (unless another pause is still active)
+     */
+    ~Pause();
+    Pause(const Pause&) = delete;
+    Pause& operator=(const Pause&) = delete;
+  };
+  /**
+   * @brief get returns the counts of the calling thread
+   * @return the numbers of allocations and allocated bytes since the thread has started (0 if tracking is not compiled in)
+   */
+  static Counts get();
+  /**
+   * @brief count counts an allocation of the calling thread (unless counting is paused)
+   * @param size the number of allocated bytes
+   */
+  static void count(std::size_t size);
+  /// whether allocations are counted
+#ifdef WHISTLELAB_ALLOCATION_TRACKING
+  static constexpr bool enabled = true;
+#else
+  static constexpr bool enabled = false;
+#endif
+};
@@ -0,0 +1,97 @@
+/**
+ * @file BandLimitedSpectrum.cpp implements methods of the BandLimitedSpectrum class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "BandLimitedSpectrum.hpp"
+#include "FFTWPlannerLock.hpp"
+
+
+BandLimitedSpectrum::BandLimitedSpectrum(const unsigned int size, const bool useHannWindow)
+  : size(size)
+  , block(size)
+  , complexBuffer(size / 2 + 1)
+{
+  assert(size % 2 == 0);
+  {
+    FFTWPlannerLock lock;
+    fftPlan = fftw_plan_dft_r2c_1d(size, block.data(), reinterpret_cast<fftw_complex*>(complexBuffer.data()), FFTW_ESTIMATE);
+  }
+  if (useHannWindow)
+  {
+    window.resize(size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+      const double s = std::sin(M_PI * static_cast<double>(i) / size);
+      window[i] = s * s;
+    }
+  }
+}
+
+BandLimitedSpectrum::~BandLimitedSpectrum()
+{
+  FFTWPlannerLock lock;
+  fftw_destroy_plan(fftPlan);
+}
+
+void BandLimitedSpectrum::analyze(const float* samples, const bool swapHalves)
+{
+  // With swapped halves, the block starts in the middle of the samples and wraps around. The window is applied to the
+  // swapped block, so that the magnitudes match those of a block that is read from a ring buffer.
+  const unsigned int offset = swapHalves ? size / 2 : 0;
+  // The DC and Nyquist bins and the energy of the block are needed for Parseval's theorem and can be obtained
+  // in the same pass that applies the window.
+  double energy = 0, dc = 0, nyquist = 0;
+  for (unsigned int i = 0; i < size; i += 2)
+  {
+    const unsigned int j = i + offset < size ? i + offset : i + offset - size;
+    const unsigned int k = i + 1 + offset < size ? i + 1 + offset : i + 1 + offset - size;
+    const double even = window.empty() ? samples[j] : samples[j] * window[i];
+    const double odd = window.empty() ? samples[k] : samples[k] * window[i + 1];
+    block[i] = even;
+    block[i + 1] = odd;
+    energy += even * even + odd * odd;
+    dc += even + odd;
+    nyquist += even - odd;
+  }
+  // For a real signal, |X_k| = |X_{N-k}|, thus the full spectrum is N * energy = X_0^2 + X_{N/2}^2 + 2 * sum_{0<k<N/2} |X_k|^2.
+  halfSpectrumPower = (size * energy + dc * dc + nyquist * nyquist) * 0.5;
+  fftw_execute(fftPlan);
+}
+
+double BandLimitedSpectrum::power(const unsigned int bin) const
+{
+  assert(bin <= size / 2);
+  return std::norm(complexBuffer[bin]);
+}
+
+double BandLimitedSpectrum::amplitude(const unsigned int bin) const
+{
+  return std::sqrt(power(bin));
+}
+
+double BandLimitedSpectrum::bandPower(const unsigned int begin, const unsigned int end) const
+{
+  assert(begin <= end && end <= size / 2 + 1);
+  double sum = 0;
+  for (unsigned int i = begin; i < end; i++)
+  {
+    sum += std::norm(complexBuffer[i]);
+  }
+  return sum;
+}
+
+double BandLimitedSpectrum::powerAbove(const unsigned int bin) const
+{
+  assert(bin <= size / 2 + 1);
+  // It is cheaper to sum up the upper bins directly if there are fewer of them.
+  if (bin > size / 4)
+  {
+    return bandPower(bin, size / 2 + 1);
+  }
+  // The subtraction can become slightly negative due to rounding if there is (almost) no power above the bin.
+  return std::max(halfSpectrumPower - bandPower(0, bin), 0.0);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file BandLimitedSpectrum.hpp declares the BandLimitedSpectrum class
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include <fftw3.h>
+
+
+/**
+ * @class BandLimitedSpectrum computes the power spectrum of a real block of samples for queries on bands of bins
+ *
+ * The spectrum is computed by an FFT. The power above a given bin is derived from the energy of the block in the time
+ * domain (Parseval's theorem) if there are fewer bins below it, so that the stop band never has to be traversed.
+ */
+class BandLimitedSpectrum final
+{
+public:
+  /**
+   * @brief BandLimitedSpectrum initializes members and FFTW plan
+   * @param size the number of samples in a block (must be even)
+   * @param useHannWindow whether a Hann window is applied to each block before the analysis
+   */
+  BandLimitedSpectrum(unsigned int size, bool useHannWindow);
+  /**
+   * @brief ~BandLimitedSpectrum destroys FFTW plan
+   */
+  ~BandLimitedSpectrum();
+  BandLimitedSpectrum(const BandLimitedSpectrum&) = delete;
+  BandLimitedSpectrum& operator=(const BandLimitedSpectrum&) = delete;
+  /**
+   * @brief analyze computes the spectrum of a new block
+   * @param samples the samples of the block (as many as the size given in the constructor)
+   * @param swapHalves whether the block is analyzed with its halves swapped, i.e. as it would lie in a ring buffer of its size
+   */
+  void analyze(const float* samples, bool swapHalves = false);
+  /**
+   * @brief power returns the squared magnitude of a bin of the current block
+   * @param bin the index of the bin (between 0 and size / 2)
+   * @return the squared magnitude of the DFT at the bin
+   */
+  double power(unsigned int bin) const;
+  /**
+   * @brief amplitude returns the magnitude of a bin of the current block
+   * @param bin the index of the bin (between 0 and size / 2)
+   * @return the magnitude of the DFT at the bin
+   */
+  double amplitude(unsigned int bin) const;
+  /**
+   * @brief bandPower returns the sum of the squared magnitudes in a range of bins of the current block
+   * @param begin the first bin of the range
+   * @param end the first bin after the range
+   * @return the sum of the squared magnitudes in the range
+   */
+  double bandPower(unsigned int begin, unsigned int end) const;
+  /**
+   * @brief powerAbove returns the sum of the squared magnitudes of all bins from a given bin up to the Nyquist bin
+   * @param bin the first bin that is included in the sum
+   * @return the sum of the squared magnitudes of the bins [bin, size / 2]
+   */
+  double powerAbove(unsigned int bin) const;
+private:
+  /// the number of samples in a block
+  const unsigned int size;
+  /// the window that is applied to each block (empty if no windowing is done)
+  std::vector<double> window;
+  /// the windowed samples of the current block (the input of the FFT)
+  std::vector<double> block;
+  /// the complex output of the FFT
+  std::vector<std::complex<double>> complexBuffer;
+  /// the sum of the squared magnitudes of all bins up to the Nyquist bin (computed in the time domain)
+  double halfSpectrumPower = 0;
+  /// a plan for FFTW for the FFT
+  fftw_plan fftPlan;
+};
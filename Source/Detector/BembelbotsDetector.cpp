@@ -6,87 +6,141 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 
 #include "BembelbotsDetector.hpp"
+#include "FFTWPlannerLock.hpp"
+#include "Trace.hpp"
 
 
 BembelbotsDetector::BembelbotsDetector()
+  : fftPlan(nullptr)
 {
 }
 
-void BembelbotsDetector::evaluate(EvaluationHandle& eh)
+BembelbotsDetector::~BembelbotsDetector()
 {
+  if (fftPlan != nullptr)
+  {
+    FFTWPlannerLock lock;
+    fftwf_destroy_plan(fftPlan);
+  }
+}
+
+bool BembelbotsDetector::setup(const unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize)
+{
+  const unsigned int filterStrength = parameters.filterStrength;
   // Determine parameters that depend on the sample rate.
-  const unsigned int bufferSize = eh.getSampleRate() * bufferSizeMs / 1000;
-  const unsigned int dftSize = bufferSize / 2 + 1;
+  bufferSize = sampleRate * parameters.bufferSizeMs / 1000;
+  if (bufferSize < 2 || filterStrength == 0)
+  {
+    std::cerr << "BembelbotsDetector: The buffer size and the filter strength have to be positive!\n";
+    return false;
+  }
+  dftSize = bufferSize / 2 + 1;
   // Clear member variables.
   match.available = false;
   audioContainer.resize(bufferSize);
   spectrum.resize(dftSize);
   smoothedSpectrum.resize((dftSize / filterStrength) + ((dftSize % filterStrength) ? 1 : 0));
   // Create FFTW plan for this sample rate.
+  FFTWPlannerLock lock;
+  if (fftPlan != nullptr)
+  {
+    fftwf_destroy_plan(fftPlan);
+  }
   fftPlan = fftwf_plan_dft_r2c_1d(bufferSize, audioContainer.data(), reinterpret_cast<fftwf_complex*>(spectrum.data()), FFTW_ESTIMATE);
-  while (eh.readSingleChannel(audioContainer.data(), bufferSize) == bufferSize)
+  streamWindowSize = bufferSize;
+  streamHopSize = bufferSize;
+  return true;
+}
+
+void BembelbotsDetector::processWindow(const float* samples)
+{
+  const unsigned int filterStrength = parameters.filterStrength;
+  TRACE_SCOPE("BembelbotsDetector::processWindow");
+  TRACE_STAGE(stage, "BembelbotsDetector: FFT");
+  // The plan works on its own aligned buffer, so the samples have to be copied.
+  std::copy(samples, samples + bufferSize, audioContainer.begin());
+  // The abs is not present in original Bembelbots code, but I assume it is more correct with it.
+  const float volDb = 20.f * std::log10(std::abs(*std::max_element(audioContainer.begin(), audioContainer.end(), [](const float a, const float b){ return std::abs(a) < std::abs(b); })));
+  // Execute FFT.
+  fftwf_execute(fftPlan);
+  // Smoothen spectrum.
+  TRACE_NEXT_STAGE(stage, "BembelbotsDetector: Smoothing");
+  for (unsigned int i = 0; i < dftSize / filterStrength; i++)
   {
-    // The abs is not present in original Bembelbots code, but I assume it is more correct with it.
-    const float volDb = 20.f * std::log10(std::abs(*std::max_element(audioContainer.begin(), audioContainer.end(), [](const float a, const float b){ return std::abs(a) < std::abs(b); })));
-    // Execute FFT.
-    fftwf_execute(fftPlan);
-    // Smoothen spectrum.
-    for (unsigned int i = 0; i < dftSize / filterStrength; i++)
+    float sum = 0.f;
+    for (unsigned int j = 0; j < filterStrength; j++)
     {
-      float sum = 0.f;
-      for (unsigned int j = 0; j < filterStrength; j++)
-      {
-        sum += std::abs(spectrum[i * filterStrength + j]);
-      }
-      smoothedSpectrum[i] = sum / filterStrength;
+      sum += std::abs(spectrum[i * filterStrength + j]);
     }
-    if (dftSize % filterStrength)
+    smoothedSpectrum[i] = sum / static_cast<float>(filterStrength);
+  }
+  if (dftSize % filterStrength)
+  {
+    float sum = 0.f;
+    for (unsigned int j = 0; j < (dftSize % filterStrength); j++)
     {
-      float sum = 0.f;
-      for (unsigned int j = 0; j < (dftSize % filterStrength); j++)
-      {
-        sum += std::abs(spectrum[spectrum.size() - j - 1]);
-      }
-      smoothedSpectrum[smoothedSpectrum.size() - 1] = sum / static_cast<float>(dftSize % filterStrength);
+      sum += std::abs(spectrum[spectrum.size() - j - 1]);
     }
-    // Find the peak frequency (i.e. the frequency with highest amplitude) in the smoothed spectrum.
-    unsigned int maxIndex = 0;
-    for (unsigned i = 1; i < smoothedSpectrum.size(); i++)
+    smoothedSpectrum[smoothedSpectrum.size() - 1] = sum / static_cast<float>(dftSize % filterStrength);
+  }
+  // Find the peak frequency (i.e. the frequency with highest amplitude) in the smoothed spectrum.
+  TRACE_NEXT_STAGE(stage, "BembelbotsDetector: Peak");
+  unsigned int maxIndex = 0;
+  for (unsigned i = 1; i < smoothedSpectrum.size(); i++)
+  {
+    if (smoothedSpectrum[i] > smoothedSpectrum[maxIndex])
     {
-      if (smoothedSpectrum[i] > smoothedSpectrum[maxIndex])
-      {
-        maxIndex = i;
-      }
+      maxIndex = i;
+    }
+  }
+  const float peakHz = static_cast<float>(maxIndex * getSampleRate() * filterStrength) / static_cast<float>(bufferSize);
+  // Integrate into existing whistle or start a new detection.
+  TRACE_NEXT_STAGE(stage, "BembelbotsDetector: Tracking");
+  if (match.available)
+  {
+    if (peakHz < static_cast<float>(parameters.thresholdHz))
+    {
+      match.available = false;
     }
-    const float peakHz = static_cast<float>(maxIndex * eh.getSampleRate() * filterStrength) / static_cast<float>(bufferSize);
-    // Integrate into existing whistle or start a new detection.
-    if (match.available)
+    else
     {
-      if (peakHz < thresholdHz)
+      match.lengthMs += parameters.bufferSizeMs;
+      if (volDb > match.maxVolumeDb)
       {
-        match.available = false;
+        match.maxVolumeDb = volDb;
       }
-      else
+      if (match.lengthMs > parameters.minSignalLengthMs && match.maxVolumeDb > parameters.volumeThresholdDb)
       {
-        match.lengthMs += bufferSizeMs;
-        if (volDb > match.maxVolumeDb)
-        {
-          match.maxVolumeDb = volDb;
-        }
-        if (match.lengthMs > minSignalLengthMs && match.maxVolumeDb > volumeThresholdDb)
-        {
-          eh.report(-static_cast<int>(match.lengthMs * eh.getSampleRate() / 1000) + 2 * bufferSize);
-        }
+        report(-static_cast<int>(match.lengthMs * getSampleRate() / 1000) + 2 * bufferSize);
       }
     }
-    else if (peakHz >= thresholdHz)
-    {
-      match.available = true;
-      match.lengthMs = bufferSizeMs;
-      match.maxVolumeDb = volDb;
-    }
   }
-  fftwf_destroy_plan(fftPlan);
+  else if (peakHz >= static_cast<float>(parameters.thresholdHz))
+  {
+    match.available = true;
+    match.lengthMs = parameters.bufferSizeMs;
+    match.maxVolumeDb = volDb;
+  }
+}
+
+DetectorParameters& BembelbotsDetector::getParameters()
+{
+  return parameters;
+}
+
+std::uint64_t BembelbotsDetector::getVersion() const
+{
+  return outputVersion;
+}
+
+void BembelbotsDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("bufferSizeMs", bufferSizeMs);
+  visitor.visit("thresholdHz", thresholdHz);
+  visitor.visit("volumeThresholdDb", volumeThresholdDb);
+  visitor.visit("minSignalLengthMs", minSignalLengthMs);
+  visitor.visit("filterStrength", filterStrength);
 }
@@ -14,7 +14,7 @@
 /**
  * @class BembelbotsDetector is the whistle detector of the SPL team Bembelbots
  */
-class BembelbotsDetector : public WhistleDetector<BembelbotsDetector>
+class BembelbotsDetector : public WhistleDetector<BembelbotsDetector, StreamingWhistleDetectorBase>
 {
 public:
   /**
@@ -22,11 +22,54 @@ public:
    */
   BembelbotsDetector();
   /**
-   * @brief evaluate evaluates the BembelbotsDetector on a given file
-   * @param eh delivers and collects data for the evaluation
+   * @brief ~BembelbotsDetector destroys the FFTW plan
    */
-  void evaluate(EvaluationHandle& eh) override;
+  ~BembelbotsDetector();
+  /**
+   * @brief getParameters returns the runtime parameters of the BembelbotsDetector
+   * @return a reference to the parameters
+   */
+  DetectorParameters& getParameters() override;
+  /**
+   * @brief getVersion returns the version of the output of the BembelbotsDetector
+   * @return the version of the BembelbotsDetector
+   */
+  std::uint64_t getVersion() const override;
 private:
+  /**
+   * @brief setup computes the buffer size for a sample rate and creates the FFTW plan
+   * @param sampleRate the sample rate of the stream
+   * @param streamWindowSize is set to the buffer size
+   * @param streamHopSize is set to the buffer size
+   * @return whether the buffer size and the filter strength are valid
+   */
+  bool setup(unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize) override;
+  /**
+   * @brief processWindow finds the peak frequency of a buffer and integrates it into the current match
+   * @param samples the samples of the buffer
+   */
+  void processWindow(const float* samples) override;
+  /**
+   * @struct Parameters contains the runtime parameters of the BembelbotsDetector
+   */
+  struct Parameters final : public DetectorParameters
+  {
+    /**
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
+     */
+    void visit(ParameterVisitor& visitor) override;
+    /// the length of a buffer in milliseconds
+    unsigned int bufferSizeMs = 50;
+    /// the frequency above which the peak has to be for a whistle in Hertz
+    unsigned int thresholdHz = 2000;
+    /// the volume above which a whistle must be at least once in dB
+    float volumeThresholdDb = -20.f;
+    /// the minimal length of a whistle to be accepted in milliseconds
+    unsigned int minSignalLengthMs = 400;
+    /// a parameter for smoothing of the spectrum
+    unsigned int filterStrength = 3;
+  };
   /**
    * @struct WhistleMatch contains the current state of the whistle detection
    */
@@ -39,18 +82,16 @@ private:
     /// the maximal volume of the current match in dB
     float maxVolumeDb;
   };
-  /// the length of a buffer in milliseconds
-  static constexpr unsigned int bufferSizeMs = 50;
-  /// the frequency above which the peak has to be for a whistle in Hertz
-  static constexpr unsigned int thresholdHz = 2000;
-  /// the volume above which a whistle must be at least once in dB
-  static constexpr int volumeThresholdDb = -20;
-  /// the minimal length of a whistle to be accepted in milliseconds
-  static constexpr unsigned int minSignalLengthMs = 400;
-  /// a parameter for smoothing of the spectrum
-  static constexpr unsigned int filterStrength = 3;
+  /// the version of the output (has to be increased whenever the output changes, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
+  /// the runtime parameters
+  Parameters parameters;
   /// the samples of the audio signal that are currently processed
   std::vector<float> audioContainer;
+  /// the number of samples in a buffer at the current sample rate
+  unsigned int bufferSize = 0;
+  /// the number of bins of the DFT of a buffer
+  unsigned int dftSize = 0;
   /// the DFT of the samples contained in audioContainer
   std::vector<std::complex<float>> spectrum;
   /// the smoothed absolute values of the spectrum
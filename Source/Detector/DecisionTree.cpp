@@ -0,0 +1,250 @@
+/**
+ * @file DecisionTree.cpp implements methods of the DecisionTree class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+#include "Engine/WorkerPool.hpp"
+
+#include "DecisionTree.hpp"
+
+
+void DecisionTree::train(const std::vector<double>& features, const std::vector<bool>& labels, const unsigned int numFeatures,
+                         const double negativeWeight, const unsigned int maxDepth, const unsigned int minExamplesPerLeaf)
+{
+  assert(features.size() == labels.size() * numFeatures);
+  this->numFeatures = numFeatures;
+  nodes.clear();
+  const unsigned int numExamples = static_cast<unsigned int>(labels.size());
+  if (numExamples == 0)
+  {
+    nodes.push_back({ -1, 0.0, { 0, 0 } });
+    return;
+  }
+  // Non-finite values (e.g. ratios of 0 / 0) would break the strict weak ordering of the presort. They are replaced by
+  // the extreme finite values on the side to which classify sends them (NaN is never larger than a threshold).
+  std::vector<double> finiteFeatures;
+  if (!std::all_of(features.begin(), features.end(), [](const double value) { return std::isfinite(value); }))
+  {
+    finiteFeatures = features;
+    for (double& value : finiteFeatures)
+    {
+      if (!std::isfinite(value))
+      {
+        value = value > 0.0 ? std::numeric_limits<double>::max() : std::numeric_limits<double>::lowest();
+      }
+    }
+  }
+  const std::vector<double>& trainingFeatures = finiteFeatures.empty() ? features : finiteFeatures;
+  WorkerPool pool;
+  TrainingState state{ trainingFeatures, labels, {}, {}, {}, {}, {}, pool, maxDepth, std::max(minExamplesPerLeaf, 1U) };
+  state.weights.resize(numExamples);
+  for (unsigned int i = 0; i < numExamples; i++)
+  {
+    state.weights[i] = labels[i] ? 1.0 : negativeWeight;
+  }
+  state.goesRight.resize(numExamples);
+  state.splits.resize(numFeatures);
+  state.sorted.resize(numFeatures);
+  state.scratch.resize(numFeatures);
+  // The examples are sorted once per feature. Splitting a node partitions each list stably, so the ranges of the
+  // children stay sorted and no node has to sort again.
+  pool.run(numFeatures, [&](const unsigned int f)
+  {
+    std::vector<unsigned int>& order = state.sorted[f];
+    order.resize(numExamples);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const unsigned int a, const unsigned int b)
+    {
+      return trainingFeatures[a * numFeatures + f] < trainingFeatures[b * numFeatures + f];
+    });
+    state.scratch[f].resize(numExamples);
+  });
+  build(state, 0, numExamples, 0);
+}
+
+bool DecisionTree::load(const std::string& fileName, const unsigned int numFeatures)
+{
+  nodes.clear();
+  std::ifstream file(fileName);
+  unsigned int fileFeatures = 0, numNodes = 0;
+  if (!(file >> fileFeatures >> numNodes) || fileFeatures != numFeatures || numNodes == 0)
+  {
+    return false;
+  }
+  nodes.resize(numNodes);
+  for (unsigned int i = 0; i < numNodes; i++)
+  {
+    Node& node = nodes[i];
+    if (!(file >> node.feature >> node.threshold >> node.children[0] >> node.children[1]))
+    {
+      nodes.clear();
+      return false;
+    }
+    // Children always come after their parent, which also guarantees that classification terminates.
+    if (node.feature >= static_cast<int>(numFeatures)
+        || (node.feature >= 0 && (node.children[0] <= i || node.children[1] <= i || node.children[0] >= numNodes || node.children[1] >= numNodes)))
+    {
+      nodes.clear();
+      return false;
+    }
+  }
+  this->numFeatures = numFeatures;
+  return true;
+}
+
+bool DecisionTree::save(const std::string& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file.is_open())
+  {
+    return false;
+  }
+  file.precision(std::numeric_limits<double>::max_digits10);
+  file << numFeatures << ' ' << nodes.size() << '\n';
+  for (const auto& node : nodes)
+  {
+    file << node.feature << ' ' << node.threshold << ' ' << node.children[0] << ' ' << node.children[1] << '\n';
+  }
+  return file.good();
+}
+
+bool DecisionTree::isTrained() const
+{
+  return !nodes.empty();
+}
+
+bool DecisionTree::classify(const double* features) const
+{
+  assert(isTrained());
+  unsigned int index = 0;
+  while (nodes[index].feature >= 0)
+  {
+    const Node& node = nodes[index];
+    index = node.children[features[node.feature] > node.threshold];
+  }
+  return nodes[index].children[0] != 0;
+}
+
+unsigned int DecisionTree::getNumberOfNodes() const
+{
+  return static_cast<unsigned int>(nodes.size());
+}
+
+unsigned int DecisionTree::build(TrainingState& state, const unsigned int begin, const unsigned int end, const unsigned int depth)
+{
+  // 1. Determine the class weights of the node, which decide the class if it becomes a leaf.
+  double positive = 0, negative = 0;
+  for (unsigned int p = begin; p < end; p++)
+  {
+    const unsigned int i = state.sorted[0][p];
+    (state.labels[i] ? positive : negative) += state.weights[i];
+  }
+  const unsigned int index = static_cast<unsigned int>(nodes.size());
+  nodes.push_back({ -1, 0.0, { positive > negative ? 1U : 0U, 0 } });
+  if (depth >= state.maxDepth || positive == 0 || negative == 0 || end - begin < 2 * state.minExamplesPerLeaf)
+  {
+    return index;
+  }
+
+  // 2. Find the best split on each feature in parallel and choose the best one.
+  state.pool.run(numFeatures, [&](const unsigned int f)
+  {
+    state.splits[f] = findSplit(state, f, begin, end);
+  });
+  int bestFeature = -1;
+  // A split has to reduce the impurity, i.e. increase the score compared to the unsplit node.
+  double bestScore = (positive * positive + negative * negative) / (positive + negative) * (1.0 + 1e-9);
+  for (unsigned int f = 0; f < numFeatures; f++)
+  {
+    if (state.splits[f].valid && state.splits[f].score > bestScore)
+    {
+      bestScore = state.splits[f].score;
+      bestFeature = static_cast<int>(f);
+    }
+  }
+  if (bestFeature < 0)
+  {
+    return index;
+  }
+  const unsigned int feature = static_cast<unsigned int>(bestFeature);
+  const double threshold = state.splits[feature].threshold;
+
+  // 3. Partition the sorted lists of all features stably into the examples of the left and right child.
+  unsigned int numLeft = 0;
+  for (unsigned int p = begin; p < end; p++)
+  {
+    const unsigned int i = state.sorted[feature][p];
+    state.goesRight[i] = state.features[i * numFeatures + feature] > threshold;
+    numLeft += state.goesRight[i] ? 0 : 1;
+  }
+  state.pool.run(numFeatures, [&](const unsigned int f)
+  {
+    std::vector<unsigned int>& order = state.sorted[f];
+    std::vector<unsigned int>& right = state.scratch[f];
+    unsigned int left = begin, numRight = 0;
+    for (unsigned int p = begin; p < end; p++)
+    {
+      const unsigned int i = order[p];
+      if (state.goesRight[i])
+      {
+        right[numRight++] = i;
+      }
+      else
+      {
+        order[left++] = i;
+      }
+    }
+    std::copy(right.begin(), right.begin() + numRight, order.begin() + left);
+  });
+
+  // 4. Build the subtrees (the node vector may grow, so the node is accessed by index afterwards).
+  const unsigned int leftChild = build(state, begin, begin + numLeft, depth + 1);
+  const unsigned int rightChild = build(state, begin + numLeft, end, depth + 1);
+  nodes[index].feature = bestFeature;
+  nodes[index].threshold = threshold;
+  nodes[index].children[0] = leftChild;
+  nodes[index].children[1] = rightChild;
+  return index;
+}
+
+DecisionTree::Split DecisionTree::findSplit(const TrainingState& state, const unsigned int feature, const unsigned int begin, const unsigned int end) const
+{
+  const std::vector<unsigned int>& order = state.sorted[feature];
+  double totalPositive = 0, totalNegative = 0;
+  for (unsigned int p = begin; p < end; p++)
+  {
+    const unsigned int i = order[p];
+    (state.labels[i] ? totalPositive : totalNegative) += state.weights[i];
+  }
+  Split best = { 0.0, 0.0, false };
+  double leftPositive = 0, leftNegative = 0;
+  for (unsigned int p = begin; p + 1 < end; p++)
+  {
+    const unsigned int i = order[p];
+    (state.labels[i] ? leftPositive : leftNegative) += state.weights[i];
+    const double value = state.features[i * numFeatures + feature];
+    const double nextValue = state.features[order[p + 1] * numFeatures + feature];
+    // Splits are only possible between different values and have to leave enough examples on both sides.
+    if (value == nextValue || p + 1 - begin < state.minExamplesPerLeaf || end - p - 1 < state.minExamplesPerLeaf)
+    {
+      continue;
+    }
+    const double rightPositive = totalPositive - leftPositive;
+    const double rightNegative = totalNegative - leftNegative;
+    // Minimizing the weighted Gini impurity of both sides is equivalent to maximizing this score.
+    const double score = (leftPositive * leftPositive + leftNegative * leftNegative) / (leftPositive + leftNegative)
+                       + (rightPositive * rightPositive + rightNegative * rightNegative) / (rightPositive + rightNegative);
+    if (!best.valid || score > best.score)
+    {
+      const double middle = 0.5 * (value + nextValue);
+      best = { score, middle < nextValue ? middle : value, true };
+    }
+  }
+  return best;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file DecisionTree.hpp declares the DecisionTree class
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+class WorkerPool;
+
+/**
+ * @class DecisionTree is a binary classifier on continuous features that can be trained cost-sensitively
+ *
+ * The tree is stored as a flat array of nodes. Inner nodes select their child by indexing with the result of the
+ * comparison, so that classification only branches on whether a leaf has been reached.
+ */
+class DecisionTree final
+{
+public:
+  /**
+   * @brief train builds a tree by greedily choosing the splits with the lowest weighted Gini impurity
+   * @param features the features of the training examples (row-major, numFeatures values per example)
+   * @param labels the classes of the training examples (one per example)
+   * @param numFeatures the number of features per example
+   * @param negativeWeight the weight of negative examples relative to positive ones (i.e. the cost of a false positive)
+   * @param maxDepth the maximum number of splits from the root to a leaf
+   * @param minExamplesPerLeaf the minimum number of examples on each side of a split
+   */
+  void train(const std::vector<double>& features, const std::vector<bool>& labels, unsigned int numFeatures,
+             double negativeWeight, unsigned int maxDepth, unsigned int minExamplesPerLeaf);
+  /**
+   * @brief load reads a tree from a file
+   * @param fileName the name of the file
+   * @param numFeatures the number of features that the tree is expected to use
+   * @return whether the tree could be read and is valid
+   */
+  bool load(const std::string& fileName, unsigned int numFeatures);
+  /**
+   * @brief save writes the tree to a file
+   * @param fileName the name of the file
+   * @return whether the tree could be written
+   */
+  bool save(const std::string& fileName) const;
+  /**
+   * @brief isTrained returns whether the tree has been trained or loaded
+   * @return whether the tree has been trained or loaded
+   */
+  bool isTrained() const;
+  /**
+   * @brief classify determines the class of an example
+   * @param features the features of the example
+   * @return the class of the example
+   */
+  bool classify(const double* features) const;
+  /**
+   * @brief getNumberOfNodes returns the number of nodes (inner nodes and leaves)
+   * @return the number of nodes
+   */
+  unsigned int getNumberOfNodes() const;
+private:
+  /**
+   * @struct Node is an inner node or a leaf of the tree
+   */
+  struct Node
+  {
+    /// the feature that is compared (-1 for a leaf)
+    int feature;
+    /// the value above which the right child is taken
+    double threshold;
+    /// the indices of the left and right children (for a leaf, the first entry is the class)
+    unsigned int children[2];
+  };
+  /**
+   * @struct Split is the best split of a node on a single feature
+   */
+  struct Split
+  {
+    /// the score of the split (sum over both sides of the squared class weights divided by the total weight)
+    double score;
+    /// the value above which examples go to the right side
+    double threshold;
+    /// whether a valid split has been found
+    bool valid;
+  };
+  /**
+   * @struct TrainingState contains the data that is shared by all nodes during training
+   */
+  struct TrainingState
+  {
+    /// the features of the training examples
+    const std::vector<double>& features;
+    /// the classes of the training examples
+    const std::vector<bool>& labels;
+    /// the weights of the training examples
+    std::vector<double> weights;
+    /// for each feature, the indices of the examples sorted by that feature (each node owns a range)
+    std::vector<std::vector<unsigned int>> sorted;
+    /// a buffer per feature for partitioning
+    std::vector<std::vector<unsigned int>> scratch;
+    /// for each example, whether it goes to the right child of the node that is currently split
+    std::vector<bool> goesRight;
+    /// the best split per feature of the node that is currently split
+    std::vector<Split> splits;
+    /// the pool that evaluates features in parallel
+    WorkerPool& pool;
+    /// the maximum depth of the tree
+    unsigned int maxDepth;
+    /// the minimum number of examples on each side of a split
+    unsigned int minExamplesPerLeaf;
+  };
+  /**
+   * @brief build creates the subtree for the examples in a range of the sorted lists
+   * @param state the training state
+   * @param begin the first position of the range
+   * @param end the first position after the range
+   * @param depth the depth of the subtree root
+   * @return the index of the subtree root
+   */
+  unsigned int build(TrainingState& state, unsigned int begin, unsigned int end, unsigned int depth);
+  /**
+   * @brief findSplit finds the best split of a range of examples on a single feature
+   * @param state the training state
+   * @param feature the feature
+   * @param begin the first position of the range
+   * @param end the first position after the range
+   * @return the best split
+   */
+  Split findSplit(const TrainingState& state, unsigned int feature, unsigned int begin, unsigned int end) const;
+  /// the number of features that the tree uses
+  unsigned int numFeatures = 0;
+  /// the nodes of the tree (the root is the first node)
+  std::vector<Node> nodes;
+};
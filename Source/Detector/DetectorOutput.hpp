@@ -0,0 +1,49 @@
+/**
+ * @file DetectorOutput.hpp declares the DetectorOutput struct
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <QMetaType>
+
+
+/**
+ * @struct ScoredFrame is the confidence of a detector that there is a whistle at some position
+ */
+struct ScoredFrame
+{
+  /// the position to which the score refers (in samples since the beginning of the file)
+  unsigned int position;
+  /// the reading position when the score has been emitted (in samples since the beginning of the file)
+  unsigned int detectionPosition;
+  /// the confidence of the detector (in a detector specific unit, larger means more likely a whistle)
+  float score;
+};
+
+/**
+ * @struct DetectorOutput contains everything a detector has emitted while processing a single channel
+ */
+struct DetectorOutput
+{
+  /// the positions of the detections made by the detector
+  std::vector<unsigned int> detections;
+  /// the reading positions when the detections have been made
+  std::vector<unsigned int> detectionPositions;
+  /// the execution times per buffer
+  std::vector<float> executionTimes;
+  /// the number of channels that have been processed together in each buffer
+  unsigned int channels = 1;
+  /// the scores that the detector has emitted (only for detectors that support scoring)
+  std::vector<ScoredFrame> scores;
+  /// the number of buffers after the warm-up whose allocations have been counted (0 if tracking is not compiled in or the output has been cached)
+  unsigned int allocationTrackedBuffers = 0;
+  /// the number of allocations by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocations = 0;
+  /// the number of bytes allocated by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocatedBytes = 0;
+};
+
+Q_DECLARE_METATYPE(DetectorOutput)
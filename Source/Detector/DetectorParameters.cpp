@@ -0,0 +1,123 @@
+/**
+ * @file DetectorParameters.cpp implements methods of the DetectorParameters class
+ */
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "DetectorParameters.hpp"
+
+
+namespace
+{
+  /**
+   * @class ParameterSetter assigns values from a map to the visited parameters
+   */
+  class ParameterSetter : public ParameterVisitor
+  {
+  public:
+    explicit ParameterSetter(const ParameterMap& values)
+      : values(values)
+    {
+    }
+    void visit(const char* name, bool& value) override
+    {
+      const double* v = find(name);
+      if (v != nullptr)
+      {
+        if (*v != 0.0 && *v != 1.0)
+        {
+          throw std::runtime_error("Boolean parameter " + std::string(name) + " has to be 0 or 1!");
+        }
+        value = (*v != 0.0);
+      }
+    }
+    void visit(const char* name, unsigned int& value) override
+    {
+      const double* v = find(name);
+      if (v != nullptr)
+      {
+        if (*v < 0.0 || *v > std::numeric_limits<unsigned int>::max() || std::floor(*v) != *v)
+        {
+          throw std::runtime_error("Integer parameter " + std::string(name) + " has to be a non-negative integer!");
+        }
+        value = static_cast<unsigned int>(*v);
+      }
+    }
+    void visit(const char* name, float& value) override
+    {
+      const double* v = find(name);
+      if (v != nullptr)
+      {
+        value = static_cast<float>(*v);
+      }
+    }
+    void visit(const char* name, double& value) override
+    {
+      const double* v = find(name);
+      if (v != nullptr)
+      {
+        value = *v;
+      }
+    }
+    /// the number of values that have been assigned to a parameter
+    unsigned int used = 0;
+  private:
+    const double* find(const char* name)
+    {
+      auto it = values.find(name);
+      if (it == values.end())
+      {
+        return nullptr;
+      }
+      used++;
+      return &it->second;
+    }
+    const ParameterMap& values;
+  };
+
+  /**
+   * @class ParameterGetter collects the values of the visited parameters in a map
+   */
+  class ParameterGetter : public ParameterVisitor
+  {
+  public:
+    void visit(const char* name, bool& value) override
+    {
+      values[name] = value ? 1.0 : 0.0;
+    }
+    void visit(const char* name, unsigned int& value) override
+    {
+      values[name] = value;
+    }
+    void visit(const char* name, float& value) override
+    {
+      values[name] = value;
+    }
+    void visit(const char* name, double& value) override
+    {
+      values[name] = value;
+    }
+    /// the collected values
+    ParameterMap values;
+  };
+}
+
+void DetectorParameters::set(const ParameterMap& values)
+{
+  ParameterSetter setter(values);
+  visit(setter);
+  if (setter.used != values.size())
+  {
+    throw std::runtime_error("Some parameters are not known by the detector!");
+  }
+}
+
+ParameterMap DetectorParameters::get() const
+{
+  ParameterGetter getter;
+  // The getter only reads the parameters, but visiting requires a non-const object.
+  const_cast<DetectorParameters*>(this)->visit(getter);
+  return getter.values;
+}
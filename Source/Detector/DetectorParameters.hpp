@@ -0,0 +1,75 @@
+/**
+ * @file DetectorParameters.hpp declares the base class for runtime parameters of detectors
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+
+/// a set of parameter values by name (all types are represented as double)
+typedef std::map<std::string, double> ParameterMap;
+
+/**
+ * @class ParameterVisitor is an operation that is applied to each parameter of a detector
+ */
+class ParameterVisitor
+{
+public:
+  /**
+   * @brief ~ParameterVisitor virtual destructor for polymorphism
+   */
+  virtual ~ParameterVisitor() = default;
+  /**
+   * @brief visit is called for a boolean parameter
+   * @param name the name of the parameter
+   * @param value a reference to the value of the parameter
+   */
+  virtual void visit(const char* name, bool& value) = 0;
+  /**
+   * @brief visit is called for an unsigned integer parameter
+   * @param name the name of the parameter
+   * @param value a reference to the value of the parameter
+   */
+  virtual void visit(const char* name, unsigned int& value) = 0;
+  /**
+   * @brief visit is called for a single precision parameter
+   * @param name the name of the parameter
+   * @param value a reference to the value of the parameter
+   */
+  virtual void visit(const char* name, float& value) = 0;
+  /**
+   * @brief visit is called for a double precision parameter
+   * @param name the name of the parameter
+   * @param value a reference to the value of the parameter
+   */
+  virtual void visit(const char* name, double& value) = 0;
+};
+
+/**
+ * @class DetectorParameters is the base class for the typed runtime parameters of a detector
+ */
+class DetectorParameters
+{
+public:
+  /**
+   * @brief ~DetectorParameters virtual destructor for polymorphism
+   */
+  virtual ~DetectorParameters() = default;
+  /**
+   * @brief visit applies a visitor to all parameters
+   * @param visitor the visitor that is applied to each parameter
+   */
+  virtual void visit(ParameterVisitor& visitor) = 0;
+  /**
+   * @brief set overrides the values of some parameters
+   * @param values the new values by name (throws if a name is unknown or a value does not fit the type)
+   */
+  void set(const ParameterMap& values);
+  /**
+   * @brief get returns the current values of all parameters
+   * @return the values of all parameters by name
+   */
+  ParameterMap get() const;
+};
@@ -2,6 +2,7 @@
  * @file EvaluationHandle.cpp implements methods of the EvaluationHandle class
  */
 
+#include <algorithm>
 #include <cstring>
 
 #ifdef __linux__
@@ -9,10 +10,14 @@
 #endif
 
 #include "EvaluationHandle.hpp"
+#include "Trace.hpp"
 
 
-EvaluationHandle::EvaluationHandle(const AudioFile& af)
+constexpr unsigned int EvaluationHandle::allocationWarmUpBuffers;
+
+EvaluationHandle::EvaluationHandle(const AudioFile& af, const NoiseMix* noise)
   : af(af)
+  , noise(noise)
 {
 }
 
@@ -26,30 +31,119 @@ unsigned int EvaluationHandle::getNumberOfChannels() const
   return af.numberOfChannels;
 }
 
+template<typename Read>
+auto EvaluationHandle::measureRead(const char* zone, const Read& read) -> decltype(read())
+{
+  // The name is unused if tracing is disabled.
+  static_cast<void>(zone);
+  const auto result = [&]
+  {
+    // The zone ends before the time is taken, so that recording it is not part of the execution time of the detector.
+    TRACE_SCOPE(zone);
+    return read();
+  }();
+  allocationsWhenLastRead = AllocationTracker::get();
+  timeWhenLastRead = getCurrentThreadTime();
+  return result;
+}
+
 unsigned int EvaluationHandle::readSingleChannel(float* buf, unsigned int length)
 {
-  if (timeWhenLastRead != 0)
+  recordExecutionTime(length);
+  recordAllocations();
+  return measureRead("EvaluationHandle::readSingleChannel", [&]
   {
-    const std::uint64_t timeWhenFinished = getCurrentThreadTime();
-    const float executionTimePerDuration =
-      (static_cast<float>(timeWhenFinished - timeWhenLastRead) / 1000000000.f)
-        / (static_cast<float>(length) / static_cast<float>(af.sampleRate));
-    executionTimes.push_back(executionTimePerDuration);
-  }
-  if (pos + length > static_cast<unsigned int>(af.channels[0].samples.size()))
+    if (pos == 0 && length > 0)
+    {
+      reserveOutput(static_cast<std::size_t>(af.channels[0].samples.size()) / length + 2);
+    }
+    if (pos + length > static_cast<unsigned int>(af.channels[0].samples.size()))
+    {
+      length = af.channels[0].samples.size() - pos;
+    }
+    std::memcpy(buf, af.channels[0].samples.data() + pos, length * sizeof(float));
+    if (noise != nullptr)
+    {
+      noise->apply(buf, pos, length, buf);
+    }
+    pos += length;
+    return length;
+  });
+}
+
+const float* EvaluationHandle::readWindow(const unsigned int windowSize, const unsigned int hopSize)
+{
+  // The window always ends at the new reading position, so only the samples after the old position are new.
+  const unsigned int newPos = std::max(pos + hopSize, windowSize);
+  recordExecutionTime(newPos - pos);
+  recordAllocations();
+  // Adding the noise is not part of the execution time of the detector.
+  return measureRead("EvaluationHandle::readWindow", [&]() -> const float*
   {
-    length = af.channels[0].samples.size() - pos;
-  }
-  std::memcpy(buf, af.channels[0].samples.data() + pos, length * sizeof(float));
-  pos += length;
-  timeWhenLastRead = getCurrentThreadTime();
-  return length;
+    const unsigned int length = static_cast<unsigned int>(af.channels[0].samples.size());
+    if (pos == 0 && hopSize > 0)
+    {
+      reserveOutput(length >= windowSize ? (length - windowSize) / hopSize + 2 : 1);
+    }
+    if (newPos > length)
+    {
+      pos = length;
+      return nullptr;
+    }
+    pos = newPos;
+    const float* window = af.channels[0].samples.data() + (pos - windowSize);
+    if (noise != nullptr)
+    {
+      window = addNoise(0, window, windowSize);
+    }
+    return window;
+  });
+}
+
+bool EvaluationHandle::readWindows(const unsigned int windowSize, const unsigned int hopSize, const float** windows)
+{
+  // All channels are processed in each read, so the execution time per channel is a fraction of the measured time.
+  output.channels = af.numberOfChannels;
+  return measureRead("EvaluationHandle::readWindows", [&]
+  {
+    const float* window = readWindow(windowSize, hopSize);
+    if (window == nullptr)
+    {
+      return false;
+    }
+    windows[0] = window;
+    for (int c = 1; c < af.channels.size(); c++)
+    {
+      if (static_cast<unsigned int>(af.channels[c].samples.size()) < pos)
+      {
+        return false;
+      }
+      windows[c] = af.channels[c].samples.data() + (pos - windowSize);
+      if (noise != nullptr)
+      {
+        windows[c] = addNoise(c, windows[c], windowSize);
+      }
+    }
+    return true;
+  });
+}
+
+unsigned int EvaluationHandle::getPosition() const
+{
+  return pos;
 }
 
 void EvaluationHandle::report(int offset)
 {
-  detectionPositions.push_back(pos);
-  detections.push_back(pos + offset);
+  TRACE_SCOPE("EvaluationHandle::report");
+  output.detectionPositions.push_back(pos);
+  output.detections.push_back(pos + offset);
+}
+
+void EvaluationHandle::score(float value, int offset)
+{
+  TRACE_SCOPE("EvaluationHandle::score");
+  output.scores.push_back({ pos + offset, pos, value });
 }
 
 int EvaluationHandle::insideWhistle(int offset) const
@@ -65,6 +159,61 @@ int EvaluationHandle::insideWhistle(int offset) const
   return 0;
 }
 
+const DetectorOutput& EvaluationHandle::getOutput() const
+{
+  return output;
+}
+
+void EvaluationHandle::recordExecutionTime(const unsigned int length)
+{
+  if (timeWhenLastRead != 0)
+  {
+    const std::uint64_t timeWhenFinished = getCurrentThreadTime();
+    const float executionTimePerDuration =
+      (static_cast<float>(timeWhenFinished - timeWhenLastRead) / 1000000000.f)
+        / (static_cast<float>(length) / static_cast<float>(af.sampleRate));
+    output.executionTimes.push_back(executionTimePerDuration);
+  }
+}
+
+void EvaluationHandle::recordAllocations()
+{
+  if (!AllocationTracker::enabled)
+  {
+    return;
+  }
+  // The first read has no buffer before it, so it counts towards the warm-up, too.
+  if (reads++ > allocationWarmUpBuffers)
+  {
+    const AllocationTracker::Counts counts = AllocationTracker::get();
+    output.allocationTrackedBuffers++;
+    output.steadyStateAllocations += counts.allocations - allocationsWhenLastRead.allocations;
+    output.steadyStateAllocatedBytes += counts.bytes - allocationsWhenLastRead.bytes;
+  }
+}
+
+void EvaluationHandle::reserveOutput(const std::size_t numberOfBuffers)
+{
+  // A detector emits at most one score and one detection per buffer (the detections are rare, but they come in bursts).
+  output.executionTimes.reserve(numberOfBuffers);
+  output.scores.reserve(numberOfBuffers);
+  output.detections.reserve(numberOfBuffers);
+  output.detectionPositions.reserve(numberOfBuffers);
+}
+
+const float* EvaluationHandle::addNoise(const int channel, const float* window, const unsigned int windowSize)
+{
+  // The buffer only grows with the first window, so that reading does not allocate memory afterwards.
+  const std::size_t size = static_cast<std::size_t>(af.channels.size()) * windowSize;
+  if (noisyWindows.size() < size)
+  {
+    noisyWindows.resize(size);
+  }
+  float* noisyWindow = noisyWindows.data() + static_cast<std::size_t>(channel) * windowSize;
+  noise->apply(window, pos - windowSize, windowSize, noisyWindow);
+  return noisyWindow;
+}
+
 std::uint64_t EvaluationHandle::getCurrentThreadTime()
 {
 #ifdef __linux__
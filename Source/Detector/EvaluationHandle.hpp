@@ -9,6 +9,10 @@
 
 #include "Engine/AudioFile.hpp"
 
+#include "AllocationTracker.hpp"
+#include "DetectorOutput.hpp"
+#include "NoiseMix.hpp"
+
 
 /**
  * @class EvaluationHandle delivers and collects data for the evaluation process
@@ -19,8 +23,9 @@ public:
   /**
    * @brief EvaluationHandle initializes members
    * @param af the audio file on which the detector is evaluated
+   * @param noise the noise that is added to all channels while they are read (nullptr if the file is read unchanged)
    */
-  explicit EvaluationHandle(const AudioFile& af);
+  explicit EvaluationHandle(const AudioFile& af, const NoiseMix* noise = nullptr);
   /**
    * @brief getSampleRate returns the sample rate of the audio file
    * @return the sample rate of the audio file
@@ -38,18 +43,83 @@ public:
    * @return the number of actually read samples
    */
   unsigned int readSingleChannel(float* buf, unsigned int length);
+  /**
+   * @brief readWindow advances the reading position and returns the window of samples that ends there without copying
+   *
+   * The first call reads up to the end of the first window, each further call advances by the hop size, so that
+   * consecutive windows overlap if the hop size is smaller than the window size. The samples are only valid as long
+   * as the audio file exists (and until the next read if noise is added) and must not be modified.
+   * @param windowSize the number of samples in the window
+   * @param hopSize the number of samples by which consecutive windows are apart
+   * @return a pointer to the windowSize samples of the first channel that end at the new reading position (nullptr if the end of the file has been reached)
+   */
+  const float* readWindow(unsigned int windowSize, unsigned int hopSize);
+  /**
+   * @brief readWindows is the same as readWindow but returns the window of every channel of the file
+   * @param windowSize the number of samples in each window
+   * @param hopSize the number of samples by which consecutive windows are apart
+   * @param windows is filled with a pointer to the window of each channel (getNumberOfChannels entries)
+   * @return whether the windows are valid (false if the end of the file has been reached)
+   */
+  bool readWindows(unsigned int windowSize, unsigned int hopSize, const float** windows);
+  /**
+   * @brief getPosition returns the current reading position
+   * @return the number of samples that have been read so far
+   */
+  unsigned int getPosition() const;
   /**
    * @brief report reports a whistle detection
    * @param offset the offset of the detection to the current reading position
    */
   void report(int offset = 0);
+  /**
+   * @brief score reports the confidence of the detector that there is a whistle (independent of any threshold)
+   * @param value the confidence (in a detector specific unit, larger means more likely a whistle)
+   * @param offset the offset of the scored frame to the current reading position
+   */
+  void score(float value, int offset = 0);
   /**
    * @brief insideWhistle determines whether the reading position is inside a whistle
    * @param offset the offset of the query to the current reading position
    * @return whether the reading position (plus offset) is inside a whistle
    */
   int insideWhistle(int offset = 0) const;
+  /**
+   * @brief getOutput returns everything that the detector has emitted so far
+   * @return the output of the detector
+   */
+  const DetectorOutput& getOutput() const;
 private:
+  /**
+   * @brief measureRead runs the body of a read method in a trace zone and then restarts measuring the detector
+   * @param zone the name of the trace zone
+   * @param read the body of the read method
+   * @return the result of the body
+   */
+  template<typename Read>
+  auto measureRead(const char* zone, const Read& read) -> decltype(read());
+  /**
+   * @brief recordExecutionTime records the time since the last read relative to the duration of newly read samples
+   * @param length the number of samples that are read
+   */
+  void recordExecutionTime(unsigned int length);
+  /**
+   * @brief recordAllocations counts the allocations since the last read if the warm-up is over
+   */
+  void recordAllocations();
+  /**
+   * @brief reserveOutput reserves the output for all buffers of the file, so that emitting does not allocate memory
+   * @param numberOfBuffers the number of buffers that the detector will read
+   */
+  void reserveOutput(std::size_t numberOfBuffers);
+  /**
+   * @brief addNoise adds the noise to the window of a channel that ends at the reading position
+   * @param channel the index of the channel
+   * @param window the samples of the window in the file
+   * @param windowSize the number of samples in the window
+   * @return the noisy samples of the window
+   */
+  const float* addNoise(int channel, const float* window, unsigned int windowSize);
   /**
    * @brief getCurrentThreadTime returns the current thread local time
    * @return the current thread time in nanoseconds since whatever
@@ -57,15 +127,21 @@ private:
   static std::uint64_t getCurrentThreadTime();
   /// the audio file on which the detector is evaluated
   const AudioFile& af;
+  /// the noise that is added to all channels (nullptr if the file is read unchanged)
+  const NoiseMix* noise;
+  /// the noisy windows of all channels (only used if noise is added)
+  std::vector<float> noisyWindows;
   /// the current reading position
   unsigned int pos = 0;
-  /// the vector that is filled with detections made by the detector
-  std::vector<unsigned int> detections;
-  /// the vector that is filled with the time points when the detection is made
-  std::vector<unsigned int> detectionPositions;
-  /// the execution times per buffer
-  std::vector<float> executionTimes;
+  /// everything that is emitted by the detector
+  DetectorOutput output;
   /// the time when the last read method returned
   std::uint64_t timeWhenLastRead = 0;
+  /// the allocation counts of the thread when the last read method returned
+  AllocationTracker::Counts allocationsWhenLastRead;
+  /// the number of reads so far
+  unsigned int reads = 0;
+  /// the number of buffers at the beginning of a file that may allocate memory (e.g. to set up buffers)
+  static constexpr unsigned int allocationWarmUpBuffers = 8;
   friend class WhistleDetectorBase;
 };
@@ -0,0 +1,317 @@
+/**
+ * @file EvaluationScorer.cpp implements methods of the EvaluationScorer class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+#include "EvaluationScorer.hpp"
+#include "Trace.hpp"
+
+
+EvaluationScorer::EvaluationScorer(EvaluationResults& results, const bool verbose)
+  : results(results)
+  , verbose(verbose)
+{
+  results.maximumDelay = 0.f;
+  results.minimumDelay = std::numeric_limits<float>::max();
+  results.averageDelay = 0.f;
+  results.maximumExecutionTimePerTime = 0.f;
+  results.minimumExecutionTimePerTime = std::numeric_limits<float>::max();
+  results.averageExecutionTimePerTime = 0.f;
+  results.averageExecutionTimePerChannel = 0.f;
+  results.thresholdCurve.clear();
+  results.rocArea = 0.f;
+  results.allocationTrackedBuffers = 0;
+  results.steadyStateAllocations = 0;
+  results.steadyStateAllocatedBytes = 0;
+}
+
+void EvaluationScorer::add(const AudioFile& file, const DetectorOutput& output)
+{
+  TRACE_SCOPE("EvaluationScorer::add");
+  for (auto execTime : output.executionTimes)
+  {
+    if (execTime > results.maximumExecutionTimePerTime)
+    {
+      results.maximumExecutionTimePerTime = execTime;
+    }
+    if (execTime < results.minimumExecutionTimePerTime)
+    {
+      results.minimumExecutionTimePerTime = execTime;
+    }
+    results.averageExecutionTimePerTime += execTime;
+    results.averageExecutionTimePerChannel += execTime / static_cast<float>(std::max(output.channels, 1U));
+  }
+  numOfExecutions += output.executionTimes.size();
+  results.allocationTrackedBuffers += output.allocationTrackedBuffers;
+  results.steadyStateAllocations += output.steadyStateAllocations;
+  results.steadyStateAllocatedBytes += output.steadyStateAllocatedBytes;
+  assert(output.detections.size() == output.detectionPositions.size());
+  std::vector<unsigned int> labelHits(file.channels[0].whistleLabels.size(), 0);
+  std::vector<float> labelDelays(file.channels[0].whistleLabels.size(), std::numeric_limits<float>::max());
+  unsigned int lastFP = 0;
+  for (unsigned int j = 0; j < output.detections.size(); j++)
+  {
+    const unsigned int pos = output.detections[j];
+    bool hit = false;
+    for (int i = 0; i < file.channels[0].whistleLabels.size(); i++)
+    {
+      auto& wl = file.channels[0].whistleLabels[i];
+      if (static_cast<unsigned int>(wl.start) < pos && pos < static_cast<unsigned int>(wl.end))
+      {
+        labelHits[i]++;
+        // The detection cannot be made when the detector hasn't even read any of the data containing the whistle.
+        assert(static_cast<int>(output.detectionPositions[j]) >= wl.start);
+        labelDelays[i] = std::min(labelDelays[i], static_cast<float>(output.detectionPositions[j] - wl.start) / static_cast<float>(file.sampleRate));
+        hit = true;
+        break;
+      }
+    }
+    if (!hit && file.channels[0].completelyLabeled)
+    {
+      // Only one false positive per second is counted as otherwise it would be unfair to detectors with small window sizes.
+      if (lastFP == 0 || pos > lastFP + file.sampleRate)
+      {
+        results.falsePositives++;
+        if (verbose)
+        {
+          std::cout << "Whistle in " << file.path.toStdString() << " at " << pos << " (i.e. "
+                    << (static_cast<float>(pos) / static_cast<float>(file.sampleRate)) << ") is a false positive!\n";
+        }
+        lastFP = std::max(1U, pos);
+      }
+    }
+  }
+  for (int i = 0; i < file.channels[0].whistleLabels.size(); i++)
+  {
+    if (labelHits[i])
+    {
+      results.truePositives++;
+      if (labelDelays[i] > results.maximumDelay)
+      {
+        results.maximumDelay = labelDelays[i];
+      }
+      if (labelDelays[i] < results.minimumDelay)
+      {
+        results.minimumDelay = labelDelays[i];
+      }
+      results.averageDelay += labelDelays[i];
+    }
+    if (verbose)
+    {
+      std::cout << "Whistle in " << file.path.toStdString() << " at " << file.channels[0].whistleLabels[i].start
+                << " (i.e. "
+                << (static_cast<float>(file.channels[0].whistleLabels[i].start) / static_cast<float>(file.sampleRate))
+                << ") has been " << (labelHits[i] ? "hit" : "missed") << "!\n";
+    }
+  }
+  results.positives += file.channels[0].whistleLabels.size();
+  if (!output.scores.empty())
+  {
+    scoredFiles.push_back({ &file, output.scores });
+  }
+}
+
+void EvaluationScorer::finish()
+{
+  TRACE_SCOPE("EvaluationScorer::finish");
+  if (results.truePositives != 0)
+  {
+    results.averageDelay /= static_cast<float>(results.truePositives);
+  }
+  if (numOfExecutions)
+  {
+    results.averageExecutionTimePerTime /= static_cast<float>(numOfExecutions);
+    results.averageExecutionTimePerChannel /= static_cast<float>(numOfExecutions);
+  }
+  else
+  {
+    // No buffer has been timed (e.g. because all outputs have been taken from the cache).
+    results.minimumExecutionTimePerTime = 0.f;
+  }
+  computeCurves();
+  if (!verbose)
+  {
+    return;
+  }
+  std::cout << "False Detections: " << results.falsePositives << '\n';
+  std::cout << "True Detections: " << results.truePositives << '/' << results.positives << '\n';
+  std::cout << "Minimum Delay: " << results.minimumDelay << "s\n";
+  std::cout << "Average Delay: " << results.averageDelay << "s\n";
+  std::cout << "Maximum Delay: " << results.maximumDelay << "s\n";
+  if (numOfExecutions)
+  {
+    std::cout << "Minimum execution time ratio: " << results.minimumExecutionTimePerTime << '\n';
+    std::cout << "Average execution time ratio: " << results.averageExecutionTimePerTime << '\n';
+    std::cout << "Maximum execution time ratio: " << results.maximumExecutionTimePerTime << '\n';
+    std::cout << "Average execution time ratio per channel: " << results.averageExecutionTimePerChannel << '\n';
+  }
+  else
+  {
+    std::cout << "Execution times have not been measured.\n";
+  }
+  if (results.allocationTrackedBuffers > 0)
+  {
+    const double buffers = static_cast<double>(results.allocationTrackedBuffers);
+    std::cout << "Steady state allocations per buffer: " << static_cast<double>(results.steadyStateAllocations) / buffers
+              << " (" << static_cast<double>(results.steadyStateAllocatedBytes) / buffers << " bytes, "
+              << results.allocationTrackedBuffers << " buffers)\n";
+  }
+  if (results.thresholdCurve.empty())
+  {
+    return;
+  }
+  // The threshold with the best F1 score (on whistle events) is a reasonable default for the detector.
+  const EvaluationResults::ThresholdPoint* best = nullptr;
+  float bestF1 = -1.f;
+  for (const auto& point : results.thresholdCurve)
+  {
+    const unsigned int detections = point.truePositives + point.falsePositives;
+    const float f1 = (results.positives + detections) ? 2.f * static_cast<float>(point.truePositives) / static_cast<float>(results.positives + detections) : 0.f;
+    if (f1 > bestF1)
+    {
+      bestF1 = f1;
+      best = &point;
+    }
+  }
+  std::cout << "Area under ROC curve: " << results.rocArea << '\n';
+  std::cout << "Best threshold: " << best->threshold << " (F1 " << bestF1 << ", " << best->truePositives << '/'
+            << results.positives << " hits, " << best->falsePositives << " false detections)\n";
+}
+
+void EvaluationScorer::computeCurves()
+{
+  // 1. Choose the thresholds as quantiles of the distinct scores. Most frames of a file usually have the same score
+  // (e.g. 0 for frames in which nothing has been found), so quantiles of all scores would collapse to few thresholds.
+  std::vector<float> allScores;
+  for (const auto& scoredFile : scoredFiles)
+  {
+    for (const auto& frame : scoredFile.scores)
+    {
+      allScores.push_back(frame.score);
+    }
+  }
+  if (allScores.empty())
+  {
+    return;
+  }
+  std::sort(allScores.begin(), allScores.end());
+  allScores.erase(std::unique(allScores.begin(), allScores.end()), allScores.end());
+  const std::size_t numberOfCurvePoints = std::min<std::size_t>(numberOfThresholds, allScores.size());
+  std::vector<float> thresholds(numberOfCurvePoints);
+  for (std::size_t k = 0; k < numberOfCurvePoints; k++)
+  {
+    thresholds[k] = allScores[k * allScores.size() / numberOfCurvePoints];
+  }
+  allScores.clear();
+  allScores.shrink_to_fit();
+
+  // 2. Find out for each frame how many thresholds it reaches and accumulate the counts per threshold.
+  // A frame reaches the thresholds [0, reached), thus the frame level counts are histograms over reached that are summed up afterwards.
+  const unsigned int K = static_cast<unsigned int>(thresholds.size());
+  std::vector<unsigned long> positiveFrames(K + 1, 0), negativeFrames(K + 1, 0);
+  std::vector<unsigned int> truePositives(K, 0), falsePositives(K, 0);
+  std::vector<double> delaySums(K, 0.0);
+  std::vector<float> positiveScores, negativeScores;
+  for (const auto& scoredFile : scoredFiles)
+  {
+    const AudioFile& file = *scoredFile.file;
+    const auto& labels = file.channels[0].whistleLabels;
+    // the number of thresholds for which each label has already been hit
+    std::vector<unsigned int> labelCoverage(labels.size(), 0);
+    std::vector<unsigned int> lastFP(K, 0);
+    for (const auto& frame : scoredFile.scores)
+    {
+      const unsigned int reached = static_cast<unsigned int>(std::upper_bound(thresholds.begin(), thresholds.end(), frame.score) - thresholds.begin());
+      int label = -1;
+      for (int i = 0; i < labels.size(); i++)
+      {
+        if (static_cast<unsigned int>(labels[i].start) < frame.position && frame.position < static_cast<unsigned int>(labels[i].end))
+        {
+          label = i;
+          break;
+        }
+      }
+      if (label >= 0)
+      {
+        positiveFrames[reached]++;
+        positiveScores.push_back(frame.score);
+        // Frames are emitted in order of their detection position, so the first frame that covers a threshold has the smallest delay.
+        const float delay = static_cast<float>(static_cast<int>(frame.detectionPosition) - labels[label].start) / static_cast<float>(file.sampleRate);
+        for (unsigned int k = labelCoverage[label]; k < reached; k++)
+        {
+          truePositives[k]++;
+          delaySums[k] += std::max(delay, 0.f);
+        }
+        labelCoverage[label] = std::max(labelCoverage[label], reached);
+      }
+      else if (file.channels[0].completelyLabeled)
+      {
+        negativeFrames[reached]++;
+        negativeScores.push_back(frame.score);
+        for (unsigned int k = 0; k < reached; k++)
+        {
+          if (lastFP[k] == 0 || frame.position > lastFP[k] + file.sampleRate)
+          {
+            falsePositives[k]++;
+            lastFP[k] = std::max(1U, frame.position);
+          }
+        }
+      }
+    }
+  }
+
+  // 3. Sum up the histograms from the highest threshold downwards and fill the curve.
+  unsigned long totalPositiveFrames = 0, totalNegativeFrames = 0;
+  for (unsigned int k = 0; k <= K; k++)
+  {
+    totalPositiveFrames += positiveFrames[k];
+    totalNegativeFrames += negativeFrames[k];
+  }
+  results.thresholdCurve.resize(K);
+  unsigned long positivesReaching = positiveFrames[K], negativesReaching = negativeFrames[K];
+  for (unsigned int k = K; k-- > 0;)
+  {
+    EvaluationResults::ThresholdPoint& point = results.thresholdCurve[k];
+    point.threshold = thresholds[k];
+    point.truePositiveRate = totalPositiveFrames ? static_cast<float>(positivesReaching) / static_cast<float>(totalPositiveFrames) : 0.f;
+    point.falsePositiveRate = totalNegativeFrames ? static_cast<float>(negativesReaching) / static_cast<float>(totalNegativeFrames) : 0.f;
+    point.truePositives = truePositives[k];
+    point.falsePositives = falsePositives[k];
+    point.averageDelay = truePositives[k] ? static_cast<float>(delaySums[k] / truePositives[k]) : 0.f;
+    positivesReaching += positiveFrames[k];
+    negativesReaching += negativeFrames[k];
+  }
+
+  // 4. Integrate the exact ROC curve by the trapezoidal rule, sweeping over all distinct scores from the highest downwards
+  // (the curve starts at (0, 0) and ends at (1, 1), frames with the same score form a single diagonal step).
+  std::sort(positiveScores.begin(), positiveScores.end(), std::greater<float>());
+  std::sort(negativeScores.begin(), negativeScores.end(), std::greater<float>());
+  float area = 0.5f;
+  if (!positiveScores.empty() && !negativeScores.empty())
+  {
+    double sum = 0.0;
+    std::size_t p = 0, n = 0;
+    while (p < positiveScores.size() || n < negativeScores.size())
+    {
+      const float score = (n == negativeScores.size() || (p < positiveScores.size() && positiveScores[p] > negativeScores[n])) ? positiveScores[p] : negativeScores[n];
+      const std::size_t lastP = p;
+      const std::size_t lastN = n;
+      while (p < positiveScores.size() && positiveScores[p] == score)
+      {
+        p++;
+      }
+      while (n < negativeScores.size() && negativeScores[n] == score)
+      {
+        n++;
+      }
+      sum += static_cast<double>(n - lastN) * static_cast<double>(p + lastP) * 0.5;
+    }
+    area = static_cast<float>(sum / (static_cast<double>(positiveScores.size()) * static_cast<double>(negativeScores.size())));
+  }
+  results.rocArea = area;
+}
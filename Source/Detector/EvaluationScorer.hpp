@@ -0,0 +1,65 @@
+/**
+ * @file EvaluationScorer.hpp declares the EvaluationScorer class
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "Engine/AudioFile.hpp"
+#include "Engine/EvaluationResults.hpp"
+
+#include "DetectorOutput.hpp"
+
+
+/**
+ * @class EvaluationScorer compares the output of a detector with the labels of the evaluated channels
+ *
+ * Binary detections are scored immediately. Scores are kept until all files have been added since the thresholds
+ * of the curve are quantiles of the distinct scores in the database and the ROC area is computed from all scores.
+ */
+class EvaluationScorer final
+{
+public:
+  /**
+   * @brief EvaluationScorer initializes the results
+   * @param results the results that are filled by the scorer
+   * @param verbose whether hits, misses and results are printed
+   */
+  EvaluationScorer(EvaluationResults& results, bool verbose);
+  /**
+   * @brief add scores the output of a detector on a file
+   * @param file the file on which the detector has been evaluated (has to live until finish is called)
+   * @param output the output of the detector on the first channel of the file
+   */
+  void add(const AudioFile& file, const DetectorOutput& output);
+  /**
+   * @brief finish computes averages and curves after all files have been added
+   */
+  void finish();
+private:
+  /**
+   * @struct ScoredFile contains the scores of a file until the curves are computed
+   */
+  struct ScoredFile
+  {
+    /// the file to which the scores belong
+    const AudioFile* file;
+    /// the scores emitted by the detector
+    std::vector<ScoredFrame> scores;
+  };
+  /**
+   * @brief computeCurves computes the threshold curve and the ROC area from the scores
+   */
+  void computeCurves();
+  /// the maximum number of thresholds in the threshold curve
+  static constexpr unsigned int numberOfThresholds = 100;
+  /// the results that are filled by the scorer
+  EvaluationResults& results;
+  /// whether hits, misses and results are printed
+  const bool verbose;
+  /// the number of execution time measurements
+  unsigned long numOfExecutions = 0;
+  /// the scores of all files that have been added
+  std::vector<ScoredFile> scoredFiles;
+};
@@ -0,0 +1,13 @@
+/**
+ * @file FFTWPlannerLock.cpp implements methods of the FFTWPlannerLock class
+ */
+
+#include "FFTWPlannerLock.hpp"
+
+
+std::mutex FFTWPlannerLock::mutex;
+
+FFTWPlannerLock::FFTWPlannerLock()
+  : lock(mutex)
+{
+}
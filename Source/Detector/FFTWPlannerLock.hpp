@@ -0,0 +1,28 @@
+/**
+ * @file FFTWPlannerLock.hpp declares the FFTWPlannerLock class
+ */
+
+#pragma once
+
+#include <mutex>
+
+
+/**
+ * @class FFTWPlannerLock serializes the creation and destruction of FFTW plans
+ *
+ * Only the execution of FFTW plans is thread safe, so every plan has to be created and destroyed while an instance
+ * of this class exists (as soon as detectors may run in parallel).
+ */
+class FFTWPlannerLock final
+{
+public:
+  /**
+   * @brief FFTWPlannerLock acquires the global planner mutex
+   */
+  FFTWPlannerLock();
+private:
+  /// the mutex that protects the FFTW planner
+  static std::mutex mutex;
+  /// the lock on the mutex that is held during the lifetime of this object
+  std::lock_guard<std::mutex> lock;
+};
@@ -0,0 +1,228 @@
+/**
+ * @file FeatureCache.cpp implements methods of the FeatureCache class
+ */
+
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "Engine/SampleDatabase.hpp"
+
+#include "FeatureCache.hpp"
+#include "Hasher.hpp"
+
+
+namespace
+{
+  /// the magic bytes at the beginning of a cache file
+  constexpr char magicBytes[8] = { 'W', 'L', 'F', 'E', 'A', 'T', 'S', '\0' };
+  /// the version of the file format
+  constexpr std::uint32_t currentFormatVersion = 1;
+}
+
+FeatureCache::FeatureCache(const unsigned int numFeatures)
+  : numFeatures(numFeatures)
+  , features(numFeatures)
+{
+}
+
+FeatureCache::~FeatureCache()
+{
+  clear();
+}
+
+std::uint64_t FeatureCache::computeKey(const SampleDatabase& db, const std::string& extractor, const unsigned int version, const ParameterMap& parameters)
+{
+  Hasher hasher;
+  hasher.add(extractor);
+  hasher.add(version);
+  for (const auto& parameter : parameters)
+  {
+    hasher.add(parameter.first);
+    hasher.add(parameter.second);
+  }
+  // The paths are not part of the key because the features only depend on the contents of the files.
+  hasher.add(static_cast<std::uint64_t>(db.audioFiles.size()));
+  for (const auto& file : db.audioFiles)
+  {
+    hasher.add(file.sampleRate);
+    hasher.add(static_cast<std::uint64_t>(file.channels.size()));
+    for (const auto& channel : file.channels)
+    {
+      hasher.add(static_cast<std::uint64_t>(channel.samples.size()));
+      hasher.add(channel.samples.data(), static_cast<std::size_t>(channel.samples.size()) * sizeof(float));
+      hasher.add(channel.completelyLabeled);
+      hasher.add(static_cast<std::uint64_t>(channel.whistleLabels.size()));
+      for (const auto& label : channel.whistleLabels)
+      {
+        hasher.add(label.start);
+        hasher.add(label.end);
+      }
+    }
+  }
+  return hasher.hash;
+}
+
+std::string FeatureCache::getFileName(const std::string& directory, const std::string& extractor, const std::uint64_t key)
+{
+  std::ostringstream name;
+  name << directory << '/' << extractor << '-' << std::hex << std::setw(16) << std::setfill('0') << key << ".features";
+  return name.str();
+}
+
+void FeatureCache::clear()
+{
+  if (mapping != nullptr)
+  {
+    file.unmap(mapping);
+    file.close();
+    mapping = nullptr;
+    numMappedRows = 0;
+  }
+  for (auto& column : features)
+  {
+    column.clear();
+  }
+  labels.clear();
+  files.clear();
+  channels.clear();
+  positions.clear();
+}
+
+void FeatureCache::append(const double* features, const bool label, const unsigned int file, const unsigned int channel, const unsigned int position)
+{
+  assert(mapping == nullptr);
+  for (unsigned int i = 0; i < numFeatures; i++)
+  {
+    this->features[i].push_back(features[i]);
+  }
+  labels.push_back(label ? 1 : 0);
+  files.push_back(file);
+  channels.push_back(channel);
+  positions.push_back(position);
+}
+
+bool FeatureCache::save(const std::string& fileName, const std::uint64_t key) const
+{
+  const QString name = QString::fromStdString(fileName);
+  QDir().mkpath(QFileInfo(name).path());
+  // The file is written under a temporary name and renamed on commit, so that an interrupted write never leaves a
+  // truncated file with a valid header.
+  QSaveFile out(name);
+  if (!out.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  const unsigned int numRows = size();
+  Header header;
+  std::memcpy(header.magic, magicBytes, sizeof(magicBytes));
+  header.formatVersion = currentFormatVersion;
+  header.numFeatures = numFeatures;
+  header.key = key;
+  header.numRows = numRows;
+  bool ok = out.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+  const auto writeColumn = [&](const void* data, const std::size_t elementSize)
+  {
+    const qint64 bytes = static_cast<qint64>(elementSize * numRows);
+    ok = ok && out.write(static_cast<const char*>(data), bytes) == bytes;
+  };
+  for (unsigned int i = 0; i < numFeatures; i++)
+  {
+    writeColumn(getFeature(i), sizeof(double));
+  }
+  writeColumn(getFiles(), sizeof(std::uint32_t));
+  writeColumn(getChannels(), sizeof(std::uint32_t));
+  writeColumn(getPositions(), sizeof(std::uint32_t));
+  writeColumn(getLabels(), sizeof(std::uint8_t));
+  return ok && out.commit();
+}
+
+bool FeatureCache::open(const std::string& fileName, const std::uint64_t key)
+{
+  clear();
+  file.setFileName(QString::fromStdString(fileName));
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  Header header;
+  if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+      || std::memcmp(header.magic, magicBytes, sizeof(magicBytes)) != 0 || header.formatVersion != currentFormatVersion
+      || header.numFeatures != numFeatures || header.key != key || header.numRows > 0xffffffffULL
+      || static_cast<std::uint64_t>(file.size()) != getFileSize(numFeatures, header.numRows))
+  {
+    file.close();
+    return false;
+  }
+  mapping = file.map(0, file.size());
+  if (mapping == nullptr)
+  {
+    file.close();
+    return false;
+  }
+  numMappedRows = static_cast<unsigned int>(header.numRows);
+  return true;
+}
+
+unsigned int FeatureCache::size() const
+{
+  return mapping != nullptr ? numMappedRows : static_cast<unsigned int>(labels.size());
+}
+
+const double* FeatureCache::getFeature(const unsigned int feature) const
+{
+  assert(feature < numFeatures);
+  if (mapping == nullptr)
+  {
+    return features[feature].data();
+  }
+  return reinterpret_cast<const double*>(mapping + sizeof(Header) + sizeof(double) * feature * numMappedRows);
+}
+
+const std::uint8_t* FeatureCache::getLabels() const
+{
+  if (mapping == nullptr)
+  {
+    return labels.data();
+  }
+  return mapping + sizeof(Header) + (sizeof(double) * numFeatures + 3 * sizeof(std::uint32_t)) * numMappedRows;
+}
+
+const std::uint32_t* FeatureCache::getFiles() const
+{
+  if (mapping == nullptr)
+  {
+    return files.data();
+  }
+  return reinterpret_cast<const std::uint32_t*>(mapping + sizeof(Header) + sizeof(double) * numFeatures * numMappedRows);
+}
+
+const std::uint32_t* FeatureCache::getChannels() const
+{
+  if (mapping == nullptr)
+  {
+    return channels.data();
+  }
+  return reinterpret_cast<const std::uint32_t*>(mapping + sizeof(Header) + (sizeof(double) * numFeatures + sizeof(std::uint32_t)) * numMappedRows);
+}
+
+const std::uint32_t* FeatureCache::getPositions() const
+{
+  if (mapping == nullptr)
+  {
+    return positions.data();
+  }
+  return reinterpret_cast<const std::uint32_t*>(mapping + sizeof(Header) + (sizeof(double) * numFeatures + 2 * sizeof(std::uint32_t)) * numMappedRows);
+}
+
+std::uint64_t FeatureCache::getFileSize(const std::uint64_t numFeatures, const std::uint64_t numRows)
+{
+  // The header has a size that is a multiple of 8, so all feature columns are aligned.
+  static_assert(sizeof(Header) % sizeof(double) == 0, "The header size has to be a multiple of 8!");
+  return sizeof(Header) + (sizeof(double) * numFeatures + 3 * sizeof(std::uint32_t) + sizeof(std::uint8_t)) * numRows;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file FeatureCache.hpp declares the FeatureCache class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QFile>
+
+#include "DetectorParameters.hpp"
+
+
+class SampleDatabase;
+
+/**
+ * @class FeatureCache stores the feature vectors that a detector has extracted from a database together with their labels
+ *
+ * The rows are stored column by column in a file, so that a classifier can be trained on the features of a database
+ * without running the feature extraction again. The file is memory-mapped when it is opened. It is keyed by a hash of
+ * the database contents and labels, the name and version of the feature extractor and its parameters, so that a
+ * changed database or extractor never reads stale features.
+ */
+class FeatureCache final
+{
+public:
+  /**
+   * @brief FeatureCache creates an empty cache
+   * @param numFeatures the number of features per row
+   */
+  explicit FeatureCache(unsigned int numFeatures);
+  /**
+   * @brief ~FeatureCache unmaps the file
+   */
+  ~FeatureCache();
+  FeatureCache(const FeatureCache&) = delete;
+  FeatureCache& operator=(const FeatureCache&) = delete;
+  /**
+   * @brief computeKey hashes everything on which the features of a database depend
+   * @param db the database from which the features are extracted
+   * @param extractor the name of the feature extractor
+   * @param version the version of the feature extractor (has to be increased whenever the features change)
+   * @param parameters the parameters of the feature extractor
+   * @return the key of the features
+   */
+  static std::uint64_t computeKey(const SampleDatabase& db, const std::string& extractor, unsigned int version, const ParameterMap& parameters);
+  /**
+   * @brief getFileName returns the name of the file in which the features of a key are cached
+   * @param directory the directory of the cache files
+   * @param extractor the name of the feature extractor
+   * @param key the key of the features
+   * @return the name of the cache file
+   */
+  static std::string getFileName(const std::string& directory, const std::string& extractor, std::uint64_t key);
+  /**
+   * @brief clear removes all rows (and unmaps the file if one is open)
+   */
+  void clear();
+  /**
+   * @brief append adds a row (only possible if no file is open)
+   * @param features the features of the row
+   * @param label whether the row is inside a whistle
+   * @param file the index of the file in the database
+   * @param channel the index of the channel in the file
+   * @param position the sample position in the channel
+   */
+  void append(const double* features, bool label, unsigned int file, unsigned int channel, unsigned int position);
+  /**
+   * @brief save writes the rows to a file
+   * @param fileName the name of the file (the directory is created if it does not exist)
+   * @param key the key of the features
+   * @return whether the file could be written
+   */
+  bool save(const std::string& fileName, std::uint64_t key) const;
+  /**
+   * @brief open maps a file with cached features (the previous rows are discarded)
+   * @param fileName the name of the file
+   * @param key the key that the features must have
+   * @return whether the file exists, is complete and has the key
+   */
+  bool open(const std::string& fileName, std::uint64_t key);
+  /**
+   * @brief size returns the number of rows
+   * @return the number of rows
+   */
+  unsigned int size() const;
+  /**
+   * @brief getFeature returns the column of a feature
+   * @param feature the index of the feature
+   * @return the values of the feature in all rows
+   */
+  const double* getFeature(unsigned int feature) const;
+  /**
+   * @brief getLabels returns the column of labels
+   * @return for each row, 1 if it is inside a whistle and 0 otherwise
+   */
+  const std::uint8_t* getLabels() const;
+  /**
+   * @brief getFiles returns the column of file indices
+   * @return for each row, the index of the file in the database
+   */
+  const std::uint32_t* getFiles() const;
+  /**
+   * @brief getChannels returns the column of channel indices
+   * @return for each row, the index of the channel in the file
+   */
+  const std::uint32_t* getChannels() const;
+  /**
+   * @brief getPositions returns the column of sample positions
+   * @return for each row, the sample position in the channel
+   */
+  const std::uint32_t* getPositions() const;
+private:
+  /**
+   * @struct Header is stored at the beginning of a cache file
+   */
+  struct Header
+  {
+    /// identifies cache files
+    char magic[8];
+    /// the version of the file format
+    std::uint32_t formatVersion;
+    /// the number of features per row
+    std::uint32_t numFeatures;
+    /// the key of the features
+    std::uint64_t key;
+    /// the number of rows
+    std::uint64_t numRows;
+  };
+  /**
+   * @brief getFileSize returns the size of a cache file
+   * @param numFeatures the number of features per row
+   * @param numRows the number of rows
+   * @return the size of the file in bytes
+   */
+  static std::uint64_t getFileSize(std::uint64_t numFeatures, std::uint64_t numRows);
+  /// the number of features per row
+  const unsigned int numFeatures;
+  /// the columns of the features of appended rows
+  std::vector<std::vector<double>> features;
+  /// the labels of appended rows
+  std::vector<std::uint8_t> labels;
+  /// the file indices of appended rows
+  std::vector<std::uint32_t> files;
+  /// the channel indices of appended rows
+  std::vector<std::uint32_t> channels;
+  /// the sample positions of appended rows
+  std::vector<std::uint32_t> positions;
+  /// the file that is mapped
+  QFile file;
+  /// the mapped contents of the file (nullptr if the rows have been appended)
+  uchar* mapping = nullptr;
+  /// the number of rows in the mapped file
+  unsigned int numMappedRows = 0;
+};
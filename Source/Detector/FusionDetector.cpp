@@ -0,0 +1,185 @@
+/**
+ * @file FusionDetector.cpp implements methods of the FusionDetector class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+#include "FFTWPlannerLock.hpp"
+#include "FusionDetector.hpp"
+#include "Trace.hpp"
+
+
+FusionDetector::~FusionDetector()
+{
+  if (fftPlan != nullptr)
+  {
+    FFTWPlannerLock lock;
+    fftwf_destroy_plan(fftPlan);
+  }
+}
+
+void FusionDetector::evaluate(EvaluationHandle& eh)
+{
+  if (!setup(eh.getSampleRate(), eh.getNumberOfChannels()))
+  {
+    return;
+  }
+  std::vector<const float*> windows(channels);
+  while (eh.readWindows(bufferSize, hopSize, windows.data()))
+  {
+    processWindows(eh, windows.data());
+  }
+}
+
+DetectorParameters& FusionDetector::getParameters()
+{
+  return parameters;
+}
+
+std::uint64_t FusionDetector::getVersion() const
+{
+  return outputVersion;
+}
+
+void FusionDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("minFrequency", minFrequency);
+  visitor.visit("maxFrequency", maxFrequency);
+  visitor.visit("threshold", threshold);
+  visitor.visit("voting", voting);
+  visitor.visit("minVotes", minVotes);
+}
+
+bool FusionDetector::setup(const unsigned int sampleRate, const unsigned int numberOfChannels)
+{
+  if (numberOfChannels == 0)
+  {
+    std::cerr << "FusionDetector: The file has no channels!\n";
+    return false;
+  }
+  const double freqResolution = static_cast<double>(bufferSize) / sampleRate;
+  minFreqIndex = static_cast<unsigned int>(std::ceil(parameters.minFrequency * freqResolution));
+  maxFreqIndex = static_cast<unsigned int>(std::ceil(parameters.maxFrequency * freqResolution));
+  if (maxFreqIndex > bufferSize / 2)
+  {
+    std::cerr << "FusionDetector: maxFreqIndex " << maxFreqIndex << " is larger than the Nyquist frequency!\n";
+    return false;
+  }
+  if (minFreqIndex > maxFreqIndex)
+  {
+    std::cerr << "FusionDetector: The whistle band is empty!\n";
+    return false;
+  }
+  if (hannWindow.empty())
+  {
+    hannWindow.resize(bufferSize);
+    for (unsigned int i = 0; i < bufferSize; i++)
+    {
+      hannWindow[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / bufferSize));
+    }
+  }
+  // The plan only depends on the number of channels, so it is kept as long as files have the same layout.
+  if (fftPlan != nullptr && channels == numberOfChannels)
+  {
+    return true;
+  }
+  channels = numberOfChannels;
+  input.assign(bufferSize * channels, 0.f);
+  spectrum.assign(dftSize * channels, 0.f);
+  bandPower.resize(channels);
+  stopBandPower.resize(channels);
+  ratios.resize(channels);
+  // The channels are interleaved, i.e. consecutive elements of one transform are channels elements apart and
+  // the transforms start at consecutive elements.
+  const int n = static_cast<int>(bufferSize);
+  const int stride = static_cast<int>(channels);
+  FFTWPlannerLock lock;
+  if (fftPlan != nullptr)
+  {
+    fftwf_destroy_plan(fftPlan);
+  }
+  fftPlan = fftwf_plan_many_dft_r2c(1, &n, stride, input.data(), nullptr, stride, 1,
+                                    reinterpret_cast<fftwf_complex*>(spectrum.data()), nullptr, stride, 1, FFTW_ESTIMATE);
+  return fftPlan != nullptr;
+}
+
+void FusionDetector::processWindows(EvaluationHandle& eh, const float* const* windows)
+{
+  TRACE_SCOPE("FusionDetector::processWindows");
+  // 1. Interleave the windowed samples of all channels (the copy is needed anyway to apply the window).
+  TRACE_STAGE(stage, "FusionDetector: 1. FFT");
+  for (unsigned int c = 0; c < channels; c++)
+  {
+    const float* window = windows[c];
+    float* channelInput = input.data() + c;
+    for (unsigned int i = 0; i < bufferSize; i++)
+    {
+      channelInput[i * channels] = hannWindow[i] * window[i];
+    }
+  }
+  fftwf_execute(fftPlan);
+
+  // 2. Accumulate the powers. The inner loops run over the channels of a bin, which are adjacent in the spectrum.
+  TRACE_NEXT_STAGE(stage, "FusionDetector: 2. Band powers");
+  std::fill(bandPower.begin(), bandPower.end(), 0.f);
+  std::fill(stopBandPower.begin(), stopBandPower.end(), 0.f);
+  for (unsigned int i = minFreqIndex; i < maxFreqIndex; i++)
+  {
+    const std::complex<float>* bin = spectrum.data() + i * channels;
+    for (unsigned int c = 0; c < channels; c++)
+    {
+      bandPower[c] += std::norm(bin[c]);
+    }
+  }
+  for (unsigned int i = maxFreqIndex; i < dftSize; i++)
+  {
+    const std::complex<float>* bin = spectrum.data() + i * channels;
+    for (unsigned int c = 0; c < channels; c++)
+    {
+      stopBandPower[c] += std::norm(bin[c]);
+    }
+  }
+
+  // 3. Fuse the evidence of all channels.
+  TRACE_NEXT_STAGE(stage, "FusionDetector: 3. Fusion");
+  float value = 0.f;
+  if (parameters.voting)
+  {
+    // At least minVotes channels are above the threshold iff the minVotes-th largest ratio is above it.
+    for (unsigned int c = 0; c < channels; c++)
+    {
+      ratios[c] = bandPower[c] / stopBandPower[c];
+      if (std::isnan(ratios[c]))
+      {
+        ratios[c] = 0.f;
+      }
+    }
+    const unsigned int votes = std::min(std::max(parameters.minVotes, 1U), channels);
+    std::nth_element(ratios.begin(), ratios.begin() + (votes - 1), ratios.end(), std::greater<float>());
+    value = ratios[votes - 1];
+  }
+  else
+  {
+    float band = 0.f, stopBand = 0.f;
+    for (unsigned int c = 0; c < channels; c++)
+    {
+      band += bandPower[c];
+      stopBand += stopBandPower[c];
+    }
+    value = band / stopBand;
+    // Silence yields 0 / 0, which is not a meaningful score.
+    if (std::isnan(value))
+    {
+      value = 0.f;
+    }
+  }
+  const int offset = -static_cast<int>(bufferSize) / 2;
+  eh.score(value, offset);
+  if (value > parameters.threshold)
+  {
+    eh.report(offset);
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file FusionDetector.hpp declares a detector class
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include <fftw3.h>
+
+#include "WhistleDetector.hpp"
+
+
+/**
+ * @class FusionDetector is a detector that listens to all microphones of a file and fuses their evidence
+ *
+ * The windows of all channels are transformed by a single batched FFT. Samples and bins are stored interleaved by
+ * channel, so that all per-bin computations run over the channels of one bin in contiguous memory.
+ */
+class FusionDetector : public WhistleDetector<FusionDetector>
+{
+public:
+  /**
+   * @brief ~FusionDetector destroys the FFTW plan
+   */
+  ~FusionDetector();
+  /**
+   * @brief evaluate evaluates the detector on all channels of a file
+   * @param eh delivers and collects data for the evaluation
+   */
+  void evaluate(EvaluationHandle& eh) override;
+  /**
+   * @brief getParameters returns the runtime parameters of the FusionDetector
+   * @return a reference to the parameters
+   */
+  DetectorParameters& getParameters() override;
+  /**
+   * @brief getVersion returns the version of the output of the FusionDetector
+   * @return the version of the FusionDetector
+   */
+  std::uint64_t getVersion() const override;
+private:
+  /**
+   * @brief setup computes the whistle band and creates the FFTW plan for a sample rate and number of channels
+   * @param sampleRate the sample rate of the file
+   * @param numberOfChannels the number of channels of the file
+   * @return whether the whistle band is valid
+   */
+  bool setup(unsigned int sampleRate, unsigned int numberOfChannels);
+  /**
+   * @brief processWindows compares the power in the whistle band with the power above it in all channels
+   * @param eh the handle to which detections and scores are reported
+   * @param windows the samples of the window of each channel
+   */
+  void processWindows(EvaluationHandle& eh, const float* const* windows);
+  /**
+   * @struct Parameters contains the runtime parameters of the FusionDetector
+   */
+  struct Parameters final : public DetectorParameters
+  {
+    /**
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
+     */
+    void visit(ParameterVisitor& visitor) override;
+    /// the minimum frequency of the whistle band
+    double minFrequency = 2000;
+    /// the maximum frequency of the whistle band
+    double maxFrequency = 4000;
+    /// the threshold for whistle power over stop band power
+    double threshold = 20;
+    /// whether the channels vote (otherwise their powers are summed before the ratio is taken)
+    bool voting = true;
+    /// the number of channels that have to be above the threshold when voting
+    unsigned int minVotes = 2;
+  };
+  /// the number of samples in a window
+  static constexpr unsigned int bufferSize = 1024;
+  /// the number of samples by which consecutive windows are apart
+  static constexpr unsigned int hopSize = bufferSize / 2;
+  /// the number of bins of the DFT of a window
+  static constexpr unsigned int dftSize = bufferSize / 2 + 1;
+  /// the version of the output (has to be increased whenever the output changes, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
+  /// the runtime parameters
+  Parameters parameters;
+  /// the number of channels for which the plan has been created
+  unsigned int channels = 0;
+  /// the first bin of the whistle band
+  unsigned int minFreqIndex = 0;
+  /// the first bin above the whistle band
+  unsigned int maxFreqIndex = 0;
+  /// the Hann window
+  std::vector<float> hannWindow;
+  /// the windowed samples of all channels (sample-major, i.e. the channels of a sample are adjacent)
+  std::vector<float> input;
+  /// the DFTs of all channels (bin-major, i.e. the channels of a bin are adjacent)
+  std::vector<std::complex<float>> spectrum;
+  /// the power in the whistle band per channel
+  std::vector<float> bandPower;
+  /// the power above the whistle band per channel
+  std::vector<float> stopBandPower;
+  /// the ratio of both powers per channel
+  std::vector<float> ratios;
+  /// a plan for FFTW that transforms all channels at once
+  fftwf_plan fftPlan = nullptr;
+};
@@ -2,76 +2,86 @@
  * @file HULKsDetector.cpp implements methods of the HULKsDetector class
  */
 
-#include <algorithm>
 #include <cmath>
-#include <complex>
 #include <iostream>
 
 #include "HULKsDetector.hpp"
+#include "Trace.hpp"
 
 
 HULKsDetector::HULKsDetector()
-  : realBuffer(bufferSize)
-  , complexBuffer(bufferSize / 2 + 1)
-  , fftPlan(fftw_plan_dft_r2c_1d(bufferSize, realBuffer.data(), reinterpret_cast<fftw_complex*>(complexBuffer.data()), FFTW_ESTIMATE))
+  : spectrum(bufferSize, false)
 {
   static_assert(bufferSize % 2 == 0, "The buffer size has to be even!");
 }
 
-HULKsDetector::~HULKsDetector()
+DetectorParameters& HULKsDetector::getParameters()
 {
-  fftw_destroy_plan(fftPlan);
+  return parameters;
 }
 
-void HULKsDetector::evaluate(EvaluationHandle& eh)
+std::uint64_t HULKsDetector::getVersion() const
 {
-  std::array<float, bufferSize> samples;
-  const std::vector<std::complex<double>>& freqData = complexBuffer;
-  const double freqResolution = static_cast<double>(bufferSize) / eh.getSampleRate();
-  const unsigned int minFreqIndex = static_cast<unsigned int>(std::ceil(minFrequency * freqResolution));
-  const unsigned int maxFreqIndex = static_cast<unsigned int>(std::ceil(maxFrequency * freqResolution));
-  if (maxFreqIndex >= complexBuffer.size())
+  return outputVersion;
+}
+
+bool HULKsDetector::dependsOnLabels() const
+{
+  return true;
+}
+
+void HULKsDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("minFrequency", minFrequency);
+  visitor.visit("maxFrequency", maxFrequency);
+  visitor.visit("threshold", threshold);
+}
+
+bool HULKsDetector::setup(const unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize)
+{
+  const double freqResolution = static_cast<double>(bufferSize) / sampleRate;
+  minFreqIndex = static_cast<unsigned int>(std::ceil(parameters.minFrequency * freqResolution));
+  maxFreqIndex = static_cast<unsigned int>(std::ceil(parameters.maxFrequency * freqResolution));
+  if (maxFreqIndex > bufferSize / 2)
   {
     std::cerr << "HULKsDetector: maxFreqIndex " << maxFreqIndex << " is larger than the Nyquist frequency!\n";
-    return;
+    return false;
   }
-
-  while (eh.readSingleChannel(samples.data(), bufferSize) == bufferSize)
+  if (minFreqIndex > maxFreqIndex)
   {
-    std::copy(samples.begin(), samples.end(), realBuffer.begin());
-    fftw_execute(fftPlan);
+    std::cerr << "HULKsDetector: The whistle band is empty!\n";
+    return false;
+  }
+  streamWindowSize = bufferSize;
+  streamHopSize = bufferSize;
+  return true;
+}
 
-    double power = 0;
-    double stopBandPower = 0;
+void HULKsDetector::processWindow(const float* window)
+{
+  TRACE_SCOPE("HULKsDetector::processWindow");
+  TRACE_STAGE(stage, "HULKsDetector: Spectrum");
+  spectrum.analyze(window);
 
-    for (unsigned int i = minFreqIndex; i < freqData.size(); i++)
-    {
-      // The multiplication by freqResolution is not strictly necessary since it cancels out in the division below.
-      const double abs2 = (freqData[i].real() * freqData[i].real() + freqData[i].imag() * freqData[i].imag()) / freqResolution;
-      if (i < maxFreqIndex)
-      {
-        power += abs2;
-      }
-      else
-      {
-        stopBandPower += abs2;
-      }
-    }
-    if (power / stopBandPower > threshold)
-    {
-      // To cope with the absurdly high buffer size, I need to cheat a bit to adjust the report position to a true whistle.
-      if (eh.insideWhistle(-static_cast<int>(bufferSize) / 8))
-      {
-        eh.report(-static_cast<int>(bufferSize) / 8);
-      }
-      else if (eh.insideWhistle(-static_cast<int>(bufferSize) * 7 / 8))
-      {
-        eh.report(-static_cast<int>(bufferSize) * 7 / 8);
-      }
-      else
-      {
-        eh.report(-static_cast<int>(bufferSize) / 2);
-      }
-    }
+  TRACE_NEXT_STAGE(stage, "HULKsDetector: Band powers");
+  // The division of both powers by freqResolution has been dropped since it cancels out in the ratio anyway.
+  const double power = spectrum.bandPower(minFreqIndex, maxFreqIndex);
+  const double stopBandPower = spectrum.powerAbove(maxFreqIndex);
+  const double ratio = power / stopBandPower;
+  // To cope with the absurdly high buffer size, I need to cheat a bit to adjust the report position to a true whistle.
+  int offset = -static_cast<int>(bufferSize) / 2;
+  if (insideWhistle(-static_cast<int>(bufferSize) / 8))
+  {
+    offset = -static_cast<int>(bufferSize) / 8;
+  }
+  else if (insideWhistle(-static_cast<int>(bufferSize) * 7 / 8))
+  {
+    offset = -static_cast<int>(bufferSize) * 7 / 8;
+  }
+  // Silence yields 0 / 0, which is not a meaningful score.
+  score(std::isnan(ratio) ? 0.f : static_cast<float>(ratio), offset);
+  if (ratio > parameters.threshold)
+  {
+    report(offset);
   }
 }
@@ -4,45 +4,76 @@
 
 #pragma once
 
-#include <complex>
-
-#include <fftw3.h>
-
+#include "BandLimitedSpectrum.hpp"
 #include "WhistleDetector.hpp"
 
 
 /**
  * @class HULKsDetector is the whistle detector of the SPL team HULKs
  */
-class HULKsDetector : public WhistleDetector<HULKsDetector>
+class HULKsDetector : public WhistleDetector<HULKsDetector, StreamingWhistleDetectorBase>
 {
 public:
   /**
-   * @brief HULKsDetector initializes members and FFTW plan
+   * @brief HULKsDetector initializes members
    */
   HULKsDetector();
   /**
-   * @brief ~HULKsDetector destroys FFTW plan
+   * @brief getParameters returns the runtime parameters of the HULKsDetector
+   * @return a reference to the parameters
    */
-  ~HULKsDetector();
+  DetectorParameters& getParameters() override;
   /**
-   * @brief evaluate evaluates the HULKsDetector on a given file
-   * @param eh delivers and collects data for the evaluation
+   * @brief getVersion returns the version of the output of the HULKsDetector
+   * @return the version of the HULKsDetector
    */
-  void evaluate(EvaluationHandle& eh) override;
+  std::uint64_t getVersion() const override;
+  /**
+   * @brief dependsOnLabels returns true because the HULKsDetector reports detections relative to the labeled whistles
+   * @return whether the output depends on the labels
+   */
+  bool dependsOnLabels() const override;
 private:
+  /**
+   * @brief setup computes the whistle band for a sample rate
+   * @param sampleRate the sample rate of the stream
+   * @param streamWindowSize is set to the buffer size
+   * @param streamHopSize is set to the buffer size
+   * @return whether the whistle band is valid
+   */
+  bool setup(unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize) override;
+  /**
+   * @brief processWindow compares the power in the whistle band with the power above it
+   * @param window the samples of the buffer
+   */
+  void processWindow(const float* window) override;
+  /**
+   * @struct Parameters contains the runtime parameters of the HULKsDetector
+   */
+  struct Parameters final : public DetectorParameters
+  {
+    /**
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
+     */
+    void visit(ParameterVisitor& visitor) override;
+    /// the minimum frequency of the whistle band
+    double minFrequency = 2000;
+    /// the maximum frequency of the whistle band
+    double maxFrequency = 4000;
+    /// the threshold for whistle power over stop band power
+    double threshold = 50;
+  };
   /// the buffer size (a parameter)
   static constexpr unsigned int bufferSize = 8192;
-  /// the minimum frequency of the whistle band (a parameter)
-  static constexpr double minFrequency = 2000;
-  /// the maximum frequency of the whistle band (a parameter)
-  static constexpr double maxFrequency = 4000;
-  /// the threshold for whistle power over stop band power (a parameter)
-  static constexpr double threshold = 50;
-  /// a buffer for the real input of the FFT
-  std::vector<double> realBuffer;
-  /// a buffer for the complex output of the FFT
-  std::vector<std::complex<double>> complexBuffer;
-  /// a plan for FFTW for the FFT
-  fftw_plan fftPlan;
+  /// the version of the output (has to be increased whenever the output changes, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
+  /// the runtime parameters
+  Parameters parameters;
+  /// the first bin of the whistle band
+  unsigned int minFreqIndex = 0;
+  /// the first bin above the whistle band
+  unsigned int maxFreqIndex = 0;
+  /// the spectrum of the current buffer
+  BandLimitedSpectrum spectrum;
 };
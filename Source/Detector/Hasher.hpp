@@ -0,0 +1,51 @@
+/**
+ * @file Hasher.hpp declares the Hasher class
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @class Hasher computes a 64 bit FNV-1a hash
+ */
+class Hasher final
+{
+public:
+  /**
+   * @brief add adds bytes to the hash
+   * @param data the bytes
+   * @param size the number of bytes
+   */
+  void add(const void* data, const std::size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+      hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  }
+  /**
+   * @brief add adds a value to the hash
+   * @param value the value
+   */
+  template<typename T>
+  void add(const T& value)
+  {
+    add(&value, sizeof(value));
+  }
+  /**
+   * @brief add adds a string (including its length) to the hash
+   * @param value the string
+   */
+  void add(const std::string& value)
+  {
+    add(static_cast<std::uint64_t>(value.size()));
+    add(value.data(), value.size());
+  }
+  /// the current hash
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+};
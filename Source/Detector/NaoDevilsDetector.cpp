@@ -4,117 +4,129 @@
  * https://github.com/NaoDevils/CodeRelease2016/blob/master/Src/Modules/Modeling/WhistleDetector/WhistleDetector.cpp
  */
 
+#include <algorithm>
 #include <cassert>
-#include <cmath>
 #include <iostream>
 
 #include "NaoDevilsDetector.hpp"
+#include "Trace.hpp"
 
 
 NaoDevilsDetector::NaoDevilsDetector()
-  : realBuffer(windowSize)
-  , complexBuffer(windowSize / 2 + 1)
-  , fftPlan(fftwf_plan_dft_r2c_1d(windowSize, realBuffer.data(), reinterpret_cast<fftwf_complex*>(complexBuffer.data()), FFTW_ESTIMATE))
+  : spectrum(windowSize, useHannWindowing)
 {
   static_assert(windowSize % 2 == 0, "The window size has to be even!");
 }
 
-NaoDevilsDetector::~NaoDevilsDetector()
+DetectorParameters& NaoDevilsDetector::getParameters()
 {
-  fftwf_destroy_plan(fftPlan);
+  return parameters;
 }
 
-void NaoDevilsDetector::evaluate(EvaluationHandle& eh)
+std::uint64_t NaoDevilsDetector::getVersion() const
 {
-  unsigned int attackCount = 0, releaseCount = release, ringPos = 0;
-  std::vector<float> buffer(windowSize, 0.0f);
-  // This leads to a swapped buffer in every second cycle (i.e. the first half of the buffer was recorded after the second half).
-  // This is the same way as in the original Nao Devils implementations and has no effect as only the absolute value of the
-  // Fourier transform is used.
-  while (eh.readSingleChannel(buffer.data() + ringPos, windowSize / 2) == windowSize / 2)
-  {
-    bool detected = false;
-    ringPos += windowSize / 2;
-    ringPos %= windowSize;
-    for (unsigned int i = 0; i < windowSize; i++)
-    {
-      realBuffer[i] = buffer[i];
-      if (useHannWindowing)
-      {
-        realBuffer[i] *= std::pow(std::sin(static_cast<float>(M_PI) * static_cast<float>(i) / windowSize), 2.0f);
-      }
-    }
+  return outputVersion;
+}
 
-    fftwf_execute(fftPlan);
+void NaoDevilsDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("minFrequency", minFrequency);
+  visitor.visit("maxFrequency", maxFrequency);
+  visitor.visit("minAmp", minAmp);
+  visitor.visit("overtoneMultMin1", overtoneMultMin1);
+  visitor.visit("overtoneMultMax1", overtoneMultMax1);
+  visitor.visit("overtoneMinAmp1", overtoneMinAmp1);
+  visitor.visit("overtoneMultMin2", overtoneMultMin2);
+  visitor.visit("overtoneMultMax2", overtoneMultMax2);
+  visitor.visit("overtoneMinAmp2", overtoneMinAmp2);
+  visitor.visit("release", release);
+  visitor.visit("attack", attack);
+}
 
-    // This code is intentionally not that efficient/nice to keep it close to the original implementation.
-    std::vector<float> amplitudes(ampSize);
-    for (unsigned int i = 0; i < ampSize; i++)
-    {
-      const float
-        abs2 = (complexBuffer[i].real() * complexBuffer[i].real() + complexBuffer[i].imag() * complexBuffer[i].imag());
-      amplitudes[i] = std::sqrt(abs2);
-    }
+bool NaoDevilsDetector::setup(const unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize)
+{
+  attackCount = 0;
+  swapHalves = false;
+  releaseCount = parameters.release;
+  minFundamentalI = parameters.minFrequency * windowSize / sampleRate;
+  maxFundamentalI = parameters.maxFrequency * windowSize / sampleRate;
+  if (minFundamentalI > maxFundamentalI
+      || static_cast<unsigned int>(static_cast<float>(maxFundamentalI) * std::max(parameters.overtoneMultMax1, parameters.overtoneMultMax2)) >= ampSize)
+  {
+    std::cerr << "NaoDevilsDetector: The searched frequency ranges are empty or exceed the Nyquist frequency!\n";
+    return false;
+  }
+  // The windows overlap by half of their size as in the original Nao Devils implementation. The original fills a ring
+  // buffer, so the halves of every second window are swapped, and it starts with a window that is half zeros. Here, the
+  // first window is skipped and the halves of every second window are swapped while it is analyzed.
+  streamWindowSize = windowSize;
+  streamHopSize = windowSize / 2;
+  return true;
+}
 
-    unsigned int minI = minFrequency * windowSize / eh.getSampleRate();
-    unsigned int maxI = maxFrequency * windowSize / eh.getSampleRate();
+void NaoDevilsDetector::processWindow(const float* window)
+{
+  bool detected = false;
+  TRACE_SCOPE("NaoDevilsDetector::processWindow");
+  TRACE_STAGE(stage, "NaoDevilsDetector: Spectrum");
+  spectrum.analyze(window, swapHalves);
+  swapHalves = !swapHalves;
+
+  TRACE_NEXT_STAGE(stage, "NaoDevilsDetector: Peaks");
+  float peakAmp = 0.f;
+  const unsigned int peakPos = findPeak(minFundamentalI, maxFundamentalI, peakAmp);
+  if (peakAmp >= parameters.minAmp)
+  {
+    unsigned int minI = static_cast<unsigned int>(static_cast<float>(peakPos) * parameters.overtoneMultMin1);
+    unsigned int maxI = static_cast<unsigned int>(static_cast<float>(peakPos) * parameters.overtoneMultMax1);
     assert(maxI < ampSize);
-    unsigned int peakPos = minI;
-    for (unsigned int i = minI; i <= maxI; i++)
-    {
-      if (amplitudes[i] > amplitudes[peakPos])
-      {
-        peakPos = i;
-      }
-    }
-    if (amplitudes[peakPos] >= minAmp)
+    float peak1Amp = 0.f;
+    findPeak(minI, maxI, peak1Amp);
+    if (peak1Amp >= parameters.overtoneMinAmp1)
     {
-      minI = static_cast<unsigned int>(static_cast<float>(peakPos) * overtoneMultMin1);
-      maxI = static_cast<unsigned int>(static_cast<float>(peakPos) * overtoneMultMax1);
+      minI = static_cast<unsigned int>(static_cast<float>(peakPos) * parameters.overtoneMultMin2);
+      maxI = static_cast<unsigned int>(static_cast<float>(peakPos) * parameters.overtoneMultMax2);
       assert(maxI < ampSize);
-      unsigned int peak1Pos = minI;
-      for (unsigned int i = minI; i <= maxI; i++)
-      {
-        if (amplitudes[i] > amplitudes[peak1Pos])
-        {
-          peak1Pos = i;
-        }
-      }
-      if (amplitudes[peak1Pos] >= overtoneMinAmp1)
-      {
-        minI = static_cast<unsigned int>(static_cast<float>(peakPos) * overtoneMultMin2);
-        maxI = static_cast<unsigned int>(static_cast<float>(peakPos) * overtoneMultMax2);
-        assert(maxI < ampSize);
-        unsigned int peak2Pos = minI;
-        for (unsigned int i = minI; i <= maxI; i++)
-        {
-          if (amplitudes[i] > amplitudes[peak2Pos])
-          {
-            peak2Pos = i;
-          }
-        }
-        if (amplitudes[peak2Pos] >= overtoneMinAmp2)
-        {
-          detected = true;
-        }
-      }
-    }
-    if (detected)
-    {
-      attackCount++;
-      releaseCount = 0;
-      if (attackCount >= attack)
+      float peak2Amp = 0.f;
+      findPeak(minI, maxI, peak2Amp);
+      if (peak2Amp >= parameters.overtoneMinAmp2)
       {
-        eh.report(-static_cast<int>(windowSize) / 2);
+        detected = true;
       }
     }
-    else if (releaseCount < release)
+  }
+  TRACE_NEXT_STAGE(stage, "NaoDevilsDetector: Attack and release");
+  if (detected)
+  {
+    attackCount++;
+    releaseCount = 0;
+    if (attackCount >= parameters.attack)
     {
-      releaseCount++;
+      report(-static_cast<int>(windowSize) / 2);
     }
-    else
+  }
+  else if (releaseCount < parameters.release)
+  {
+    releaseCount++;
+  }
+  else
+  {
+    attackCount = 0;
+  }
+}
+
+unsigned int NaoDevilsDetector::findPeak(const unsigned int minI, const unsigned int maxI, float& peakAmp)
+{
+  unsigned int peakPos = minI;
+  peakAmp = static_cast<float>(spectrum.amplitude(minI));
+  for (unsigned int i = minI + 1; i <= maxI; i++)
+  {
+    const float amp = static_cast<float>(spectrum.amplitude(i));
+    if (amp > peakAmp)
     {
-      attackCount = 0;
+      peakPos = i;
+      peakAmp = amp;
     }
   }
+  return peakPos;
 }
@@ -4,65 +4,105 @@
 
 #pragma once
 
-#include <complex>
-
-#include <fftw3.h>
-
+#include "BandLimitedSpectrum.hpp"
 #include "WhistleDetector.hpp"
 
 
 /**
  * @class NaoDevilsDetector is the whistle detector of the SPL team Nao Devils Dortmund
  */
-class NaoDevilsDetector : public WhistleDetector<NaoDevilsDetector>
+class NaoDevilsDetector : public WhistleDetector<NaoDevilsDetector, StreamingWhistleDetectorBase>
 {
 public:
   /**
-   * @brief NaoDevilsDetector initializes members and FFTW plan
+   * @brief NaoDevilsDetector initializes members
    */
   NaoDevilsDetector();
   /**
-   * @brief ~NaoDevilsDetector destroys FFTW plan
+   * @brief getParameters returns the runtime parameters of the NaoDevilsDetector
+   * @return a reference to the parameters
    */
-  ~NaoDevilsDetector();
+  DetectorParameters& getParameters() override;
   /**
-   * @brief evaluate evaluates the NaoDevilsDetector on a given file
-   * @param eh delivers and collects data for the evaluation
+   * @brief getVersion returns the version of the output of the NaoDevilsDetector
+   * @return the version of the NaoDevilsDetector
    */
-  void evaluate(EvaluationHandle& eh) override;
+  std::uint64_t getVersion() const override;
 private:
+  /**
+   * @brief setup computes the searched bins for a sample rate and resets the attack and release counters
+   * @param sampleRate the sample rate of the stream
+   * @param streamWindowSize is set to the window size
+   * @param streamHopSize is set to half of the window size
+   * @return whether the searched frequency ranges are valid
+   */
+  bool setup(unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize) override;
+  /**
+   * @brief processWindow searches a window for a fundamental frequency and two overtones
+   * @param window the samples of the window
+   */
+  void processWindow(const float* window) override;
+  /**
+   * @brief findPeak finds the bin with the highest amplitude in a range of the current spectrum
+   * @param minI the first bin of the range
+   * @param maxI the last bin of the range (inclusive)
+   * @param peakAmp is set to the amplitude at the peak
+   * @return the bin with the highest amplitude
+   */
+  unsigned int findPeak(unsigned int minI, unsigned int maxI, float& peakAmp);
+  /**
+   * @struct Parameters contains the runtime parameters of the NaoDevilsDetector
+   */
+  struct Parameters final : public DetectorParameters
+  {
+    /**
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
+     */
+    void visit(ParameterVisitor& visitor) override;
+    /// the minimum frequency of the fundamental frequency
+    unsigned int minFrequency = 2000;
+    /// the maximum frequency of the fundamental frequency
+    unsigned int maxFrequency = 4000;
+    /// the minimum amplitude of the fundamental frequency
+    float minAmp = 35.f;
+    /// the minimum factor between fundamental frequency and first overtone frequency
+    float overtoneMultMin1 = 1.8f;
+    /// the maximum factor between fundamental frequency and first overtone frequency
+    float overtoneMultMax1 = 2.2f;
+    /// the minimum amplitude of the first overtone
+    float overtoneMinAmp1 = 2.0f;
+    /// the minimum factor between fundamental frequency and second overtone frequency
+    float overtoneMultMin2 = 2.8f;
+    /// the maximum factor between fundamental frequency and second overtone frequency
+    float overtoneMultMax2 = 3.2f;
+    /// the minimum amplitude of the second overtone
+    float overtoneMinAmp2 = 2.0f;
+    /// the number of buffers that are classified positive after a whistle has been detected
+    unsigned int release = 4;
+    /// the number of successive buffers that have to be classified positive to be accepted as whistle
+    unsigned int attack = 4;
+  };
   /// the FFT window size (a parameter)
   static constexpr unsigned int windowSize = 1024;
-  /// the minimum frequency of the fundamental frequency (a parameter)
-  static constexpr unsigned int minFrequency = 2000;
-  /// the maximum frequency of the fundamental frequency (a parameter)
-  static constexpr unsigned int maxFrequency = 4000;
-  /// the minimum amplitude of the fundamental frequency (a parameter)
-  static constexpr float minAmp = 35.f;
-  /// the minimum factor between fundamental frequency and first overtone frequency (a parameter)
-  static constexpr float overtoneMultMin1 = 1.8f;
-  /// the maximum factor between fundamental frequency and first overtone frequency (a parameter)
-  static constexpr float overtoneMultMax1 = 2.2f;
-  /// the minimum amplitude of the first overtone (a parameter)
-  static constexpr float overtoneMinAmp1 = 2.0f;
-  /// the minimum factor between fundamental frequency and second overtone frequency (a parameter)
-  static constexpr float overtoneMultMin2 = 2.8f;
-  /// the maximum factor between fundamental frequency and second overtone frequency (a parameter)
-  static constexpr float overtoneMultMax2 = 3.2f;
-  /// the minimum amplitude of the second overtone (a parameter)
-  static constexpr float overtoneMinAmp2 = 2.0f;
-  /// the number of buffers that are classified positive after a whistle has been detected (a parameter)
-  static constexpr unsigned int release = 4;
-  /// the number of successive buffers that have to be classified positive to be accepted as whistle (a parameter)
-  static constexpr unsigned int attack = 4;
   /// whether Hann windowing should be used before executing the FFT (a parameter)
   static constexpr bool useHannWindowing = true;
   /// the number of amplitudes coming out of the FFT (derived parameter)
   static constexpr unsigned int ampSize = windowSize / 2 + 1;
-  /// a buffer for the real input of the FFT
-  std::vector<float> realBuffer;
-  /// a buffer for the complex output of the FFT
-  std::vector<std::complex<float>> complexBuffer;
-  /// a plan for FFTW for the FFT
-  fftwf_plan fftPlan;
+  /// the version of the output (has to be increased whenever the output changes, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
+  /// the runtime parameters
+  Parameters parameters;
+  /// the spectrum of the current window
+  BandLimitedSpectrum spectrum;
+  /// the first bin in which the fundamental frequency is searched
+  unsigned int minFundamentalI = 0;
+  /// the last bin in which the fundamental frequency is searched
+  unsigned int maxFundamentalI = 0;
+  /// whether the halves of the next window are swapped (as in the ring buffer of the original implementation)
+  bool swapHalves = false;
+  /// the number of successive windows that have been classified positive
+  unsigned int attackCount = 0;
+  /// the number of windows since the last window that has been classified positive
+  unsigned int releaseCount = 0;
 };
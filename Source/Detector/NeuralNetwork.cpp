@@ -0,0 +1,254 @@
+/**
+ * @file NeuralNetwork.cpp implements methods of the NeuralNetwork class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "NeuralNetwork.hpp"
+
+
+namespace
+{
+  /// the maximum number of inputs (so that a group of frames fits on the stack)
+  constexpr unsigned int maxInputs = 16;
+  /// the number of frames that are processed at once
+  constexpr unsigned int groupSize = 4;
+  /// the argument above which the approximation of tanh has reached 1
+  constexpr float tanhLimit = 4.97f;
+
+  /**
+   * @brief approximateTanh computes tanh by a [7/6] Padé approximation (the absolute error is below 1e-4)
+   * @param x the argument
+   * @return approximately tanh(x)
+   */
+  inline float approximateTanh(float x)
+  {
+    x = std::min(std::max(x, -tanhLimit), tanhLimit);
+    const float x2 = x * x;
+    const float num = x * (135135.f + x2 * (17325.f + x2 * (378.f + x2)));
+    const float den = 135135.f + x2 * (62370.f + x2 * (3150.f + x2 * 28.f));
+    return std::min(std::max(num / den, -1.f), 1.f);
+  }
+
+#ifdef __SSE2__
+  /**
+   * @brief madd computes a * b + c (fused if the CPU supports it)
+   * @param a the first factor
+   * @param b the second factor
+   * @param c the summand
+   * @return a * b + c in each lane
+   */
+  inline __m128 madd(const __m128 a, const __m128 b, const __m128 c)
+  {
+#ifdef __FMA__
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+  }
+
+  /**
+   * @brief approximateTanh computes tanh by a [7/6] Padé approximation in each lane
+   * @param x the arguments
+   * @return approximately tanh(x) in each lane
+   */
+  inline __m128 approximateTanh(__m128 x)
+  {
+    const __m128 limit = _mm_set1_ps(tanhLimit);
+    const __m128 one = _mm_set1_ps(1.f);
+    x = _mm_min_ps(_mm_max_ps(x, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 num = _mm_add_ps(x2, _mm_set1_ps(378.f));
+    num = madd(num, x2, _mm_set1_ps(17325.f));
+    num = _mm_mul_ps(madd(num, x2, _mm_set1_ps(135135.f)), x);
+    __m128 den = madd(x2, _mm_set1_ps(28.f), _mm_set1_ps(3150.f));
+    den = madd(den, x2, _mm_set1_ps(62370.f));
+    den = madd(den, x2, _mm_set1_ps(135135.f));
+    const __m128 y = _mm_div_ps(num, den);
+    return _mm_min_ps(_mm_max_ps(y, _mm_sub_ps(_mm_setzero_ps(), one)), one);
+  }
+#endif
+}
+
+bool NeuralNetwork::load(fann* ann, const double* means, const double* stddevs)
+{
+  numInputs = 0;
+  numHidden = 0;
+  if (ann == nullptr || fann_get_num_layers(ann) != 3 || fann_get_num_output(ann) != 1)
+  {
+    return false;
+  }
+  unsigned int layers[3], biases[3];
+  fann_get_layer_array(ann, layers);
+  fann_get_bias_array(ann, biases);
+  if (layers[0] > maxInputs || biases[0] != 1 || biases[1] != 1)
+  {
+    return false;
+  }
+  const unsigned int inputs = layers[0];
+  const unsigned int hidden = layers[1];
+  // FANN numbers the neurons of all layers consecutively and each layer except the output layer ends with a bias neuron.
+  const unsigned int firstHidden = inputs + 1;
+  const unsigned int output = firstHidden + hidden + 1;
+  for (unsigned int j = 0; j < hidden; j++)
+  {
+    if (fann_get_activation_function(ann, 1, static_cast<int>(j)) != FANN_SIGMOID_SYMMETRIC)
+    {
+      return false;
+    }
+  }
+  if (fann_get_activation_function(ann, 2, 0) != FANN_SIGMOID)
+  {
+    return false;
+  }
+
+  // 1. Collect the raw weights (the bias weights are stored in the extra column / entry).
+  std::vector<double> w1(hidden * (inputs + 1), 0.0), w2(hidden + 1, 0.0);
+  std::vector<fann_connection> connections(fann_get_total_connections(ann));
+  fann_get_connection_array(ann, connections.data());
+  for (const auto& c : connections)
+  {
+    if (c.to_neuron >= firstHidden && c.to_neuron < firstHidden + hidden && c.from_neuron <= inputs)
+    {
+      w1[(c.to_neuron - firstHidden) * (inputs + 1) + c.from_neuron] = c.weight;
+    }
+    else if (c.to_neuron == output && c.from_neuron >= firstHidden && c.from_neuron <= firstHidden + hidden)
+    {
+      w2[c.from_neuron - firstHidden] = c.weight;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  // 2. Fold normalization and steepness into the weights.
+  // A symmetric sigmoid neuron computes tanh(s * sum) and a sigmoid neuron computes 1 / (1 + exp(-2 * s * sum)) = (1 + tanh(s * sum)) / 2.
+  hiddenWeights.assign(hidden * inputs, 0.f);
+  hiddenBiases.assign(hidden, 0.f);
+  outputWeights.assign(hidden, 0.f);
+  for (unsigned int j = 0; j < hidden; j++)
+  {
+    const double steepness = fann_get_activation_steepness(ann, 1, static_cast<int>(j));
+    double bias = w1[j * (inputs + 1) + inputs];
+    for (unsigned int i = 0; i < inputs; i++)
+    {
+      const double w = w1[j * (inputs + 1) + i] / stddevs[i];
+      hiddenWeights[j * inputs + i] = static_cast<float>(steepness * w);
+      bias -= w * means[i];
+    }
+    hiddenBiases[j] = static_cast<float>(steepness * bias);
+  }
+  const double outputSteepness = fann_get_activation_steepness(ann, 2, 0);
+  for (unsigned int j = 0; j < hidden; j++)
+  {
+    outputWeights[j] = static_cast<float>(outputSteepness * w2[j]);
+  }
+  outputBias = static_cast<float>(outputSteepness * w2[hidden]);
+  numInputs = inputs;
+  numHidden = hidden;
+
+  // 3. Compare the outputs with FANN on inputs that are spread around the means.
+  constexpr unsigned int numberOfChecks = 64;
+  std::vector<double> features(numberOfChecks * inputs);
+  std::vector<float> outputs(numberOfChecks);
+  for (unsigned int k = 0; k < numberOfChecks; k++)
+  {
+    for (unsigned int i = 0; i < inputs; i++)
+    {
+      features[k * inputs + i] = means[i] + stddevs[i] * 3.0 * std::sin(static_cast<double>(k * (i + 1)) + i);
+    }
+  }
+  run(features.data(), numberOfChecks, outputs.data());
+  for (unsigned int k = 0; k < numberOfChecks; k++)
+  {
+    fann_type input[maxInputs];
+    for (unsigned int i = 0; i < inputs; i++)
+    {
+      input[i] = static_cast<fann_type>((features[k * inputs + i] - means[i]) / stddevs[i]);
+    }
+    const fann_type expected = *fann_run(ann, input);
+    if (std::abs(outputs[k] - expected) > 1e-3f)
+    {
+      std::cerr << "NeuralNetwork: Output " << outputs[k] << " differs from FANN output " << expected << "!\n";
+      numInputs = 0;
+      numHidden = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NeuralNetwork::isLoaded() const
+{
+  return numInputs > 0;
+}
+
+float NeuralNetwork::run(const double* features) const
+{
+  float output;
+  runGroup(features, 1, &output);
+  return output;
+}
+
+void NeuralNetwork::run(const double* features, const unsigned int count, float* outputs) const
+{
+  for (unsigned int k = 0; k < count; k += groupSize)
+  {
+    runGroup(features + k * numInputs, std::min(groupSize, count - k), outputs + k);
+  }
+}
+
+void NeuralNetwork::runGroup(const double* features, const unsigned int count, float* outputs) const
+{
+  assert(isLoaded() && count > 0 && count <= groupSize);
+  // The inputs are transposed so that each lane holds one frame (missing frames repeat the last one).
+  alignas(16) float inputs[maxInputs * groupSize];
+  for (unsigned int i = 0; i < numInputs; i++)
+  {
+    for (unsigned int k = 0; k < groupSize; k++)
+    {
+      inputs[i * groupSize + k] = static_cast<float>(features[std::min(k, count - 1) * numInputs + i]);
+    }
+  }
+  alignas(16) float result[groupSize];
+#ifdef __SSE2__
+  __m128 sum = _mm_set1_ps(outputBias);
+  for (unsigned int j = 0; j < numHidden; j++)
+  {
+    const float* weights = hiddenWeights.data() + j * numInputs;
+    __m128 activation = _mm_set1_ps(hiddenBiases[j]);
+    for (unsigned int i = 0; i < numInputs; i++)
+    {
+      activation = madd(_mm_set1_ps(weights[i]), _mm_load_ps(inputs + i * groupSize), activation);
+    }
+    sum = madd(_mm_set1_ps(outputWeights[j]), approximateTanh(activation), sum);
+  }
+  const __m128 half = _mm_set1_ps(0.5f);
+  _mm_store_ps(result, madd(half, approximateTanh(sum), half));
+#else
+  for (unsigned int k = 0; k < groupSize; k++)
+  {
+    float sum = outputBias;
+    for (unsigned int j = 0; j < numHidden; j++)
+    {
+      const float* weights = hiddenWeights.data() + j * numInputs;
+      float activation = hiddenBiases[j];
+      for (unsigned int i = 0; i < numInputs; i++)
+      {
+        activation += weights[i] * inputs[i * groupSize + k];
+      }
+      sum += outputWeights[j] * approximateTanh(activation);
+    }
+    result[k] = 0.5f + 0.5f * approximateTanh(sum);
+  }
+#endif
+  std::copy(result, result + count, outputs);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file NeuralNetwork.hpp declares the NeuralNetwork class
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <fann.h>
+
+
+/**
+ * @class NeuralNetwork is a compact inference engine for FANN networks with one hidden layer
+ *
+ * The weights are copied from a FANN network once. The normalization of the inputs and the steepness of the
+ * activation functions are folded into the weights, so that a forward pass only consists of multiply-adds and two
+ * activation functions. Four frames are processed at once in the lanes of SSE registers (if available) and the
+ * activation functions are evaluated by a rational approximation of tanh.
+ */
+class NeuralNetwork final
+{
+public:
+  /**
+   * @brief load copies the weights from a FANN network and checks the outputs against FANN
+   * @param ann the FANN network (must have one hidden layer with symmetric sigmoid and one sigmoid output)
+   * @param means the means of the inputs that are subtracted before the network is run
+   * @param stddevs the standard deviations by which the inputs are divided before the network is run
+   * @return whether the network is supported and yields the same outputs as FANN (otherwise nothing is loaded)
+   */
+  bool load(fann* ann, const double* means, const double* stddevs);
+  /**
+   * @brief isLoaded returns whether a network has been loaded successfully
+   * @return whether a network has been loaded successfully
+   */
+  bool isLoaded() const;
+  /**
+   * @brief run computes the output of the network for a single frame
+   * @param features the unnormalized inputs of the network
+   * @return the output of the network
+   */
+  float run(const double* features) const;
+  /**
+   * @brief run computes the outputs of the network for many frames
+   * @param features the unnormalized inputs of the network (count rows of numInputs values)
+   * @param count the number of frames
+   * @param outputs the buffer to which the outputs are written (count values)
+   */
+  void run(const double* features, unsigned int count, float* outputs) const;
+private:
+  /**
+   * @brief runGroup computes the outputs of the network for up to four frames
+   * @param features the unnormalized inputs of the frames
+   * @param count the number of frames in the group (between 1 and 4)
+   * @param outputs the buffer to which the outputs are written (count values)
+   */
+  void runGroup(const double* features, unsigned int count, float* outputs) const;
+  /// the number of inputs of the network
+  unsigned int numInputs = 0;
+  /// the number of hidden neurons
+  unsigned int numHidden = 0;
+  /// the weights from the inputs to the hidden neurons including normalization and steepness ([hidden][input])
+  std::vector<float> hiddenWeights;
+  /// the biases of the hidden neurons including normalization and steepness
+  std::vector<float> hiddenBiases;
+  /// the weights from the hidden neurons to the output including steepness
+  std::vector<float> outputWeights;
+  /// the bias of the output neuron including steepness
+  float outputBias = 0.f;
+};
@@ -0,0 +1,272 @@
+/**
+ * @file NeuralNetworkTrainer.cpp implements methods of the NeuralNetworkTrainer class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Engine/WorkerPool.hpp"
+
+#include "NeuralNetworkTrainer.hpp"
+
+
+namespace
+{
+  /// the minimum number of examples per shard (smaller shards do not pay off the synchronization)
+  constexpr unsigned int minShardSize = 64;
+  /// the decay rate of the first moment estimate of Adam
+  constexpr float beta1 = 0.9f;
+  /// the decay rate of the second moment estimate of Adam
+  constexpr float beta2 = 0.999f;
+  /// the term that prevents divisions by zero in Adam
+  constexpr float epsilon = 1e-8f;
+}
+
+NeuralNetworkTrainer::NeuralNetworkTrainer(const unsigned int numInputs, const unsigned int numHidden, const float hiddenSteepness,
+                                           const float outputSteepness, const Options& options)
+  : numInputs(numInputs)
+  , numHidden(numHidden)
+  , hiddenSteepness(hiddenSteepness)
+  , outputSteepness(outputSteepness)
+  , options(options)
+  , weights(numHidden * (numInputs + 1) + numHidden + 1)
+  , validationLoss(std::numeric_limits<float>::infinity())
+{
+  // This is the same initialization as fann_randomize_weights(ann, -1, 1).
+  std::mt19937 generator(options.seed);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  for (auto& w : weights)
+  {
+    w = distribution(generator);
+  }
+}
+
+void NeuralNetworkTrainer::train(const std::vector<float>& inputs, const std::vector<float>& targets, const std::vector<unsigned int>& groups,
+                                 const std::function<void()>& checkpoint)
+{
+  assert(inputs.size() == targets.size() * numInputs);
+  assert(groups.size() == targets.size());
+  const unsigned int numExamples = static_cast<unsigned int>(targets.size());
+  if (numExamples == 0)
+  {
+    return;
+  }
+  std::mt19937 generator(options.seed + 1);
+
+  // 1. Split the groups into a training and a validation set. Examples of the same group (e.g. overlapping frames and
+  //    noisy copies of a file) are strongly correlated, so they must not be on both sides.
+  std::vector<unsigned int> groupOrder(groups);
+  std::sort(groupOrder.begin(), groupOrder.end());
+  groupOrder.erase(std::unique(groupOrder.begin(), groupOrder.end()), groupOrder.end());
+  std::shuffle(groupOrder.begin(), groupOrder.end(), generator);
+  std::unordered_map<unsigned int, unsigned int> groupSizes;
+  for (const unsigned int group : groups)
+  {
+    groupSizes[group]++;
+  }
+  const unsigned int targetValidation = static_cast<unsigned int>(options.validationFraction * static_cast<float>(numExamples));
+  std::unordered_set<unsigned int> validationGroups;
+  unsigned int numValidation = 0;
+  // At least one group is kept for training.
+  for (std::size_t i = 0; i + 1 < groupOrder.size() && numValidation < targetValidation; i++)
+  {
+    validationGroups.insert(groupOrder[i]);
+    numValidation += groupSizes[groupOrder[i]];
+  }
+  std::vector<unsigned int> validation, training;
+  validation.reserve(numValidation);
+  training.reserve(numExamples - numValidation);
+  for (unsigned int i = 0; i < numExamples; i++)
+  {
+    (validationGroups.count(groups[i]) ? validation : training).push_back(i);
+  }
+  if (validation.empty())
+  {
+    // Without held out examples the training loss has to serve as stopping criterion.
+    validation = training;
+  }
+
+  // 2. Run epochs of mini-batch Adam until the validation loss stops improving.
+  WorkerPool pool;
+  const unsigned int batchSize = std::max(options.batchSize, 1U);
+  const unsigned int maxShards = std::max(pool.getNumberOfThreads(), 1U);
+  std::vector<std::vector<float>> shardGradients(maxShards, std::vector<float>(weights.size()));
+  std::vector<float> gradient(weights.size()), firstMoment(weights.size(), 0.f), secondMoment(weights.size(), 0.f);
+  std::vector<float> bestWeights = weights;
+  validationLoss = static_cast<float>(evaluateLoss(pool, inputs, targets, validation));
+  float beta1Power = 1.f, beta2Power = 1.f;
+  unsigned int epochsWithoutImprovement = 0, epoch = 0;
+  for (; epoch < options.maxEpochs && epochsWithoutImprovement < options.patience; epoch++)
+  {
+    std::shuffle(training.begin(), training.end(), generator);
+    for (unsigned int begin = 0; begin < training.size(); begin += batchSize)
+    {
+      const unsigned int count = std::min(batchSize, static_cast<unsigned int>(training.size()) - begin);
+      // Each shard accumulates into its own buffer. The buffers are summed in a fixed order afterwards, so the result
+      // does not depend on which thread processed which shard.
+      const unsigned int numShards = std::max(std::min(maxShards, count / minShardSize), 1U);
+      const unsigned int shardSize = (count + numShards - 1) / numShards;
+      pool.run(numShards, [&](const unsigned int shard)
+      {
+        std::vector<float>& g = shardGradients[shard];
+        std::fill(g.begin(), g.end(), 0.f);
+        const unsigned int shardBegin = std::min(shard * shardSize, count);
+        const unsigned int shardEnd = std::min(shardBegin + shardSize, count);
+        accumulate(inputs, targets, training.data() + begin + shardBegin, shardEnd - shardBegin, g.data());
+      });
+      std::fill(gradient.begin(), gradient.end(), 0.f);
+      for (unsigned int shard = 0; shard < numShards; shard++)
+      {
+        for (std::size_t k = 0; k < gradient.size(); k++)
+        {
+          gradient[k] += shardGradients[shard][k];
+        }
+      }
+      beta1Power *= beta1;
+      beta2Power *= beta2;
+      const float stepSize = options.learningRate * std::sqrt(1.f - beta2Power) / (1.f - beta1Power);
+      const float scale = 1.f / static_cast<float>(count);
+      for (std::size_t k = 0; k < weights.size(); k++)
+      {
+        const float g = gradient[k] * scale;
+        firstMoment[k] = beta1 * firstMoment[k] + (1.f - beta1) * g;
+        secondMoment[k] = beta2 * secondMoment[k] + (1.f - beta2) * g * g;
+        weights[k] -= stepSize * firstMoment[k] / (std::sqrt(secondMoment[k]) + epsilon);
+      }
+    }
+    // The best weights are kept as checkpoint, so that overfitting at the end of training does not matter.
+    const float loss = static_cast<float>(evaluateLoss(pool, inputs, targets, validation));
+    if (loss < validationLoss)
+    {
+      validationLoss = loss;
+      bestWeights = weights;
+      epochsWithoutImprovement = 0;
+      if (checkpoint)
+      {
+        checkpoint();
+      }
+    }
+    else
+    {
+      epochsWithoutImprovement++;
+    }
+  }
+  weights = bestWeights;
+  std::cout << "NeuralNetworkTrainer: Stopped after " << epoch << " epochs with a validation loss of " << validationLoss
+            << " (" << training.size() << " training, " << numValidation << " validation examples)!\n";
+}
+
+bool NeuralNetworkTrainer::writeTo(fann* ann) const
+{
+  if (ann == nullptr || fann_get_num_layers(ann) != 3 || fann_get_num_input(ann) != numInputs || fann_get_num_output(ann) != 1
+      || fann_get_total_connections(ann) != weights.size())
+  {
+    return false;
+  }
+  unsigned int layers[3];
+  fann_get_layer_array(ann, layers);
+  if (layers[1] != numHidden)
+  {
+    return false;
+  }
+  // FANN numbers the neurons of all layers consecutively and each layer except the output layer ends with a bias neuron.
+  const unsigned int firstHidden = numInputs + 1;
+  const unsigned int output = firstHidden + numHidden + 1;
+  std::vector<fann_connection> connections(weights.size());
+  fann_get_connection_array(ann, connections.data());
+  for (auto& c : connections)
+  {
+    if (c.to_neuron >= firstHidden && c.to_neuron < firstHidden + numHidden && c.from_neuron <= numInputs)
+    {
+      c.weight = static_cast<fann_type>(weights[(c.to_neuron - firstHidden) * (numInputs + 1) + c.from_neuron]);
+    }
+    else if (c.to_neuron == output && c.from_neuron >= firstHidden && c.from_neuron <= firstHidden + numHidden)
+    {
+      c.weight = static_cast<fann_type>(weights[numHidden * (numInputs + 1) + c.from_neuron - firstHidden]);
+    }
+    else
+    {
+      return false;
+    }
+  }
+  fann_set_weight_array(ann, connections.data(), static_cast<unsigned int>(connections.size()));
+  return true;
+}
+
+float NeuralNetworkTrainer::getValidationLoss() const
+{
+  return validationLoss;
+}
+
+double NeuralNetworkTrainer::accumulate(const std::vector<float>& inputs, const std::vector<float>& targets, const unsigned int* indices,
+                                        const unsigned int count, float* gradient) const
+{
+  const float* outputWeights = weights.data() + numHidden * (numInputs + 1);
+  std::vector<float> hidden(numHidden);
+  double loss = 0.0;
+  for (unsigned int k = 0; k < count; k++)
+  {
+    const float* x = inputs.data() + indices[k] * numInputs;
+    const float target = targets[indices[k]];
+    // 1. Forward pass: a symmetric sigmoid neuron computes tanh(s * sum), the sigmoid output 1 / (1 + exp(-2 * s * sum)).
+    float sum = outputWeights[numHidden];
+    for (unsigned int j = 0; j < numHidden; j++)
+    {
+      const float* w = weights.data() + j * (numInputs + 1);
+      float activation = w[numInputs];
+      for (unsigned int i = 0; i < numInputs; i++)
+      {
+        activation += w[i] * x[i];
+      }
+      hidden[j] = std::tanh(hiddenSteepness * activation);
+      sum += outputWeights[j] * hidden[j];
+    }
+    const float logit = 2.f * outputSteepness * sum;
+    // The cross entropy of a sigmoid is softplus(logit) - target * logit, computed so that it cannot overflow.
+    loss += std::max(logit, 0.f) + std::log1p(std::exp(-std::abs(logit))) - target * logit;
+    if (gradient == nullptr)
+    {
+      continue;
+    }
+    // 2. Backward pass: the derivative of the cross entropy with respect to the logit is output - target.
+    const float output = 1.f / (1.f + std::exp(-logit));
+    const float delta = (output - target) * 2.f * outputSteepness;
+    float* outputGradient = gradient + numHidden * (numInputs + 1);
+    outputGradient[numHidden] += delta;
+    for (unsigned int j = 0; j < numHidden; j++)
+    {
+      outputGradient[j] += delta * hidden[j];
+      const float hiddenDelta = delta * outputWeights[j] * hiddenSteepness * (1.f - hidden[j] * hidden[j]);
+      float* g = gradient + j * (numInputs + 1);
+      for (unsigned int i = 0; i < numInputs; i++)
+      {
+        g[i] += hiddenDelta * x[i];
+      }
+      g[numInputs] += hiddenDelta;
+    }
+  }
+  return loss;
+}
+
+double NeuralNetworkTrainer::evaluateLoss(WorkerPool& pool, const std::vector<float>& inputs, const std::vector<float>& targets,
+                                          const std::vector<unsigned int>& indices) const
+{
+  const unsigned int count = static_cast<unsigned int>(indices.size());
+  const unsigned int numShards = std::max(std::min(pool.getNumberOfThreads(), count / minShardSize), 1U);
+  const unsigned int shardSize = (count + numShards - 1) / numShards;
+  std::vector<double> losses(numShards, 0.0);
+  pool.run(numShards, [&](const unsigned int shard)
+  {
+    const unsigned int shardBegin = std::min(shard * shardSize, count);
+    const unsigned int shardEnd = std::min(shardBegin + shardSize, count);
+    losses[shard] = accumulate(inputs, targets, indices.data() + shardBegin, shardEnd - shardBegin, nullptr);
+  });
+  return std::accumulate(losses.begin(), losses.end(), 0.0) / std::max(count, 1U);
+}
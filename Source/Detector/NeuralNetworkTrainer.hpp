@@ -0,0 +1,111 @@
+/**
+ * @file NeuralNetworkTrainer.hpp declares the NeuralNetworkTrainer class
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <fann.h>
+
+
+class WorkerPool;
+
+/**
+ * @class NeuralNetworkTrainer trains a network with one hidden layer by mini-batch gradient descent
+ *
+ * The network has the structure of a FANN network with a symmetric sigmoid hidden layer and a single sigmoid output,
+ * so that the trained weights can be written to such a network. The gradient of each mini-batch is computed in shards
+ * on all cores. The examples of some groups are held out for validation and training stops when the validation loss
+ * has not improved for some epochs. The weights with the lowest validation loss are kept as result and can be saved as
+ * checkpoint whenever they improve, so that an interrupted training does not lose them.
+ */
+class NeuralNetworkTrainer final
+{
+public:
+  /**
+   * @struct Options contains the hyperparameters of the training
+   */
+  struct Options
+  {
+    /// the number of examples per mini-batch
+    unsigned int batchSize = 256;
+    /// the maximum number of passes over the training examples
+    unsigned int maxEpochs = 1000;
+    /// the number of epochs without improvement of the validation loss after which training stops
+    unsigned int patience = 30;
+    /// the fraction of the examples that is held out for validation
+    float validationFraction = 0.2f;
+    /// the step size of the Adam optimizer
+    float learningRate = 0.01f;
+    /// the seed for shuffling and initialization
+    unsigned int seed = 42;
+  };
+  /**
+   * @brief NeuralNetworkTrainer initializes the weights randomly
+   * @param numInputs the number of inputs
+   * @param numHidden the number of hidden neurons
+   * @param hiddenSteepness the steepness of the symmetric sigmoid of the hidden neurons (as in FANN)
+   * @param outputSteepness the steepness of the sigmoid of the output neuron (as in FANN)
+   * @param options the hyperparameters of the training
+   */
+  NeuralNetworkTrainer(unsigned int numInputs, unsigned int numHidden, float hiddenSteepness, float outputSteepness,
+                       const Options& options);
+  /**
+   * @brief train trains the network (whole groups of examples are held out for validation, so that correlated examples are not on both sides)
+   * @param inputs the normalized inputs of the examples (row-major, numInputs values per example)
+   * @param targets the desired outputs of the examples (between 0 and 1)
+   * @param groups the group of each example (e.g. the file from which it has been extracted)
+   * @param checkpoint is called whenever the validation loss has improved, while the current weights are the best ones (e.g. to save them with writeTo)
+   */
+  void train(const std::vector<float>& inputs, const std::vector<float>& targets, const std::vector<unsigned int>& groups,
+             const std::function<void()>& checkpoint = nullptr);
+  /**
+   * @brief writeTo copies the trained weights to a FANN network with the same structure
+   * @param ann the FANN network
+   * @return whether the structure of the FANN network matches
+   */
+  bool writeTo(fann* ann) const;
+  /**
+   * @brief getValidationLoss returns the lowest validation loss that has been reached
+   * @return the mean cross entropy on the validation set of the trained weights
+   */
+  float getValidationLoss() const;
+private:
+  /**
+   * @brief accumulate computes the loss and adds the gradient for a range of examples
+   * @param inputs the inputs of all examples
+   * @param targets the targets of all examples
+   * @param indices the indices of the examples in the range
+   * @param count the number of examples in the range
+   * @param gradient the gradient to which the gradient of the range is added (nullptr if only the loss is needed)
+   * @return the summed cross entropy of the range
+   */
+  double accumulate(const std::vector<float>& inputs, const std::vector<float>& targets, const unsigned int* indices,
+                    unsigned int count, float* gradient) const;
+  /**
+   * @brief evaluateLoss computes the mean loss on a set of examples in parallel
+   * @param pool the pool on which the loss is computed
+   * @param inputs the inputs of all examples
+   * @param targets the targets of all examples
+   * @param indices the indices of the examples in the set
+   * @return the mean cross entropy
+   */
+  double evaluateLoss(WorkerPool& pool, const std::vector<float>& inputs, const std::vector<float>& targets,
+                      const std::vector<unsigned int>& indices) const;
+  /// the number of inputs
+  const unsigned int numInputs;
+  /// the number of hidden neurons
+  const unsigned int numHidden;
+  /// the steepness of the hidden neurons
+  const float hiddenSteepness;
+  /// the steepness of the output neuron
+  const float outputSteepness;
+  /// the hyperparameters
+  const Options options;
+  /// the weights (for each hidden neuron numInputs weights and a bias, then numHidden output weights and a bias)
+  std::vector<float> weights;
+  /// the lowest validation loss so far
+  float validationLoss;
+};
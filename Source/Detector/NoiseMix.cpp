@@ -0,0 +1,39 @@
+/**
+ * @file NoiseMix.cpp implements methods of the NoiseMix struct
+ */
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "NoiseMix.hpp"
+
+
+void NoiseMix::apply(const float* signal, const std::size_t position, std::size_t count, float* out) const
+{
+  std::size_t noisePosition = (offset + position) % noiseLength;
+  while (count > 0)
+  {
+    // The segment is split where the noise recording wraps around.
+    const std::size_t length = std::min(count, noiseLength - noisePosition);
+    const float* noiseSamples = noise + noisePosition;
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= length; i += 4)
+    {
+      _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(signal + i), _mm_mul_ps(g, _mm_loadu_ps(noiseSamples + i))));
+    }
+#endif
+    for (; i < length; i++)
+    {
+      out[i] = signal[i] + gain * noiseSamples[i];
+    }
+    signal += length;
+    out += length;
+    count -= length;
+    noisePosition = 0;
+  }
+}
@@ -0,0 +1,33 @@
+/**
+ * @file NoiseMix.hpp declares the NoiseMix struct
+ */
+
+#pragma once
+
+#include <cstddef>
+
+
+/**
+ * @struct NoiseMix describes how a noise recording is added to the channels of an evaluated file
+ *
+ * The noise is added while the samples are read, so that the noisy file never has to be stored.
+ */
+struct NoiseMix
+{
+  /**
+   * @brief apply adds the noise to a segment of a channel
+   * @param signal the samples of the segment
+   * @param position the index of the first sample of the segment in the channel
+   * @param count the number of samples in the segment
+   * @param out is filled with the noisy samples (may be the same as signal)
+   */
+  void apply(const float* signal, std::size_t position, std::size_t count, float* out) const;
+  /// the samples of the noise recording (repeated if the channel is longer)
+  const float* noise = nullptr;
+  /// the number of samples of the noise recording
+  std::size_t noiseLength = 0;
+  /// the index of the noise sample that is added to the first sample of the channel
+  std::size_t offset = 0;
+  /// the factor by which the noise is multiplied before it is added
+  float gain = 0.f;
+};
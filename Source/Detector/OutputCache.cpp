@@ -0,0 +1,161 @@
+/**
+ * @file OutputCache.cpp implements methods of the OutputCache class
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "Engine/AudioFile.hpp"
+
+#include "Hasher.hpp"
+#include "OutputCache.hpp"
+
+
+namespace
+{
+  /// the magic bytes at the beginning of a cache file
+  constexpr char magicBytes[8] = { 'W', 'L', 'O', 'U', 'T', 'P', 'T', '\0' };
+  /// the version of the file format
+  constexpr std::uint32_t currentFormatVersion = 1;
+}
+
+std::uint64_t OutputCache::computeKey(const AudioFile& file, const std::string& detector, const std::uint64_t version, const ParameterMap& parameters, const bool withLabels)
+{
+  Hasher hasher;
+  hasher.add(detector);
+  hasher.add(version);
+  for (const auto& parameter : parameters)
+  {
+    hasher.add(parameter.first);
+    hasher.add(parameter.second);
+  }
+  // The path is not part of the key because the output only depends on the samples (and maybe the labels).
+  hasher.add(file.sampleRate);
+  hasher.add(static_cast<std::uint64_t>(file.channels.size()));
+  for (const auto& channel : file.channels)
+  {
+    hasher.add(static_cast<std::uint64_t>(channel.samples.size()));
+    hasher.add(channel.samples.data(), static_cast<std::size_t>(channel.samples.size()) * sizeof(float));
+    if (withLabels)
+    {
+      hasher.add(static_cast<std::uint64_t>(channel.whistleLabels.size()));
+      for (const auto& label : channel.whistleLabels)
+      {
+        hasher.add(label.start);
+        hasher.add(label.end);
+      }
+    }
+  }
+  return hasher.hash;
+}
+
+std::string OutputCache::getFileName(const std::string& directory, const std::string& detector, const std::uint64_t key)
+{
+  std::ostringstream name;
+  name << directory << '/' << detector << '-' << std::hex << std::setw(16) << std::setfill('0') << key << ".output";
+  return name.str();
+}
+
+bool OutputCache::load(const std::string& fileName, const std::uint64_t key, DetectorOutput& output)
+{
+  QFile in(QString::fromStdString(fileName));
+  if (!in.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  const QByteArray header = in.peek(sizeof(Header));
+  std::uint64_t recordSize = 0;
+  return getRecordSize(header.constData(), static_cast<std::uint64_t>(header.size()), recordSize)
+    && recordSize == static_cast<std::uint64_t>(in.size()) && read(in, key, output);
+}
+
+bool OutputCache::save(const std::string& fileName, const std::uint64_t key, const DetectorOutput& output)
+{
+  const QString name = QString::fromStdString(fileName);
+  QDir().mkpath(QFileInfo(name).path());
+  // The file is committed atomically, so that an interrupted write (or a parallel evaluation with the same key) never
+  // leaves a truncated file.
+  QSaveFile out(name);
+  if (!out.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  return write(out, key, output) && out.commit();
+}
+
+bool OutputCache::read(QIODevice& device, const std::uint64_t key, DetectorOutput& output)
+{
+  Header header;
+  std::uint64_t recordSize = 0;
+  if (device.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+      || !getRecordSize(reinterpret_cast<const char*>(&header), sizeof(header), recordSize) || header.key != key)
+  {
+    return false;
+  }
+  output.detections.resize(header.numDetections);
+  output.detectionPositions.resize(header.numDetections);
+  output.executionTimes.resize(header.numExecutionTimes);
+  output.scores.resize(header.numScores);
+  output.channels = header.channels;
+  bool ok = true;
+  const auto readColumn = [&](void* data, const std::size_t bytes)
+  {
+    ok = ok && device.read(static_cast<char*>(data), static_cast<qint64>(bytes)) == static_cast<qint64>(bytes);
+  };
+  readColumn(output.detections.data(), sizeof(unsigned int) * output.detections.size());
+  readColumn(output.detectionPositions.data(), sizeof(unsigned int) * output.detectionPositions.size());
+  readColumn(output.executionTimes.data(), sizeof(float) * output.executionTimes.size());
+  readColumn(output.scores.data(), sizeof(ScoredFrame) * output.scores.size());
+  return ok;
+}
+
+bool OutputCache::write(QIODevice& device, const std::uint64_t key, const DetectorOutput& output)
+{
+  static_assert(sizeof(ScoredFrame) == 2 * sizeof(unsigned int) + sizeof(float), "Scored frames have to be stored without padding!");
+  assert(output.detections.size() == output.detectionPositions.size());
+  Header header;
+  std::memcpy(header.magic, magicBytes, sizeof(magicBytes));
+  header.formatVersion = currentFormatVersion;
+  header.channels = output.channels;
+  header.key = key;
+  header.numDetections = output.detections.size();
+  header.numExecutionTimes = output.executionTimes.size();
+  header.numScores = output.scores.size();
+  bool ok = device.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+  const auto writeColumn = [&](const void* data, const std::size_t bytes)
+  {
+    ok = ok && device.write(static_cast<const char*>(data), static_cast<qint64>(bytes)) == static_cast<qint64>(bytes);
+  };
+  writeColumn(output.detections.data(), sizeof(unsigned int) * output.detections.size());
+  writeColumn(output.detectionPositions.data(), sizeof(unsigned int) * output.detectionPositions.size());
+  writeColumn(output.executionTimes.data(), sizeof(float) * output.executionTimes.size());
+  writeColumn(output.scores.data(), sizeof(ScoredFrame) * output.scores.size());
+  return ok;
+}
+
+bool OutputCache::getRecordSize(const char* data, const std::uint64_t size, std::uint64_t& recordSize)
+{
+  Header header;
+  recordSize = 0;
+  if (size < sizeof(header))
+  {
+    // The beginning of the magic bytes can already be checked.
+    return std::memcmp(data, magicBytes, std::min<std::size_t>(static_cast<std::size_t>(size), sizeof(magicBytes))) == 0;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, magicBytes, sizeof(magicBytes)) != 0 || header.formatVersion != currentFormatVersion)
+  {
+    return false;
+  }
+  recordSize = sizeof(Header) + 2 * sizeof(unsigned int) * header.numDetections + sizeof(float) * header.numExecutionTimes
+    + sizeof(ScoredFrame) * header.numScores;
+  return true;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file OutputCache.hpp declares the OutputCache class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "DetectorOutput.hpp"
+#include "DetectorParameters.hpp"
+
+
+class AudioFile;
+class QIODevice;
+
+/**
+ * @class OutputCache stores the raw output of a detector on single files
+ *
+ * The output of most detectors does not depend on the labels, so it is keyed by the contents of the file, the name and
+ * version of the detector and its parameters. An evaluation only has to run the detector on files that are new or
+ * whose samples have changed and can score all other files from the cache against their current labels. The labels
+ * are only part of the key for detectors that read them. A cache file
+ * contains a single record, records can also be sent through pipes.
+ */
+class OutputCache final
+{
+public:
+  /**
+   * @brief computeKey hashes everything on which the output of a detector on a file depends
+   * @param file the file on which the detector is evaluated
+   * @param detector the name of the detector
+   * @param version the version of the detector
+   * @param parameters the parameters of the detector
+   * @param withLabels whether the labels of the file are part of the key
+   * @return the key of the output
+   */
+  static std::uint64_t computeKey(const AudioFile& file, const std::string& detector, std::uint64_t version, const ParameterMap& parameters, bool withLabels);
+  /**
+   * @brief getFileName returns the name of the file in which the output for a key is cached
+   * @param directory the directory of the cache files
+   * @param detector the name of the detector
+   * @param key the key of the output
+   * @return the name of the cache file
+   */
+  static std::string getFileName(const std::string& directory, const std::string& detector, std::uint64_t key);
+  /**
+   * @brief load reads an output from a cache file
+   * @param fileName the name of the cache file
+   * @param key the key that the file must have
+   * @param output is filled with the cached output
+   * @return whether a valid output with the key has been read
+   */
+  static bool load(const std::string& fileName, std::uint64_t key, DetectorOutput& output);
+  /**
+   * @brief save writes an output to a cache file
+   * @param fileName the name of the cache file
+   * @param key the key of the output
+   * @param output the output
+   * @return whether the output has been written completely
+   */
+  static bool save(const std::string& fileName, std::uint64_t key, const DetectorOutput& output);
+  /**
+   * @brief read reads a record from a device
+   * @param device the device from which the record is read
+   * @param key the key that the record must have
+   * @param output is filled with the output
+   * @return whether a valid record with the key has been read
+   */
+  static bool read(QIODevice& device, std::uint64_t key, DetectorOutput& output);
+  /**
+   * @brief write writes a record to a device
+   * @param device the device to which the record is written
+   * @param key the key of the output
+   * @param output the output
+   * @return whether the record has been written completely
+   */
+  static bool write(QIODevice& device, std::uint64_t key, const DetectorOutput& output);
+  /**
+   * @brief getRecordSize determines the size of a record from its beginning
+   * @param data the first bytes of the record
+   * @param size the number of bytes that are available
+   * @param recordSize is set to the size of the record in bytes (0 if the header is not complete yet)
+   * @return whether the bytes can be the beginning of a record
+   */
+  static bool getRecordSize(const char* data, std::uint64_t size, std::uint64_t& recordSize);
+private:
+  /**
+   * @struct Header is the beginning of a cache file
+   */
+  struct Header
+  {
+    /// identifies the file as output cache
+    char magic[8];
+    /// the version of the file format
+    std::uint32_t formatVersion;
+    /// the number of channels that have been processed together in each buffer
+    std::uint32_t channels;
+    /// the key of the output
+    std::uint64_t key;
+    /// the number of detections
+    std::uint64_t numDetections;
+    /// the number of execution time measurements
+    std::uint64_t numExecutionTimes;
+    /// the number of scores
+    std::uint64_t numScores;
+  };
+};
@@ -0,0 +1,160 @@
+/**
+ * @file SlidingMedian.cpp implements methods of the SlidingMedian class
+ */
+
+#include <cassert>
+
+#include "SlidingMedian.hpp"
+
+
+SlidingMedian::SlidingMedian(const unsigned int capacity)
+{
+  lower.isMaxHeap = true;
+  upper.isMaxHeap = false;
+  reset(capacity);
+}
+
+void SlidingMedian::reset(const unsigned int capacity)
+{
+  values.assign(capacity, 0.f);
+  inUpper.assign(capacity, false);
+  heapPositions.assign(capacity, 0);
+  // Between inserting a value and rebalancing, a heap can hold two values more than half of the window (e.g. k + 2 in
+  // the lower heap for a window of 2k + 1 values), so this much is reserved to make sure that neither of them grows.
+  lower.slots.reserve(capacity / 2 + 2);
+  upper.slots.reserve(capacity / 2 + 2);
+  clear();
+}
+
+void SlidingMedian::clear()
+{
+  lower.slots.clear();
+  upper.slots.clear();
+  oldest = 0;
+  count = 0;
+}
+
+void SlidingMedian::push(const float value)
+{
+  const unsigned int capacity = static_cast<unsigned int>(values.size());
+  assert(capacity > 0);
+  unsigned int slot;
+  if (count == capacity)
+  {
+    slot = oldest;
+    remove(inUpper[slot] ? upper : lower, heapPositions[slot]);
+    oldest = (oldest + 1) % capacity;
+    count--;
+  }
+  else
+  {
+    slot = (oldest + count) % capacity;
+  }
+  values[slot] = value;
+  if (lower.slots.empty() || value <= values[lower.slots[0]])
+  {
+    insert(lower, slot);
+  }
+  else
+  {
+    insert(upper, slot);
+  }
+  count++;
+  // Both the insertion and the removal change the sizes by at most one, so one move restores the balance.
+  if (lower.slots.size() > upper.slots.size() + 1)
+  {
+    insert(upper, remove(lower, 0));
+  }
+  else if (upper.slots.size() > lower.slots.size())
+  {
+    insert(lower, remove(upper, 0));
+  }
+}
+
+unsigned int SlidingMedian::size() const
+{
+  return count;
+}
+
+float SlidingMedian::median() const
+{
+  assert(count > 0);
+  if (count % 2)
+  {
+    return values[lower.slots[0]];
+  }
+  return (values[lower.slots[0]] + values[upper.slots[0]]) * 0.5f;
+}
+
+bool SlidingMedian::before(const Heap& heap, const unsigned int a, const unsigned int b) const
+{
+  return heap.isMaxHeap ? values[a] > values[b] : values[a] < values[b];
+}
+
+void SlidingMedian::place(Heap& heap, const unsigned int position, const unsigned int slot)
+{
+  heap.slots[position] = slot;
+  heapPositions[slot] = position;
+}
+
+void SlidingMedian::siftUp(Heap& heap, unsigned int position)
+{
+  const unsigned int slot = heap.slots[position];
+  while (position > 0)
+  {
+    const unsigned int parent = (position - 1) / 2;
+    if (!before(heap, slot, heap.slots[parent]))
+    {
+      break;
+    }
+    place(heap, position, heap.slots[parent]);
+    position = parent;
+  }
+  place(heap, position, slot);
+}
+
+void SlidingMedian::siftDown(Heap& heap, unsigned int position)
+{
+  const unsigned int slot = heap.slots[position];
+  const unsigned int size = static_cast<unsigned int>(heap.slots.size());
+  while (true)
+  {
+    unsigned int child = 2 * position + 1;
+    if (child >= size)
+    {
+      break;
+    }
+    if (child + 1 < size && before(heap, heap.slots[child + 1], heap.slots[child]))
+    {
+      child++;
+    }
+    if (!before(heap, heap.slots[child], slot))
+    {
+      break;
+    }
+    place(heap, position, heap.slots[child]);
+    position = child;
+  }
+  place(heap, position, slot);
+}
+
+void SlidingMedian::insert(Heap& heap, const unsigned int slot)
+{
+  inUpper[slot] = (&heap == &upper);
+  heap.slots.push_back(slot);
+  siftUp(heap, static_cast<unsigned int>(heap.slots.size() - 1));
+}
+
+unsigned int SlidingMedian::remove(Heap& heap, const unsigned int position)
+{
+  const unsigned int slot = heap.slots[position];
+  const unsigned int last = heap.slots.back();
+  heap.slots.pop_back();
+  if (position < heap.slots.size())
+  {
+    place(heap, position, last);
+    siftUp(heap, position);
+    siftDown(heap, heapPositions[last]);
+  }
+  return slot;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file SlidingMedian.hpp declares the SlidingMedian class
+ */
+
+#pragma once
+
+#include <vector>
+
+
+/**
+ * @class SlidingMedian maintains the median of the last n values of a sequence
+ *
+ * The values are split into a max-heap of the lower half and a min-heap of the upper half. Each heap entry is a slot
+ * of a ring buffer and each slot knows its position in its heap, so that the oldest value can be removed in O(log n)
+ * when a new value is pushed. All storage is allocated when the capacity is set.
+ */
+class SlidingMedian final
+{
+public:
+  /**
+   * @brief SlidingMedian initializes members
+   * @param capacity the number of values over which the median is computed
+   */
+  explicit SlidingMedian(unsigned int capacity = 0);
+  /**
+   * @brief reset removes all values and changes the capacity
+   * @param capacity the number of values over which the median is computed
+   */
+  void reset(unsigned int capacity);
+  /**
+   * @brief clear removes all values
+   */
+  void clear();
+  /**
+   * @brief push adds a value and removes the oldest value if the capacity is reached
+   * @param value the new value
+   */
+  void push(float value);
+  /**
+   * @brief size returns the number of values that are currently contained
+   * @return the number of values
+   */
+  unsigned int size() const;
+  /**
+   * @brief median returns the median of the contained values (the mean of the two middle values for an even size)
+   * @return the median (must not be called when empty)
+   */
+  float median() const;
+private:
+  /**
+   * @struct Heap is a binary heap of ring buffer slots ordered by their values
+   */
+  struct Heap
+  {
+    /// the slots in heap order
+    std::vector<unsigned int> slots;
+    /// whether the largest value is at the top (otherwise the smallest one)
+    bool isMaxHeap;
+  };
+  /**
+   * @brief before returns whether a slot has to be closer to the top of a heap than another one
+   * @param heap the heap to which both slots belong
+   * @param a the first slot
+   * @param b the second slot
+   * @return whether a has to be above b
+   */
+  bool before(const Heap& heap, unsigned int a, unsigned int b) const;
+  /**
+   * @brief place writes a slot to a position of a heap and updates its back reference
+   * @param heap the heap
+   * @param position the position in the heap
+   * @param slot the slot that is written
+   */
+  void place(Heap& heap, unsigned int position, unsigned int slot);
+  /**
+   * @brief siftUp moves a slot towards the top of the heap until the heap property holds
+   * @param heap the heap
+   * @param position the position of the slot in the heap
+   */
+  void siftUp(Heap& heap, unsigned int position);
+  /**
+   * @brief siftDown moves a slot towards the bottom of the heap until the heap property holds
+   * @param heap the heap
+   * @param position the position of the slot in the heap
+   */
+  void siftDown(Heap& heap, unsigned int position);
+  /**
+   * @brief insert adds a slot to a heap
+   * @param heap the heap
+   * @param slot the slot that is added
+   */
+  void insert(Heap& heap, unsigned int slot);
+  /**
+   * @brief remove removes the slot at a position from a heap
+   * @param heap the heap
+   * @param position the position of the slot in the heap
+   * @return the removed slot
+   */
+  unsigned int remove(Heap& heap, unsigned int position);
+  /// the values in a ring buffer
+  std::vector<float> values;
+  /// for each slot, whether it is in the upper heap
+  std::vector<bool> inUpper;
+  /// for each slot, its position in its heap
+  std::vector<unsigned int> heapPositions;
+  /// the lower half of the values (its size is equal to or one more than the size of the upper half)
+  Heap lower;
+  /// the upper half of the values
+  Heap upper;
+  /// the slot of the oldest value
+  unsigned int oldest = 0;
+  /// the number of contained values
+  unsigned int count = 0;
+};
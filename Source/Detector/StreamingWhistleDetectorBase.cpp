@@ -0,0 +1,130 @@
+/**
+ * @file StreamingWhistleDetectorBase.cpp implements methods of the StreamingWhistleDetectorBase class
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "StreamingWhistleDetectorBase.hpp"
+#include "Trace.hpp"
+
+
+namespace
+{
+  /**
+   * @brief offsetPosition adds an offset to a position
+   * @param position the position in samples since the beginning of the stream
+   * @param offset the offset in samples
+   * @return the position plus the offset (positions before the beginning of the stream are clamped to 0 instead of wrapping around)
+   */
+  unsigned int offsetPosition(const unsigned int position, const int offset)
+  {
+    return static_cast<unsigned int>(std::max<std::int64_t>(static_cast<std::int64_t>(position) + offset, 0));
+  }
+}
+
+bool StreamingWhistleDetectorBase::reset(const unsigned int sampleRate)
+{
+  this->sampleRate = sampleRate;
+  ready = setup(sampleRate, windowSize, hopSize) && windowSize > 0 && hopSize > 0;
+  if (!ready)
+  {
+    return false;
+  }
+  ring.assign(2 * windowSize, 0.f);
+  writePos = 0;
+  samplesUntilWindow = windowSize;
+  position = 0;
+  output.detections.clear();
+  output.detectionPositions.clear();
+  output.scores.clear();
+  return true;
+}
+
+const DetectorOutput& StreamingWhistleDetectorBase::process(const float* samples, std::size_t count)
+{
+  output.detections.clear();
+  output.detectionPositions.clear();
+  output.scores.clear();
+  if (!ready)
+  {
+    return output;
+  }
+  // The detectors emit at most one detection and one score per window, so no allocation is needed while the chunk is processed.
+  const std::size_t windows = count >= samplesUntilWindow ? (count - samplesUntilWindow) / hopSize + 1 : 0;
+  output.detections.reserve(windows);
+  output.detectionPositions.reserve(windows);
+  output.scores.reserve(windows);
+  while (count > 0)
+  {
+    // Each sample is written to both halves of the ring, so that the last windowSize samples are always contiguous.
+    const unsigned int length = static_cast<unsigned int>(std::min<std::size_t>({ count, samplesUntilWindow, windowSize - writePos }));
+    std::memcpy(ring.data() + writePos, samples, length * sizeof(float));
+    std::memcpy(ring.data() + windowSize + writePos, samples, length * sizeof(float));
+    writePos = (writePos + length) % windowSize;
+    samplesUntilWindow -= length;
+    position += length;
+    samples += length;
+    count -= length;
+    if (samplesUntilWindow == 0)
+    {
+      processWindow(ring.data() + writePos);
+      samplesUntilWindow = hopSize;
+    }
+  }
+  return output;
+}
+
+void StreamingWhistleDetectorBase::evaluate(EvaluationHandle& eh)
+{
+  TRACE_SCOPE("WhistleDetector::evaluate");
+  if (!reset(eh.getSampleRate()))
+  {
+    return;
+  }
+  // The windows can be read from the file directly, so they do not have to go through the ring.
+  handle = &eh;
+  while (const float* window = eh.readWindow(windowSize, hopSize))
+  {
+    position = eh.getPosition();
+    processWindow(window);
+  }
+  handle = nullptr;
+}
+
+void StreamingWhistleDetectorBase::report(const int offset)
+{
+  if (handle != nullptr)
+  {
+    handle->report(offset);
+    return;
+  }
+  output.detections.push_back(offsetPosition(position, offset));
+  output.detectionPositions.push_back(position);
+}
+
+void StreamingWhistleDetectorBase::score(const float value, const int offset)
+{
+  if (handle != nullptr)
+  {
+    handle->score(value, offset);
+    return;
+  }
+  output.scores.push_back({ offsetPosition(position, offset), position, value });
+}
+
+int StreamingWhistleDetectorBase::insideWhistle(const int offset) const
+{
+  return handle != nullptr ? handle->insideWhistle(offset) : 0;
+}
+
+unsigned int StreamingWhistleDetectorBase::getSampleRate() const
+{
+  return sampleRate;
+}
+
+unsigned int StreamingWhistleDetectorBase::getPosition() const
+{
+  return position;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file StreamingWhistleDetectorBase.hpp declares an interface for whistle detectors that process a stream of samples
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "DetectorOutput.hpp"
+#include "WhistleDetectorBase.hpp"
+
+
+/**
+ * @class StreamingWhistleDetectorBase is an interface for detectors that analyze overlapping windows of a single channel
+ *
+ * Samples can be pushed in chunks of arbitrary size (e.g. from an audio callback). They are buffered internally and
+ * each time a window is complete, the detector analyzes it. The buffer is allocated by reset, so that processing does
+ * not allocate memory. For the offline evaluation, the windows are taken directly from the evaluated file instead.
+ */
+class StreamingWhistleDetectorBase : public WhistleDetectorBase
+{
+public:
+  /**
+   * @brief reset prepares the detector for a new stream
+   * @param sampleRate the sample rate of the stream
+   * @return whether the detector supports the sample rate with its current parameters
+   */
+  bool reset(unsigned int sampleRate);
+  /**
+   * @brief process analyzes all windows that are completed by a chunk of samples
+   * @param samples the samples of the chunk
+   * @param count the number of samples in the chunk
+   * @return the detections and scores that have been emitted for this chunk (positions are in samples since reset)
+   */
+  const DetectorOutput& process(const float* samples, std::size_t count);
+  /**
+   * @brief evaluate feeds the windows of a file to the detector and forwards everything it emits to the handle
+   * @param eh delivers and collects data for the evaluation
+   */
+  void evaluate(EvaluationHandle& eh) final;
+protected:
+  /**
+   * @brief setup prepares the detector for a sample rate (this is the only place where memory may be allocated)
+   * @param sampleRate the sample rate of the stream
+   * @param windowSize is set to the number of samples in a window
+   * @param hopSize is set to the number of samples by which consecutive windows are apart
+   * @return whether the detector supports the sample rate with its current parameters
+   */
+  virtual bool setup(unsigned int sampleRate, unsigned int& windowSize, unsigned int& hopSize) = 0;
+  /**
+   * @brief processWindow analyzes a window
+   * @param window the samples of the window (the last one is at the current position)
+   */
+  virtual void processWindow(const float* window) = 0;
+  /**
+   * @brief report reports a whistle detection
+   * @param offset the offset of the detection to the current position
+   */
+  void report(int offset = 0);
+  /**
+   * @brief score reports the confidence of the detector that there is a whistle (independent of any threshold)
+   * @param value the confidence (in a detector specific unit, larger means more likely a whistle)
+   * @param offset the offset of the scored frame to the current position
+   */
+  void score(float value, int offset = 0);
+  /**
+   * @brief insideWhistle determines whether the current position is inside a labeled whistle (only during evaluation)
+   * @param offset the offset of the query to the current position
+   * @return how far the position is inside a whistle (0 if it is not or if there are no labels)
+   */
+  int insideWhistle(int offset = 0) const;
+  /**
+   * @brief getSampleRate returns the sample rate of the current stream
+   * @return the sample rate that has been passed to reset
+   */
+  unsigned int getSampleRate() const;
+  /**
+   * @brief getPosition returns the current position
+   * @return the number of samples since the beginning of the stream
+   */
+  unsigned int getPosition() const;
+private:
+  /// the sample rate of the current stream
+  unsigned int sampleRate = 0;
+  /// the number of samples in a window
+  unsigned int windowSize = 0;
+  /// the number of samples by which consecutive windows are apart
+  unsigned int hopSize = 0;
+  /// twice the last windowSize samples, so that the window starting at writePos is always contiguous
+  std::vector<float> ring;
+  /// the position in the ring at which the next sample is written (i.e. the oldest sample)
+  unsigned int writePos = 0;
+  /// the number of samples that are missing until the next window is complete
+  unsigned int samplesUntilWindow = 0;
+  /// the number of samples since reset
+  unsigned int position = 0;
+  /// whether reset has been successful
+  bool ready = false;
+  /// the detections and scores of the current chunk
+  DetectorOutput output;
+  /// the handle that is evaluated (nullptr while processing pushed samples)
+  EvaluationHandle* handle = nullptr;
+};
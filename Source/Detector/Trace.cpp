@@ -0,0 +1,222 @@
+/**
+ * @file Trace.cpp implements methods of the Trace class
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "AllocationTracker.hpp"
+#include "Trace.hpp"
+
+
+namespace
+{
+  /**
+   * @struct Event is a recorded zone
+   */
+  struct Event
+  {
+    /// the name of the zone
+    const char* name;
+    /// the time at which the zone has begun in nanoseconds
+    std::uint64_t start;
+    /// the time at which the zone has ended in nanoseconds
+    std::uint64_t end;
+  };
+
+  /**
+   * @struct ThreadBuffer contains the zones that a thread has recorded
+   */
+  struct ThreadBuffer
+  {
+    /// the mutex that protects the buffer (it is only contended while the trace is written)
+    std::mutex mutex;
+    /// the id of the thread in the trace
+    unsigned int id = 0;
+    /// the name of the thread in the trace
+    std::string name;
+    /// the recorded zones
+    std::vector<Event> events;
+  };
+
+  /**
+   * @struct Registry contains the buffers of all threads that have recorded zones
+   */
+  struct Registry
+  {
+    /// the mutex that protects the list of buffers
+    std::mutex mutex;
+    /// the buffers of all threads (they are never removed, so that they outlive their threads)
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    /// the time to which all zones are relative (it is never changed, so that it can be read without the mutex)
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  };
+
+  /// the number of zones for which space is reserved in a new buffer
+  constexpr std::size_t initialEventCapacity = 1 << 16;
+
+  /**
+   * @brief getRegistry returns the registry (it is constructed on first use, since zones can be recorded by static objects)
+   * @return the registry
+   */
+  Registry& getRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  /**
+   * @brief getThreadBuffer returns the buffer of the calling thread and registers it on first use
+   * @return the buffer
+   */
+  ThreadBuffer& getThreadBuffer()
+  {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr)
+    {
+      Registry& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.threads.emplace_back(new ThreadBuffer);
+      buffer = registry.threads.back().get();
+      buffer->id = static_cast<unsigned int>(registry.threads.size());
+      buffer->name = "Thread " + std::to_string(buffer->id);
+      buffer->events.reserve(initialEventCapacity);
+    }
+    return *buffer;
+  }
+
+  /**
+   * @brief writeString writes a string as JSON string
+   * @param stream the stream to which the string is written
+   * @param string the string
+   */
+  void writeString(std::ostream& stream, const char* string)
+  {
+    stream << '"';
+    for (; *string; string++)
+    {
+      if (*string == '"' || *string == '\\')
+      {
+        stream << '\\' << *string;
+      }
+      else if (static_cast<unsigned char>(*string) >= 0x20)
+      {
+        stream << *string;
+      }
+    }
+    stream << '"';
+  }
+}
+
+std::atomic<bool> Trace::recording(false);
+
+Trace::Session::Session(const std::string& fileName)
+  : fileName(fileName)
+{
+  if (fileName.empty())
+  {
+    return;
+  }
+#ifdef WHISTLELAB_TRACING
+  start();
+#else
+  std::cerr << "Tracing has not been compiled in, configure with -DWHISTLELAB_TRACING=ON!\n";
+  this->fileName.clear();
+#endif
+}
+
+Trace::Session::~Session()
+{
+  if (fileName.empty())
+  {
+    return;
+  }
+  if (stop(fileName))
+  {
+    std::cerr << "Wrote trace to " << fileName << ".\n";
+  }
+  else
+  {
+    std::cerr << "Could not write trace to " << fileName << "!\n";
+  }
+}
+
+void Trace::setThreadName(const std::string& name)
+{
+  // Threads are not registered if nothing is recorded, so that their buffers are not allocated.
+  if (!isRecording())
+  {
+    return;
+  }
+  ThreadBuffer& buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.name = name;
+}
+
+void Trace::start()
+{
+  // The registry is constructed here at the latest, so that its origin precedes all zones.
+  getRegistry();
+  recording.store(true, std::memory_order_relaxed);
+}
+
+bool Trace::stop(const std::string& fileName)
+{
+  recording.store(false, std::memory_order_relaxed);
+#ifdef __linux__
+  const long pid = static_cast<long>(getpid());
+#else
+  const long pid = 0;
+#endif
+  std::ofstream stream(fileName);
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":\"whistle\"}}";
+  stream << std::fixed << std::setprecision(3);
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> registryLock(registry.mutex);
+  for (const auto& thread : registry.threads)
+  {
+    // Zones that end while the trace is written wait here, so that no buffer is read while it grows.
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << thread->id << ",\"args\":{\"name\":";
+    writeString(stream, thread->name.c_str());
+    stream << "}}";
+    for (const Event& event : thread->events)
+    {
+      stream << ",\n{\"name\":";
+      writeString(stream, event.name);
+      stream << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << thread->id
+             << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+             << ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0 << '}';
+    }
+    thread->events.clear();
+  }
+  stream << "\n]}\n";
+  return static_cast<bool>(stream);
+}
+
+std::uint64_t Trace::now()
+{
+  const auto elapsed = std::chrono::steady_clock::now() - getRegistry().origin;
+  // 0 marks zones that are not recorded, so the first nanosecond is shifted.
+  return std::max<std::uint64_t>(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), 1);
+}
+
+void Trace::record(const char* name, const std::uint64_t start, const std::uint64_t end)
+{
+  // The buffers grow while zones of detectors are recorded, which must not be counted as allocations of the detectors.
+  const AllocationTracker::Pause pause;
+  ThreadBuffer& buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events.push_back({ name, start, end });
+}
@@ -0,0 +1,142 @@
+/**
+ * @file Trace.hpp declares the Trace class and the trace zone macros
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @class Trace records scoped zones per thread and writes them as Chrome trace that can be opened in Perfetto
+ *
+ * The zones are only compiled in if WHISTLELAB_TRACING is defined (see the CMake option of the same name). Even then,
+ * they are only recorded while a session is running, so that a zone that is not recorded costs a single relaxed load.
+ * A session is started by main if the environment variable WHISTLELAB_TRACE names the trace file. Each thread appends
+ * to its own buffer, which outlives the thread, so that zones of worker threads that have already finished are not lost.
+ */
+class Trace final
+{
+public:
+  /**
+   * @class Zone measures the time from its construction to its destruction
+   */
+  class Zone final
+  {
+  public:
+    /**
+     * @brief Zone begins a zone
+     * @param name the name of the zone (it has to be a string literal, since only the pointer is stored)
+     */
+    explicit Zone(const char* name)
+      : name(name)
+      , start(isRecording() ? now() : 0)
+    {
+    }
+    /**
+     * @brief ~Zone ends the zone
+     */
+    ~Zone()
+    {
+      if (start != 0)
+      {
+        record(name, start, now());
+      }
+    }
+    /**
+     * @brief next ends the zone and begins another one, which is useful for consecutive stages of a function
+     * @param name the name of the next zone (it has to be a string literal, since only the pointer is stored)
+     */
+    void next(const char* name)
+    {
+      const std::uint64_t time = (start != 0 || isRecording()) ? now() : 0;
+      if (start != 0)
+      {
+        record(this->name, start, time);
+      }
+      this->name = name;
+      start = time;
+    }
+  private:
+    /// the name of the zone
+    const char* name;
+    /// the time at which the zone has begun (0 if it is not recorded)
+    std::uint64_t start;
+  };
+
+  /**
+   * @class Session records zones during its lifetime and writes them to a file afterwards
+   */
+  class Session final
+  {
+  public:
+    /**
+     * @brief Session starts recording if a file name is given
+     * @param fileName the name of the trace file (empty if nothing should be recorded)
+     */
+    explicit Session(const std::string& fileName);
+    /**
+     * @brief ~Session stops recording and writes the trace file
+     */
+    ~Session();
+  private:
+    /// the name of the trace file
+    std::string fileName;
+  };
+
+  /**
+   * @brief setThreadName sets the name of the calling thread in the trace (only while a session is running)
+   * @param name the name of the thread
+   */
+  static void setThreadName(const std::string& name);
+  /**
+   * @brief isRecording returns whether zones are recorded
+   * @return whether a session is running
+   */
+  static bool isRecording()
+  {
+    return recording.load(std::memory_order_relaxed);
+  }
+private:
+  /**
+   * @brief start starts recording
+   */
+  static void start();
+  /**
+   * @brief stop stops recording, writes all recorded zones to a file and discards them
+   * @param fileName the name of the trace file
+   * @return whether the file could be written
+   */
+  static bool stop(const std::string& fileName);
+  /**
+   * @brief now returns the current time
+   * @return the time in nanoseconds since the first use of the trace (at least 1)
+   */
+  static std::uint64_t now();
+  /**
+   * @brief record appends a zone to the buffer of the calling thread
+   * @param name the name of the zone
+   * @param start the time at which the zone has begun
+   * @param end the time at which the zone has ended
+   */
+  static void record(const char* name, std::uint64_t start, std::uint64_t end);
+  /// whether zones are recorded
+  static std::atomic<bool> recording;
+};
+
+#ifdef WHISTLELAB_TRACING
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_(a, b)
+/// records a zone until the end of the enclosing scope
+#define TRACE_SCOPE(name) const Trace::Zone TRACE_CONCATENATE(traceZone, __LINE__)(name)
+/// begins the first of consecutive stages that end at the next stage or at the end of the enclosing scope
+#define TRACE_STAGE(stage, name) Trace::Zone stage(name)
+/// ends the current stage and begins the next one
+#define TRACE_NEXT_STAGE(stage, name) stage.next(name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_STAGE(stage, name) static_cast<void>(0)
+#define TRACE_NEXT_STAGE(stage, name) static_cast<void>(0)
+#endif
@@ -9,54 +9,111 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iostream>
+
+#include "FFTWPlannerLock.hpp"
+#include "Trace.hpp"
 
 #include "UNSWDetector.hpp"
 
 
 UNSWDetector::UNSWDetector()
+  : window(windowSize)
+  , spectrum(windowSize / 2 + 1)
+{
+  FFTWPlannerLock lock;
+  fftPlan = fftwf_plan_dft_r2c_1d(windowSize, window.data(), reinterpret_cast<fftwf_complex*>(spectrum.data()), FFTW_ESTIMATE);
+}
+
+UNSWDetector::~UNSWDetector()
 {
+  FFTWPlannerLock lock;
+  fftwf_destroy_plan(fftPlan);
 }
 
-void UNSWDetector::evaluate(EvaluationHandle& eh)
+bool UNSWDetector::setup(const unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize)
 {
-  state.setSampleRate(eh.getSampleRate());
+  state.setSampleRate(sampleRate, parameters);
+  if (parameters.numBuckets == 0 || state.spectrumWhistleBegin >= state.spectrumWhistleEnd
+      || state.spectrumWhistleEnd > windowSize / 2 + 1)
+  {
+    std::cerr << "UNSWDetector: The whistle band is empty or exceeds the Nyquist frequency!\n";
+    return false;
+  }
   state.reset();
   state.currentCounter = 0;
   state.counterWhenWhistleStarted = 0;
-  state.statsMemory.clear();
-  window.resize(windowSize);
-  spectrum.resize(windowSize / 2 + 1);
-  fftPlan = fftwf_plan_dft_r2c_1d(windowSize, window.data(), reinterpret_cast<fftwf_complex*>(spectrum.data()), FFTW_ESTIMATE);
-  while (eh.readSingleChannel(window.data(), windowSize) == windowSize)
+  state.meanMedian.clear();
+  state.stDevMedian.clear();
+  streamWindowSize = windowSize;
+  streamHopSize = windowSize;
+  return true;
+}
+
+void UNSWDetector::processWindow(const float* samples)
+{
+  TRACE_SCOPE("UNSWDetector::processWindow");
+  TRACE_STAGE(stage, "UNSWDetector: FFT");
+  // The plan works on its own aligned buffer, so the samples have to be copied.
+  std::copy(samples, samples + windowSize, window.begin());
+  fftwf_execute(fftPlan);
+  TRACE_NEXT_STAGE(stage, "UNSWDetector: Interrogation");
+  state.interrogate(spectrum, parameters);
+  score(state.score, -static_cast<int>(windowSize) / 2);
+  if (state.whistleDone)
   {
-    fftwf_execute(fftPlan);
-    state.interrogate(spectrum);
-    if (state.whistleDone)
-    {
-      eh.report(-static_cast<int>((state.currentCounter - state.counterWhenWhistleStarted - 2) * windowSize));
-    }
+    report(-static_cast<int>((state.currentCounter - state.counterWhenWhistleStarted - 2) * windowSize));
   }
-  fftwf_destroy_plan(fftPlan);
+}
+
+DetectorParameters& UNSWDetector::getParameters()
+{
+  return parameters;
+}
+
+std::uint64_t UNSWDetector::getVersion() const
+{
+  return outputVersion;
+}
+
+void UNSWDetector::Parameters::visit(ParameterVisitor& visitor)
+{
+  visitor.visit("fWhistleBegin", fWhistleBegin);
+  visitor.visit("fWhistleEnd", fWhistleEnd);
+  visitor.visit("backgroundThreshold", backgroundThreshold);
+  visitor.visit("spectrumThreshold", spectrumThreshold);
+  visitor.visit("temporalMediansThreshold", temporalMediansThreshold);
+  visitor.visit("whistleOkayTime", whistleOkayTime);
+  visitor.visit("whistleMissTime", whistleMissTime);
+  visitor.visit("numBuckets", numBuckets);
+  visitor.visit("use2016Version", use2016Version);
 }
 
 UNSWDetector::WhistleState::WhistleState()
+  : score(0.f)
 {
   reset();
 }
 
-void UNSWDetector::WhistleState::setSampleRate(const unsigned int sampleRate)
+void UNSWDetector::WhistleState::setSampleRate(const unsigned int sampleRate, const Parameters& parameters)
 {
-  spectrumWhistleBegin = fWhistleBegin * windowSize / sampleRate;
-  spectrumWhistleEnd = fWhistleEnd * windowSize / sampleRate;
+  spectrumWhistleBegin = parameters.fWhistleBegin * windowSize / sampleRate;
+  spectrumWhistleEnd = parameters.fWhistleEnd * windowSize / sampleRate;
   statsRemember = (sampleRate + windowSize / 2) / windowSize;
-  nWhistleOkaySpectra = static_cast<unsigned int>(whistleOkayTime * static_cast<float>(sampleRate) / static_cast<float>(windowSize) + 0.5f);
-  nWhistleMissSpectra = static_cast<unsigned int>(whistleMissTime * static_cast<float>(sampleRate) / static_cast<float>(windowSize) + 0.5f);
+  meanMedian.reset(statsRemember);
+  stDevMedian.reset(statsRemember);
+  amplitudes.resize(windowSize / 2 + 1);
+  nWhistleOkaySpectra = static_cast<unsigned int>(parameters.whistleOkayTime * static_cast<float>(sampleRate) / static_cast<float>(windowSize) + 0.5f);
+  nWhistleMissSpectra = static_cast<unsigned int>(parameters.whistleMissTime * static_cast<float>(sampleRate) / static_cast<float>(windowSize) + 0.5f);
 }
 
-void UNSWDetector::WhistleState::interrogate(const std::vector<std::complex<float>>& complexSpectrum)
+void UNSWDetector::WhistleState::interrogate(const std::vector<std::complex<float>>& complexSpectrum, const Parameters& parameters)
 {
+  // Spectra that are not checked for a whistle (e.g. while the temporal statistics are collected) get the lowest score.
+  score = 0.f;
   // Find mean and standard deviation of the absolute values of the spectrum.
-  std::vector<float> spectrum(complexSpectrum.size());
+  std::vector<float>& spectrum = amplitudes;
+  assert(spectrum.size() == complexSpectrum.size());
   float spectrumMean = 0.f;
   for (unsigned int i = 0; i < spectrum.size(); i++)
   {
@@ -72,44 +129,33 @@ void UNSWDetector::WhistleState::interrogate(const std::vector<std::complex<floa
   spectrumStDev = std::sqrt(spectrumStDev / static_cast<float>(spectrum.size()));
   // Find the threshold which must be surpassed by the sum of the amplitudes in the whistle band.
   float whistleThreshold;
-  if (use2016Version)
+  if (parameters.use2016Version)
   {
-    whistleThreshold = spectrumMean + spectrumThreshold * spectrumStDev;
+    whistleThreshold = spectrumMean + parameters.spectrumThreshold * spectrumStDev;
   }
   else
   {
     // Add current measurements to history (needed for 2015 detector).
-    statsMemory.push_back({ spectrumMean, spectrumStDev });
-    if (statsMemory.size() > statsRemember)
-    {
-      statsMemory.pop_front();
-    }
-    else
+    // The 2015 detector only starts when the history has been completely filled once.
+    const bool historyFull = meanMedian.size() == statsRemember;
+    meanMedian.push(spectrumMean);
+    stDevMedian.push(spectrumStDev);
+    if (!historyFull)
     {
       return;
     }
     // Find median of means and standard deviations of history.
-    std::vector<float> means(statsRemember), devs(statsRemember);
-    for (unsigned int i = 0; i < statsRemember; i++)
-    {
-      means[i] = statsMemory[i].mean;
-      devs[i] = statsMemory[i].stDev;
-    }
-    std::sort(means.begin(), means.end());
-    std::sort(devs.begin(), devs.end());
-    const float lastSecondMean = (statsRemember % 2) ? means[statsRemember / 2] : (
-      (means[statsRemember / 2 - 1] + means[statsRemember / 2]) * 0.5f);
-    const float lastSecondStDev = (statsRemember % 2) ? devs[statsRemember / 2] : (
-      (devs[statsRemember / 2 - 1] + devs[statsRemember / 2]) * 0.5f);
-    whistleThreshold = std::max(spectrumMean + spectrumThreshold * spectrumStDev,
-    lastSecondMean + temporalMediansThreshold * lastSecondStDev);
+    const float lastSecondMean = meanMedian.median();
+    const float lastSecondStDev = stDevMedian.median();
+    whistleThreshold = std::max(spectrumMean + parameters.spectrumThreshold * spectrumStDev,
+    lastSecondMean + parameters.temporalMediansThreshold * lastSecondStDev);
   }
   // Grow background zones which are discarded from the whistle band.
   unsigned int begin = spectrumWhistleBegin;
   unsigned int end = spectrumWhistleEnd;
-  const float backgroundGrowthThreshold = spectrumMean + backgroundThreshold * spectrumStDev;
-  unsigned int growSize = (end - begin) / numBuckets;
-  for (unsigned int i = 0; i < numBuckets; i++)
+  const float backgroundGrowthThreshold = spectrumMean + parameters.backgroundThreshold * spectrumStDev;
+  unsigned int growSize = (end - begin) / parameters.numBuckets;
+  for (unsigned int i = 0; i < parameters.numBuckets; i++)
   {
     float bucketMean = 0.f;
     assert(begin + growSize <= spectrum.size());
@@ -127,7 +173,7 @@ void UNSWDetector::WhistleState::interrogate(const std::vector<std::complex<floa
       break;
     }
   }
-  for (unsigned int i = 0; i < numBuckets; i++)
+  for (unsigned int i = 0; i < parameters.numBuckets; i++)
   {
     float bucketMean = 0.f;
     assert(end >= growSize);
@@ -156,6 +202,10 @@ void UNSWDetector::WhistleState::interrogate(const std::vector<std::complex<floa
     }
     filteredMean /= static_cast<float>(end - begin);
     found = filteredMean > whistleThreshold;
+    if (whistleThreshold > 0.f)
+    {
+      score = filteredMean / whistleThreshold;
+    }
   }
   // Integrate this whistle measurement into the history and decide whether an action should be taken.
   if (whistleDone)
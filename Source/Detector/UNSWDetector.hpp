@@ -5,44 +5,85 @@
 #pragma once
 
 #include <complex>
-#include <deque>
 
 #include <fftw3.h>
 
+#include "SlidingMedian.hpp"
 #include "WhistleDetector.hpp"
 
 
 /**
  * @class UNSWDetector is the whistle detector of the SPL team UNSW Sydney/Australia
  */
-class UNSWDetector : public WhistleDetector<UNSWDetector>
+class UNSWDetector : public WhistleDetector<UNSWDetector, StreamingWhistleDetectorBase>
 {
 public:
   /**
-   * @brief UNSWDetector initializes members
+   * @brief UNSWDetector initializes members and creates the FFTW plan
    */
   UNSWDetector();
   /**
-   * @brief evaluate evaluates the UNSWDetector on a given file
-   * @param eh delivers and collects data for the evaluation
+   * @brief ~UNSWDetector destroys the FFTW plan
    */
-  void evaluate(EvaluationHandle& eh) override;
+  ~UNSWDetector();
+  /**
+   * @brief getParameters returns the runtime parameters of the UNSWDetector
+   * @return a reference to the parameters
+   */
+  DetectorParameters& getParameters() override;
+  /**
+   * @brief getVersion returns the version of the output of the UNSWDetector
+   * @return the version of the UNSWDetector
+   */
+  std::uint64_t getVersion() const override;
 private:
   /**
-   * @struct WhistleState contains the current state of the whistle detection
+   * @brief setup computes the whistle band for a sample rate and resets the state
+   * @param sampleRate the sample rate of the stream
+   * @param streamWindowSize is set to the window size
+   * @param streamHopSize is set to the window size
+   * @return whether the whistle band is valid
    */
-  struct WhistleState
+  bool setup(unsigned int sampleRate, unsigned int& streamWindowSize, unsigned int& streamHopSize) override;
+  /**
+   * @brief processWindow integrates the spectrum of a window into the state
+   * @param samples the samples of the window
+   */
+  void processWindow(const float* samples) override;
+  /**
+   * @struct Parameters contains the runtime parameters of the UNSWDetector
+   */
+  struct Parameters final : public DetectorParameters
   {
     /**
-     * @struct MeanAndStDev stores a mean and estimated standard deviation
+     * @brief visit applies a visitor to all parameters
+     * @param visitor the visitor that is applied to each parameter
      */
-    struct MeanAndStDev
-    {
-      /// the mean
-      float mean;
-      /// the standard deviation
-      float stDev;
-    };
+    void visit(ParameterVisitor& visitor) override;
+    /// the lowest whistle band frequency
+    unsigned int fWhistleBegin = 2000;
+    /// the highest whistle band frequency
+    unsigned int fWhistleEnd = 4000;
+    /// factor of the standard deviation for determining the background growth threshold
+    float backgroundThreshold = 0.7f;
+    /// factor of the standard deviation for determining the whistle threshold
+    float spectrumThreshold = 2.5f;
+    /// factor of the standard deviation for determining the whistle threshold in the 2015 version
+    float temporalMediansThreshold = 5.0f;
+    /// the duration for which the spectra have to be accepted to report a whistle [seconds]
+    float whistleOkayTime = 0.25f;
+    /// the duration for which the spectra may not be accepted before clearing the accepted spectra counter [seconds]
+    float whistleMissTime = 0.083f;
+    /// the number of buckets for the background zone growing
+    unsigned int numBuckets = 10;
+    /// decides whether the 2015 or 2016 version should be used
+    bool use2016Version = false;
+  };
+  /**
+   * @struct WhistleState contains the current state of the whistle detection
+   */
+  struct WhistleState
+  {
     /**
      * @brief WhistleState initializes members
      */
@@ -50,13 +91,15 @@ private:
     /**
      * @brief setSampleRate updates parameters that depend on the sample rate
      * @param sampleRate the new sample rate
+     * @param parameters the runtime parameters of the detector
      */
-    void setSampleRate(const unsigned int sampleRate);
+    void setSampleRate(const unsigned int sampleRate, const Parameters& parameters);
     /**
      * @brief interrogate checks for the whistle in one spectrum and integrates it into the state
      * @param complexSpectrum the spectrum of the signal that is currently processed
+     * @param parameters the runtime parameters of the detector
      */
-    void interrogate(const std::vector<std::complex<float>>& complexSpectrum);
+    void interrogate(const std::vector<std::complex<float>>& complexSpectrum, const Parameters& parameters);
     /**
      * @brief reset resets the state
      */
@@ -67,12 +110,18 @@ private:
     unsigned int whistleMissCounter;
     /// whether the whistle is finally accepted
     bool whistleDone;
+    /// the ratio of the mean of the filtered whistle band to the whistle threshold in the last spectrum
+    float score;
     /// the counter value when the current whistle started
     unsigned int counterWhenWhistleStarted;
     /// a counter value that serves as timestamp
     unsigned int currentCounter;
-    /// queue of means and standard deviations of spectra over a few frames
-    std::deque<MeanAndStDev> statsMemory;
+    /// the median of the means of the last spectra (needed for the 2015 detector)
+    SlidingMedian meanMedian;
+    /// the median of the standard deviations of the last spectra (needed for the 2015 detector)
+    SlidingMedian stDevMedian;
+    /// the absolute values of the spectrum that is currently processed
+    std::vector<float> amplitudes;
     /// the number of statistics to keep
     unsigned int statsRemember;
     /// the index in the spectrum at which the whistle band begins
@@ -84,26 +133,12 @@ private:
     /// the number of spectra that may not be accepted before clearing the accepted spectra counter
     unsigned int nWhistleMissSpectra;
   };
-  /// the lowest whistle band frequency
-  static constexpr unsigned int fWhistleBegin = 2000;
-  /// the highest whistle band frequency
-  static constexpr unsigned int fWhistleEnd = 4000;
-  /// factor of the standard deviation for determining the background growth threshold
-  static constexpr float backgroundThreshold = 0.7f;
-  /// factor of the standard deviation for determining the whistle threshold
-  static constexpr float spectrumThreshold = 2.5f;
-  /// factor of the standard deviation for determining the whistle threshold in the 2015 version
-  static constexpr float temporalMediansThreshold = 5.0f;
-  /// the duration for which the spectra have to be accepted to report a whistle [seconds]
-  static constexpr float whistleOkayTime = 0.25f;
-  /// the duration for which the spectra may not be accepted before clearing the accepted spectra counter [seconds]
-  static constexpr float whistleMissTime = 0.083f;
-  /// the number of buckets for the background zone growing
-  static constexpr unsigned int numBuckets = 10;
   /// the window size of the DFT
   static constexpr unsigned int windowSize = 1024;
-  /// decides whether the 2015 or 2016 version should be used
-  static constexpr bool use2016Version = false;
+  /// the version of the output (has to be increased whenever the output changes, so that cached outputs are invalidated)
+  static constexpr unsigned int outputVersion = 1;
+  /// the runtime parameters
+  Parameters parameters;
   /// the current state of the whistle detection
   WhistleState state;
   /// the samples of the audio signal that are currently processed
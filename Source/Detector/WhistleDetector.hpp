@@ -4,15 +4,16 @@
 
 #pragma once
 
+#include "StreamingWhistleDetectorBase.hpp"
 #include "WhistleDetectorBase.hpp"
 #include "WhistleDetectorFactory.hpp"
 
 
 /**
- * @class WhistleDetector adds a factory to the WhistleDetectorBase via CRTP
+ * @class WhistleDetector adds a factory to the WhistleDetectorBase (or an interface derived from it) via CRTP
  */
-template<typename Derived>
-class WhistleDetector : public WhistleDetectorBase
+template<typename Derived, typename Base = WhistleDetectorBase>
+class WhistleDetector : public Base
 {
 public:
   /**
@@ -27,5 +28,5 @@ private:
   static WhistleDetectorFactory<Derived> factory;
 };
 
-template<typename Derived>
-WhistleDetectorFactory<Derived> WhistleDetector<Derived>::factory;
+template<typename Derived, typename Base>
+WhistleDetectorFactory<Derived> WhistleDetector<Derived, Base>::factory;
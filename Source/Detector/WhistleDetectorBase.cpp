@@ -2,123 +2,86 @@
  * @file WhistleDetectorBase.cpp implements methods shared among detectors
  */
 
-#include <cassert>
 #include <iostream>
 
+#include <typeinfo>
+#include <utility>
+
+#include "EvaluationScorer.hpp"
+#include "OutputCache.hpp"
+#include "Trace.hpp"
 #include "WhistleDetectorBase.hpp"
+#include "WhistleDetectorFactoryBase.hpp"
 
 
-void WhistleDetectorBase::evaluateOnDatabase(const SampleDatabase& db, EvaluationResults* results)
+void WhistleDetectorBase::evaluateOnDatabase(const SampleDatabase& db, EvaluationResults* results, const bool verbose)
 {
-  std::cout << "\n\nStart evaluation!\n\n";
-  if (results != nullptr)
+  if (verbose)
   {
-    results->maximumDelay = 0.f;
-    results->minimumDelay = std::numeric_limits<float>::max();
-    results->averageDelay = 0.f;
-    results->maximumExecutionTimePerTime = 0.f;
-    results->minimumExecutionTimePerTime = std::numeric_limits<float>::max();
-    results->averageExecutionTimePerTime = 0.f;
+    std::cout << "\n\nStart evaluation!\n\n";
   }
-  unsigned long numOfExecutions = 0;
-  for (const auto& file : db.audioFiles)
+  if (results == nullptr)
   {
-    EvaluationHandle eh(file);
-    evaluate(eh);
-    if (results == nullptr)
-    {
-      continue;
-    }
-    for (auto execTime : eh.executionTimes)
-    {
-      if (execTime > results->maximumExecutionTimePerTime)
-      {
-        results->maximumExecutionTimePerTime = execTime;
-      }
-      if (execTime < results->minimumExecutionTimePerTime)
-      {
-        results->minimumExecutionTimePerTime = execTime;
-      }
-      results->averageExecutionTimePerTime += execTime;
-    }
-    numOfExecutions += eh.executionTimes.size();
-    assert(eh.detections.size() == eh.detectionPositions.size());
-    std::vector<unsigned int> labelHits(file.channels[0].whistleLabels.size(), 0);
-    std::vector<float> labelDelays(file.channels[0].whistleLabels.size(), std::numeric_limits<float>::max());
-    unsigned int lastFP = 0;
-    for (unsigned int j = 0; j < eh.detections.size(); j++)
+    for (const auto& file : db.audioFiles)
     {
-      const unsigned int pos = eh.detections[j];
-      bool hit = false;
-      for (int i = 0; i < file.channels[0].whistleLabels.size(); i++)
-      {
-        auto& wl = file.channels[0].whistleLabels[i];
-        if (static_cast<unsigned int>(wl.start) < pos && pos < static_cast<unsigned int>(wl.end))
-        {
-          labelHits[i]++;
-          // The detection cannot be made when the detector hasn't even read any of the data containing the whistle.
-          assert(eh.detectionPositions[j] >= wl.start);
-          labelDelays[i] = std::min(labelDelays[i], static_cast<float>(eh.detectionPositions[j] - wl.start) / static_cast<float>(file.sampleRate));
-          hit = true;
-          break;
-        }
-      }
-      if (!hit && file.channels[0].completelyLabeled)
-      {
-        // Only one false positive per second is counted as otherwise it would be unfair to detectors with small window sizes.
-        if (lastFP == 0 || pos > lastFP + file.sampleRate)
-        {
-          results->falsePositives++;
-          std::cout << "Whistle in " << file.path.toStdString() << " at " << pos << " (i.e. "
-                    << (static_cast<float>(pos) / static_cast<float>(file.sampleRate)) << ") is a false positive!\n";
-          lastFP = std::max(1U, pos);
-        }
-      }
+      EvaluationHandle eh(file);
+      evaluate(eh);
     }
-    for (int i = 0; i < file.channels[0].whistleLabels.size(); i++)
-    {
-      if (labelHits[i])
-      {
-        results->truePositives++;
-        if (labelDelays[i] > results->maximumDelay)
-        {
-          results->maximumDelay = labelDelays[i];
-        }
-        if (labelDelays[i] < results->minimumDelay)
-        {
-          results->minimumDelay = labelDelays[i];
-        }
-        results->averageDelay += labelDelays[i];
-      }
-      std::cout << "Whistle in " << file.path.toStdString() << " at " << file.channels[0].whistleLabels[i].start
-                << " (i.e. "
-                << (static_cast<float>(file.channels[0].whistleLabels[i].start) / static_cast<float>(file.sampleRate))
-                << ") has been " << (labelHits[i] ? "hit" : "missed") << "!\n";
-    }
-    results->positives += file.channels[0].whistleLabels.size();
+    return;
   }
-  if (results != nullptr)
+  // The outputs of most detectors do not depend on the labels, so only files whose samples are not in the cache have
+  // to be evaluated and everything is scored against the current labels.
+  unsigned int cachedFiles = 0;
+  EvaluationScorer scorer(*results, verbose);
+  for (const auto& file : db.audioFiles)
   {
-    if (results->truePositives != 0)
+    DetectorOutput output;
+    if (evaluateWithCache(file, output))
     {
-      results->averageDelay /= static_cast<float>(results->truePositives);
+      cachedFiles++;
     }
-    if (numOfExecutions)
+    scorer.add(file, output);
+  }
+  if (verbose)
+  {
+    std::cout << "Took the outputs on " << cachedFiles << " of " << db.audioFiles.size()
+              << " files from the cache (their execution times are not measured).\n";
+  }
+  scorer.finish();
+}
+
+bool WhistleDetectorBase::evaluateWithCache(const AudioFile& file, DetectorOutput& output)
+{
+  const std::string name = WhistleDetectorFactoryBase::getName(typeid(*this));
+  const std::uint64_t key = OutputCache::computeKey(file, name, getVersion(), getParameters().get(), dependsOnLabels());
+  const std::string cacheFileName = OutputCache::getFileName("../OutputCaches", name, key);
+  {
+    TRACE_SCOPE("OutputCache::load");
+    if (OutputCache::load(cacheFileName, key, output))
     {
-      results->averageExecutionTimePerTime /= static_cast<float>(numOfExecutions);
+      // The execution times have been measured by the build and on the machine that filled the cache, so a cached
+      // output is untimed.
+      output.executionTimes.clear();
+      return true;
     }
-    std::cout << "False Detections: " << results->falsePositives << '\n';
-    std::cout << "True Detections: " << results->truePositives << '/' << results->positives << '\n';
-    std::cout << "Minimum Delay: " << results->minimumDelay << "s\n";
-    std::cout << "Average Delay: " << results->averageDelay << "s\n";
-    std::cout << "Maximum Delay: " << results->maximumDelay << "s\n";
-    std::cout << "Minimum execution time ratio: " << results->minimumExecutionTimePerTime << '\n';
-    std::cout << "Average execution time ratio: " << results->averageExecutionTimePerTime << '\n';
-    std::cout << "Maximum execution time ratio: " << results->maximumExecutionTimePerTime << '\n';
   }
+  EvaluationHandle eh(file);
+  evaluate(eh);
+  TRACE_SCOPE("OutputCache::save");
+  if (!OutputCache::save(cacheFileName, key, eh.output))
+  {
+    std::cerr << "Could not save the output of " << name << " on " << file.path.toStdString() << " to the cache!\n";
+  }
+  output = std::move(eh.output);
+  return false;
+}
+
+bool WhistleDetectorBase::dependsOnLabels() const
+{
+  return false;
 }
 
-void WhistleDetectorBase::trainOnDatabase(const SampleDatabase&)
+void WhistleDetectorBase::trainOnDatabase(const SampleDatabase&, const NoiseAugmentation*)
 {
   std::cerr << "The derived detector doesn't seem to support training!\n";
 }
@@ -4,14 +4,18 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "Engine/EvaluationResults.hpp"
 #include "Engine/SampleDatabase.hpp"
 
+#include "DetectorParameters.hpp"
 #include "EvaluationHandle.hpp"
 
 
+class NoiseAugmentation;
+
 /**
  * @class WhistleDetectorBase is an interface for single channel whistle detectors
  */
@@ -27,15 +31,44 @@ public:
    * @param eh delivers and collects data for the evaluation
    */
   virtual void evaluate(EvaluationHandle& eh) = 0;
+  /**
+   * @brief getParameters returns the runtime parameters of the detector
+   * @return a reference to the parameters of the detector
+   */
+  virtual DetectorParameters& getParameters() = 0;
+  /**
+   * @brief getVersion returns a version of the detector under which its outputs are cached
+   *
+   * The version has to change whenever the output of the detector on the same samples with the same parameters
+   * changes (e.g. after a change of the algorithm or of a trained model), so that no stale outputs are scored.
+   * @return the version of the detector
+   */
+  virtual std::uint64_t getVersion() const = 0;
+  /**
+   * @brief dependsOnLabels returns whether the output of the detector depends on the labels of the evaluated file
+   *
+   * This is the case for detectors that query EvaluationHandle::insideWhistle, their outputs are cached per labeling.
+   * @return whether the output depends on the labels
+   */
+  virtual bool dependsOnLabels() const;
   /**
    * @brief trainOnDatabase trains a detector on a given database
    * @param db the database on which the detector is trained
+   * @param augmentation the noise that is added to additional copies of the files (nullptr if only the files are used)
    */
-  virtual void trainOnDatabase(const SampleDatabase& db);
+  virtual void trainOnDatabase(const SampleDatabase& db, const NoiseAugmentation* augmentation = nullptr);
   /**
-   * @brief evaluateOnDatabase evaluates a detector on a given database
+   * @brief evaluateOnDatabase evaluates a detector on a given database (the raw outputs per file are cached if results are collected)
    * @param db the database on which the detector is evaluated
    * @param results is filled with the results of the evaluation
+   * @param verbose whether hits, misses and results are printed
+   */
+  virtual void evaluateOnDatabase(const SampleDatabase& db, EvaluationResults* results = nullptr, bool verbose = true);
+  /**
+   * @brief evaluateWithCache takes the output of the detector on a file from the cache or evaluates and caches it
+   * @param file the file on which the detector is evaluated
+   * @param output is filled with the raw output of the detector on the file
+   * @return whether the output has been taken from the cache
    */
-  virtual void evaluateOnDatabase(const SampleDatabase& db, EvaluationResults* results = nullptr);
+  bool evaluateWithCache(const AudioFile& file, DetectorOutput& output);
 };
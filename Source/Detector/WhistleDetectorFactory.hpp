@@ -25,10 +25,13 @@ public:
   }
   /**
    * @brief make creates an instance of the detector
+   * @param parameters values that override the default parameters of the detector
    * @return a shared pointer to the newly created detector instance
    */
-  virtual std::shared_ptr<WhistleDetectorBase> make() const override
+  virtual std::shared_ptr<WhistleDetectorBase> make(const ParameterMap& parameters) const override
   {
-    return std::make_shared<Derived>();
+    auto detector = std::make_shared<Derived>();
+    detector->getParameters().set(parameters);
+    return detector;
   }
 };
@@ -13,19 +13,19 @@
 WhistleDetectorFactoryBase* WhistleDetectorFactoryBase::first = nullptr;
 
 WhistleDetectorFactoryBase::WhistleDetectorFactoryBase(const std::type_index& type)
-  : name(demangle(type.name()))
+  : name(getName(type))
 {
   next = first;
   first = this;
 }
 
-std::shared_ptr<WhistleDetectorBase> WhistleDetectorFactoryBase::make(const std::string& name)
+std::shared_ptr<WhistleDetectorBase> WhistleDetectorFactoryBase::make(const std::string& name, const ParameterMap& parameters)
 {
   for (const WhistleDetectorFactoryBase* factory = first; factory != nullptr; factory = factory->next)
   {
     if (factory->name == name)
     {
-      return factory->make();
+      return factory->make(parameters);
     }
   }
   throw std::runtime_error("No factory could create a detector for a given name!");
@@ -41,6 +41,11 @@ std::vector<std::string> WhistleDetectorFactoryBase::getDetectorNames()
   return result;
 }
 
+std::string WhistleDetectorFactoryBase::getName(const std::type_index& type)
+{
+  return demangle(type.name());
+}
+
 void WhistleDetectorFactoryBase::use() const
 {
 }
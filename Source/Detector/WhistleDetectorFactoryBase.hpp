@@ -9,6 +9,8 @@
 #include <vector>
 #include <typeindex>
 
+#include "DetectorParameters.hpp"
+
 
 class WhistleDetectorBase;
 
@@ -28,20 +30,28 @@ public:
   virtual ~WhistleDetectorFactoryBase() = default;
   /**
    * @brief make creates an instance of the detector
+   * @param parameters values that override the default parameters of the detector
    * @return a shared pointer to the newly created detector instance
    */
-  virtual std::shared_ptr<WhistleDetectorBase> make() const = 0;
+  virtual std::shared_ptr<WhistleDetectorBase> make(const ParameterMap& parameters) const = 0;
   /**
    * @brief make creates an instance of a detector with a given name
    * @param name the name of the detector class
+   * @param parameters values that override the default parameters of the detector
    * @return a shared pointer to the newly created detector instance
    */
-  static std::shared_ptr<WhistleDetectorBase> make(const std::string& name);
+  static std::shared_ptr<WhistleDetectorBase> make(const std::string& name, const ParameterMap& parameters = ParameterMap());
   /**
    * @brief getDetectorNames returns the names of all registered detectors
    * @return a list of the names of all registered detectors
    */
   static std::vector<std::string> getDetectorNames();
+  /**
+   * @brief getName returns the name under which a detector class is registered
+   * @param type the type of the detector
+   * @return the name of the detector class
+   */
+  static std::string getName(const std::type_index& type);
   /**
    * @brief use is called from somewhere to force the construction of a factory
    */
@@ -5,20 +5,12 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
-#include "AudioFile.hpp"
-
 #include "AudioChannel.hpp"
 
 
-void AudioChannel::read(const QJsonObject& object, const AudioFile& audioFile, const unsigned int channelNumber)
+void AudioChannel::read(const QJsonObject& object, const unsigned int channelNumber)
 {
   channel = channelNumber;
-  // get the samples from the audio file that this channel belongs to
-  samples.resize(audioFile.samples.size() / audioFile.numberOfChannels);
-  for (int i = 0; i < samples.size(); i++)
-  {
-    samples[i] = audioFile.samples[i * audioFile.numberOfChannels + channel];
-  }
   QJsonArray whistleLabelArray = object["whistleLabels"].toArray();
   whistleLabels.resize(whistleLabelArray.size());
   for (int whistleLabelIndex = 0; whistleLabelIndex < whistleLabelArray.size(); whistleLabelIndex++)
@@ -4,13 +4,16 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QMetaType>
 #include <QVector>
 
 #include "WhistleLabel.hpp"
 
 
-class AudioFile;
+class QJsonObject;
+class WaveformPyramid;
 
 /**
  * @class AudioChannel is a single channel of an audio file
@@ -20,11 +23,10 @@ class AudioChannel final
 public:
   /**
    * @brief read deserializes the object
-   * @param object the JSON object from which the object is deserialized
-   * @param audioFile the audio file to which the channel belongs
+   * @param object the JSON object from which the object is deserialized (the samples are decoded by the audio file)
    * @param channelNumber the number of the channel inside the file
    */
-  void read(const QJsonObject& object, const AudioFile& audioFile, const unsigned int channelNumber);
+  void read(const QJsonObject& object, const unsigned int channelNumber);
   /**
    * @brief write serializes the object
    * @param object the JSON object to which the serialization is written
@@ -38,6 +40,8 @@ public:
   QVector<WhistleLabel> whistleLabels;
   /// whether the labeling is complete (otherwise it is dangerous to sample negatives from this channel)
   bool completelyLabeled = false;
+  /// a summary of the samples for drawing (built when the channel is selected for the first time)
+  std::shared_ptr<const WaveformPyramid> waveform;
 };
 
 Q_DECLARE_METATYPE(AudioChannel)
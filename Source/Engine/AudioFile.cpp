@@ -10,26 +10,60 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include "Detector/Trace.hpp"
+
 #include "AudioFile.hpp"
 
 
 void AudioFile::read(const QJsonObject& object, const QDir& basedir)
 {
+  TRACE_SCOPE("AudioFile::read");
   path = object["path"].toString();
+  filePath = basedir.filePath(path);
   QJsonArray channelArray = object["channels"].toArray();
   SF_INFO sfinfo;
   std::memset(&sfinfo, 0, sizeof(sfinfo));
-  SNDFILE* f = sf_open(basedir.filePath(path).toStdString().c_str(), SFM_READ, &sfinfo);
+  SNDFILE* f = sf_open(filePath.toStdString().c_str(), SFM_READ, &sfinfo);
   if (f == nullptr)
   {
     throw std::runtime_error("Could not open audio file!");
   }
+  sf_close(f);
   numberOfChannels = sfinfo.channels;
   if (numberOfChannels != static_cast<unsigned int>(channelArray.size()))
   {
     throw std::runtime_error("Audio file has different number of channels than indicated in sample database!");
   }
   sampleRate = sfinfo.samplerate;
+  samples.clear();
+  decoded = false;
+  channels.clear();
+  for (int channelIndex = 0; channelIndex < channelArray.size(); channelIndex++)
+  {
+    QJsonObject audioChannelObject = channelArray[channelIndex].toObject();
+    AudioChannel audioChannel;
+    audioChannel.read(audioChannelObject, static_cast<unsigned int>(channelIndex));
+    channels.append(audioChannel);
+  }
+}
+
+void AudioFile::decode()
+{
+  TRACE_SCOPE("AudioFile::decode");
+  TRACE_STAGE(stage, "AudioFile: Read");
+  SF_INFO sfinfo;
+  std::memset(&sfinfo, 0, sizeof(sfinfo));
+  SNDFILE* f = sf_open(filePath.toStdString().c_str(), SFM_READ, &sfinfo);
+  if (f == nullptr)
+  {
+    throw std::runtime_error("Could not open audio file!");
+  }
+  if (numberOfChannels != static_cast<unsigned int>(sfinfo.channels) || channels.size() != sfinfo.channels)
+  {
+    sf_close(f);
+    throw std::runtime_error("Audio file has different number of channels than indicated in sample database!");
+  }
+  sampleRate = sfinfo.samplerate;
   samples.resize(static_cast<int>(sfinfo.frames * sfinfo.channels));
   if (sf_readf_float(f, samples.data(), sfinfo.frames) != sfinfo.frames)
   {
@@ -37,14 +71,17 @@ void AudioFile::read(const QJsonObject& object, const QDir& basedir)
     throw std::runtime_error("Could not read samples from file!");
   }
   sf_close(f);
-  channels.clear();
-  for (int channelIndex = 0; channelIndex < channelArray.size(); channelIndex++)
+  // get the samples of each channel from the interleaved samples of the file
+  TRACE_NEXT_STAGE(stage, "AudioFile: Deinterleave");
+  for (auto& audioChannel : channels)
   {
-    QJsonObject audioChannelObject = channelArray[channelIndex].toObject();
-    AudioChannel audioChannel;
-    audioChannel.read(audioChannelObject, *this, static_cast<unsigned int>(channelIndex));
-    channels.append(audioChannel);
+    audioChannel.samples.resize(samples.size() / static_cast<int>(numberOfChannels));
+    for (int i = 0; i < audioChannel.samples.size(); i++)
+    {
+      audioChannel.samples[i] = samples[i * static_cast<int>(numberOfChannels) + static_cast<int>(audioChannel.channel)];
+    }
   }
+  decoded = true;
 }
 
 void AudioFile::write(QJsonObject& object) const
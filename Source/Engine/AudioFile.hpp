@@ -20,18 +20,26 @@ class AudioFile final
 {
 public:
   /**
-   * @brief read deserializes the object
+   * @brief read deserializes the object (only the header of the audio file is read, the samples are decoded separately)
    * @param object the JSON object from which the object is deserialized
    * @param basedir the directory relative to which paths are given
    */
   void read(const QJsonObject& object, const QDir& basedir);
+  /**
+   * @brief decode reads the samples of the file and distributes them to the channels
+   */
+  void decode();
   /**
    * @brief write serializes the object
    * @param object the JSON object to which the serialization is written
    */
   void write(QJsonObject& object) const;
+  /// the id of the file in its sample database (not serialized, unique while the program runs)
+  unsigned int id = 0;
   /// the path to the corresponding file
   QString path;
+  /// the path from which the file is decoded (not serialized, the path resolved against the database directory)
+  QString filePath;
   /// the number of channels in the file
   unsigned int numberOfChannels = 0;
   /// the sample rate of the file
@@ -40,4 +48,6 @@ public:
   QVector<float> samples;
   /// the channels of the file
   QList<AudioChannel> channels;
+  /// whether the samples have been decoded
+  bool decoded = false;
 };
@@ -0,0 +1,24 @@
+/**
+ * @file AudioFileInfo.cpp implements methods for the audio file info class
+ */
+
+#include "AudioFile.hpp"
+
+#include "AudioFileInfo.hpp"
+
+
+AudioFileInfo::AudioFileInfo(const AudioFile& audioFile)
+  : id(audioFile.id)
+  , path(audioFile.path)
+  , sampleRate(audioFile.sampleRate)
+  , decoded(audioFile.decoded)
+{
+  channels.reserve(audioFile.channels.size());
+  for (auto& audioChannel : audioFile.channels)
+  {
+    Channel channel;
+    channel.channel = audioChannel.channel;
+    channel.whistleLabels = audioChannel.whistleLabels;
+    channels.append(channel);
+  }
+}
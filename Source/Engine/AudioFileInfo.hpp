@@ -0,0 +1,53 @@
+/**
+ * @file AudioFileInfo.hpp declares the audio file info class
+ */
+
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+#include "WhistleLabel.hpp"
+
+
+class AudioFile;
+
+/**
+ * @class AudioFileInfo is everything about an audio file that the UI needs (i.e. everything except for the samples)
+ */
+class AudioFileInfo final
+{
+public:
+  /**
+   * @struct Channel describes a channel of the file
+   */
+  struct Channel
+  {
+    /// the index of the channel in the file
+    unsigned int channel = 0;
+    /// the set of labeled whistles in the channel
+    QVector<WhistleLabel> whistleLabels;
+  };
+  /**
+   * @brief AudioFileInfo creates an empty info
+   */
+  AudioFileInfo() = default;
+  /**
+   * @brief AudioFileInfo copies the description of a file
+   * @param audioFile the audio file
+   */
+  explicit AudioFileInfo(const AudioFile& audioFile);
+  /// the id of the file in its sample database
+  unsigned int id = 0;
+  /// the path to the corresponding file
+  QString path;
+  /// the sample rate of the file
+  unsigned int sampleRate = 0;
+  /// the channels of the file
+  QVector<Channel> channels;
+  /// whether the samples of the file have been decoded (i.e. whether its channels can be opened)
+  bool decoded = false;
+};
+
+Q_DECLARE_METATYPE(AudioFileInfo)
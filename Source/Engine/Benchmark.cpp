@@ -0,0 +1,182 @@
+/**
+ * @file Benchmark.cpp implements methods of the BenchmarkRecord struct and the Benchmark class
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QSysInfo>
+#include <QVector>
+
+#include "Detector/EvaluationHandle.hpp"
+#include "Detector/EvaluationScorer.hpp"
+#include "Detector/Hasher.hpp"
+#include "Detector/WhistleDetectorBase.hpp"
+#include "Detector/WhistleDetectorFactoryBase.hpp"
+#include "Engine/EvaluationResults.hpp"
+#include "Engine/SampleDatabase.hpp"
+
+#include "Benchmark.hpp"
+#include "WhistleLabCommit.hpp"
+
+
+constexpr unsigned int Benchmark::maxExecutionTimes;
+
+void BenchmarkRecord::read(const QJsonObject& object)
+{
+  detector = object["detector"].toString().toStdString();
+  parameters.clear();
+  const QJsonObject parameterObject = object["parameters"].toObject();
+  for (const QString& name : parameterObject.keys())
+  {
+    parameters[name.toStdString()] = parameterObject[name].toDouble();
+  }
+  commit = object["commit"].toString().toStdString();
+  machine = object["machine"].toString().toStdString();
+  machineDescription = object["machineDescription"].toString().toStdString();
+  database = object["database"].toString().toStdString();
+  date = object["date"].toString().toStdString();
+  positives = static_cast<unsigned int>(object["positives"].toInt());
+  truePositives = static_cast<unsigned int>(object["truePositives"].toInt());
+  falsePositives = static_cast<unsigned int>(object["falsePositives"].toInt());
+  averageDelay = static_cast<float>(object["averageDelay"].toDouble());
+  rocArea = static_cast<float>(object["rocArea"].toDouble());
+  allocationTrackedBuffers = static_cast<std::uint64_t>(object["allocationTrackedBuffers"].toDouble());
+  steadyStateAllocations = static_cast<std::uint64_t>(object["steadyStateAllocations"].toDouble());
+  steadyStateAllocatedBytes = static_cast<std::uint64_t>(object["steadyStateAllocatedBytes"].toDouble());
+  const QJsonArray executionTimeArray = object["executionTimes"].toArray();
+  executionTimes.resize(static_cast<std::size_t>(executionTimeArray.size()));
+  for (int i = 0; i < executionTimeArray.size(); i++)
+  {
+    executionTimes[static_cast<std::size_t>(i)] = static_cast<float>(executionTimeArray[i].toDouble());
+  }
+}
+
+void BenchmarkRecord::write(QJsonObject& object) const
+{
+  object["detector"] = QString::fromStdString(detector);
+  QJsonObject parameterObject;
+  for (const auto& parameter : parameters)
+  {
+    parameterObject[QString::fromStdString(parameter.first)] = parameter.second;
+  }
+  object["parameters"] = parameterObject;
+  object["commit"] = QString::fromStdString(commit);
+  object["machine"] = QString::fromStdString(machine);
+  object["machineDescription"] = QString::fromStdString(machineDescription);
+  object["database"] = QString::fromStdString(database);
+  object["date"] = QString::fromStdString(date);
+  object["positives"] = static_cast<int>(positives);
+  object["truePositives"] = static_cast<int>(truePositives);
+  object["falsePositives"] = static_cast<int>(falsePositives);
+  object["averageDelay"] = static_cast<double>(averageDelay);
+  object["rocArea"] = static_cast<double>(rocArea);
+  // JSON numbers are doubles, which represent all counts that can occur exactly.
+  object["allocationTrackedBuffers"] = static_cast<double>(allocationTrackedBuffers);
+  object["steadyStateAllocations"] = static_cast<double>(steadyStateAllocations);
+  object["steadyStateAllocatedBytes"] = static_cast<double>(steadyStateAllocatedBytes);
+  QJsonArray executionTimeArray;
+  for (const float executionTime : executionTimes)
+  {
+    executionTimeArray.append(static_cast<double>(executionTime));
+  }
+  object["executionTimes"] = executionTimeArray;
+}
+
+bool BenchmarkRecord::isComparableTo(const BenchmarkRecord& other) const
+{
+  return detector == other.detector && parameters == other.parameters && database == other.database && machine == other.machine;
+}
+
+BenchmarkRecord Benchmark::run(SampleDatabase& db, const std::string& detector, const ParameterMap& parameters)
+{
+  BenchmarkRecord record;
+  record.detector = detector;
+  record.parameters = parameters;
+  record.commit = getCommit();
+  record.machine = getMachineFingerprint(record.machineDescription);
+  record.database = db.name.toStdString();
+
+  auto instance = WhistleDetectorFactoryBase::make(detector, parameters);
+  EvaluationResults results;
+  EvaluationScorer scorer(results, false);
+  // The execution times are reservoir sampled, so that every buffer of the database has the same chance to be kept.
+  std::mt19937 generator(0);
+  std::size_t numberOfExecutionTimes = 0;
+  for (auto& file : db.audioFiles)
+  {
+    file.decode();
+    EvaluationHandle eh(file);
+    instance->evaluate(eh);
+    scorer.add(file, eh.getOutput());
+    for (const float executionTime : eh.getOutput().executionTimes)
+    {
+      if (record.executionTimes.size() < maxExecutionTimes)
+      {
+        record.executionTimes.push_back(executionTime);
+      }
+      else
+      {
+        const std::size_t j = std::uniform_int_distribution<std::size_t>(0, numberOfExecutionTimes)(generator);
+        if (j < maxExecutionTimes)
+        {
+          record.executionTimes[j] = executionTime;
+        }
+      }
+      numberOfExecutionTimes++;
+    }
+    for (auto& channel : file.channels)
+    {
+      channel.samples = QVector<float>();
+    }
+    file.decoded = false;
+  }
+  scorer.finish();
+
+  record.positives = results.positives;
+  record.truePositives = results.truePositives;
+  record.falsePositives = results.falsePositives;
+  record.averageDelay = results.averageDelay;
+  record.rocArea = results.rocArea;
+  record.allocationTrackedBuffers = results.allocationTrackedBuffers;
+  record.steadyStateAllocations = results.steadyStateAllocations;
+  record.steadyStateAllocatedBytes = results.steadyStateAllocatedBytes;
+  record.date = QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString();
+  return record;
+}
+
+std::string Benchmark::getCommit()
+{
+  return WHISTLELAB_COMMIT;
+}
+
+std::string Benchmark::getMachineFingerprint(std::string& description)
+{
+  std::string cpu = QSysInfo::currentCpuArchitecture().toStdString();
+  std::ifstream cpuInfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuInfo, line))
+  {
+    if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos)
+    {
+      cpu = line.substr(line.find(':') + 2);
+      break;
+    }
+  }
+  std::ostringstream stream;
+  stream << cpu << ", " << std::thread::hardware_concurrency() << " threads, " << QSysInfo::prettyProductName().toStdString();
+  description = stream.str();
+  Hasher hasher;
+  hasher.add(description);
+  hasher.add(QSysInfo::machineHostName().toStdString());
+  std::ostringstream fingerprint;
+  fingerprint << std::hex << std::setw(16) << std::setfill('0') << hasher.hash;
+  return fingerprint.str();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file Benchmark.hpp declares the BenchmarkRecord struct and the Benchmark class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Detector/DetectorParameters.hpp"
+
+
+class QJsonObject;
+class SampleDatabase;
+
+/**
+ * @struct BenchmarkRecord is the result of a benchmark of a detector on a database
+ */
+struct BenchmarkRecord
+{
+  /**
+   * @brief read deserializes the record
+   * @param object the JSON object from which the record is deserialized
+   */
+  void read(const QJsonObject& object);
+  /**
+   * @brief write serializes the record
+   * @param object the JSON object to which the serialization is written
+   */
+  void write(QJsonObject& object) const;
+  /**
+   * @brief isComparableTo determines whether two records measure the same thing on the same machine
+   * @param other the other record
+   * @return whether detector, parameters, database and machine are the same
+   */
+  bool isComparableTo(const BenchmarkRecord& other) const;
+  /// the name of the detector
+  std::string detector;
+  /// the parameters of the detector
+  ParameterMap parameters;
+  /// the commit from which the program has been built
+  std::string commit;
+  /// a fingerprint of the machine on which the benchmark has run
+  std::string machine;
+  /// a human readable description of the machine
+  std::string machineDescription;
+  /// the name of the sample database
+  std::string database;
+  /// the time (UTC, ISO 8601) at which the benchmark has finished
+  std::string date;
+  /// the number of labeled whistles
+  unsigned int positives = 0;
+  /// the number of detected whistles
+  unsigned int truePositives = 0;
+  /// the number of detections outside of whistles
+  unsigned int falsePositives = 0;
+  /// the average delay of the first detection of a whistle in seconds
+  float averageDelay = 0.f;
+  /// the area under the ROC curve
+  float rocArea = 0.f;
+  /// the number of buffers after the warm-up whose allocations have been counted (0 if allocation tracking is not compiled in)
+  std::uint64_t allocationTrackedBuffers = 0;
+  /// the number of allocations by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocations = 0;
+  /// the number of bytes allocated by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocatedBytes = 0;
+  /// a uniform sample of the execution times per buffer (in seconds per second of audio)
+  std::vector<float> executionTimes;
+};
+
+/**
+ * @class Benchmark measures a detector on a database for the benchmark history
+ *
+ * Unlike evaluateOnDatabase, the benchmark never takes outputs from the output cache because their execution times
+ * could have been measured with another build. The files are decoded one at a time.
+ */
+class Benchmark final
+{
+public:
+  /**
+   * @brief run evaluates a detector on all files of a database
+   * @param db the database (its files are decoded during the benchmark and released afterwards)
+   * @param detector the name of the detector
+   * @param parameters the parameters of the detector that differ from its defaults
+   * @return the record of the benchmark
+   */
+  static BenchmarkRecord run(SampleDatabase& db, const std::string& detector, const ParameterMap& parameters);
+  /**
+   * @brief getCommit returns the commit from which the program has been built
+   * @return the commit (with the suffix -dirty if tracked files have been modified, unknown if the build system could not determine it)
+   */
+  static std::string getCommit();
+  /**
+   * @brief getMachineFingerprint identifies the machine on which the program runs
+   * @param description is set to a human readable description of the machine
+   * @return a fingerprint of CPU, number of threads, operating system and host name
+   */
+  static std::string getMachineFingerprint(std::string& description);
+private:
+  /// the maximum number of execution times that are kept per record
+  static constexpr unsigned int maxExecutionTimes = 2048;
+};
@@ -0,0 +1,302 @@
+/**
+ * @file BenchmarkHistory.cpp implements methods of the BenchmarkHistory class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include <QFile>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "BenchmarkHistory.hpp"
+
+
+namespace
+{
+  /**
+   * @brief median computes the median of values
+   * @param values the values (they are reordered)
+   * @return the median
+   */
+  double median(std::vector<float>& values)
+  {
+    const std::size_t half = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(half), values.end());
+    const double upper = values[half];
+    if (values.size() % 2 == 1)
+    {
+      return upper;
+    }
+    return (upper + static_cast<double>(*std::max_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(half)))) / 2.0;
+  }
+
+  /**
+   * @brief resampleRuns draws a hierarchical bootstrap resample, i.e. runs with replacement and buffers with replacement within each drawn run
+   * @param runs the execution times per buffer of each run (none of them empty)
+   * @param generator the random number generator
+   * @param resample is filled with the execution times of the resample
+   */
+  void resampleRuns(const std::vector<std::vector<float>>& runs, std::mt19937& generator, std::vector<float>& resample)
+  {
+    resample.clear();
+    std::uniform_int_distribution<std::size_t> runIndex(0, runs.size() - 1);
+    for (std::size_t i = 0; i < runs.size(); i++)
+    {
+      const std::vector<float>& run = runs[runIndex(generator)];
+      std::uniform_int_distribution<std::size_t> bufferIndex(0, run.size() - 1);
+      for (std::size_t j = 0; j < run.size(); j++)
+      {
+        resample.push_back(run[bufferIndex(generator)]);
+      }
+    }
+  }
+
+  /**
+   * @brief bootstrapMedianChange computes a hierarchical bootstrap confidence interval of the relative change of the median
+   *
+   * Whole runs are resampled before the buffers within them, so that the interval also covers the variation between
+   * runs (e.g. by frequency scaling or other load of the machine), which is usually larger than the one within a run.
+   * @param baseline the execution times per buffer of each run of the baseline
+   * @param candidate the execution times per buffer of each run of the candidate
+   * @param resamples the number of bootstrap resamples
+   * @param confidence the confidence level of the interval
+   * @param lower is set to the lower bound of the interval
+   * @param upper is set to the upper bound of the interval
+   */
+  void bootstrapMedianChange(const std::vector<std::vector<float>>& baseline, const std::vector<std::vector<float>>& candidate,
+                             const unsigned int resamples, const double confidence, double& lower, double& upper)
+  {
+    // A fixed seed makes the comparison of the same history reproducible.
+    std::mt19937 generator(0);
+    std::vector<float> baselineResample;
+    std::vector<float> candidateResample;
+    std::vector<double> changes;
+    changes.reserve(resamples);
+    for (unsigned int r = 0; r < resamples; r++)
+    {
+      resampleRuns(baseline, generator, baselineResample);
+      resampleRuns(candidate, generator, candidateResample);
+      const double baselineMedian = median(baselineResample);
+      if (baselineMedian > 0.0)
+      {
+        changes.push_back(median(candidateResample) / baselineMedian - 1.0);
+      }
+    }
+    if (changes.empty())
+    {
+      lower = upper = 0.0;
+      return;
+    }
+    std::sort(changes.begin(), changes.end());
+    const double last = static_cast<double>(changes.size() - 1);
+    lower = changes[static_cast<std::size_t>(std::floor((1.0 - confidence) / 2.0 * last))];
+    upper = changes[static_cast<std::size_t>(std::ceil((1.0 + confidence) / 2.0 * last))];
+  }
+
+  /**
+   * @brief getRecall computes the recall of a record
+   * @param record the record
+   * @return the fraction of labeled whistles that have been detected
+   */
+  float getRecall(const BenchmarkRecord& record)
+  {
+    return record.positives > 0 ? static_cast<float>(record.truePositives) / static_cast<float>(record.positives) : 0.f;
+  }
+
+  /**
+   * @brief getAllocationsPerBuffer computes the steady state allocations per buffer of a record
+   * @param record the record
+   * @return the average number of allocations per tracked buffer (0 if allocations have not been tracked)
+   */
+  double getAllocationsPerBuffer(const BenchmarkRecord& record)
+  {
+    return record.allocationTrackedBuffers > 0 ? static_cast<double>(record.steadyStateAllocations) / static_cast<double>(record.allocationTrackedBuffers) : 0.0;
+  }
+}
+
+const char* BenchmarkHistory::defaultFileName = "../BenchmarkHistory.jsonl";
+constexpr double BenchmarkHistory::significanceLevel;
+constexpr double BenchmarkHistory::minimumEffect;
+constexpr unsigned int BenchmarkHistory::bootstrapResamples;
+
+BenchmarkHistory::BenchmarkHistory(const QString& fileName) :
+  fileName(fileName)
+{
+}
+
+std::vector<BenchmarkRecord> BenchmarkHistory::load() const
+{
+  std::vector<BenchmarkRecord> records;
+  QFile inFile(fileName);
+  if (!inFile.exists())
+  {
+    return records;
+  }
+  if (!inFile.open(QIODevice::ReadOnly))
+  {
+    throw std::runtime_error("Could not open benchmark history file for reading!");
+  }
+  while (!inFile.atEnd())
+  {
+    const QByteArray line = inFile.readLine().trimmed();
+    if (line.isEmpty())
+    {
+      continue;
+    }
+    // A line that has been cut off by an interrupted append must not make the rest of the history unusable.
+    const QJsonDocument doc = QJsonDocument::fromJson(line);
+    if (!doc.isObject())
+    {
+      std::cerr << "Skipping a malformed line in the benchmark history.\n";
+      continue;
+    }
+    records.emplace_back();
+    records.back().read(doc.object());
+  }
+  return records;
+}
+
+void BenchmarkHistory::append(const BenchmarkRecord& record) const
+{
+  QFile outFile(fileName);
+  if (!outFile.open(QIODevice::WriteOnly | QIODevice::Append))
+  {
+    throw std::runtime_error("Could not open benchmark history file for writing!");
+  }
+  QJsonObject object;
+  record.write(object);
+  QByteArray line = QJsonDocument(object).toJson(QJsonDocument::Compact);
+  line.append('\n');
+  if (outFile.write(line) != line.size())
+  {
+    throw std::runtime_error("Could not write the benchmark history!");
+  }
+}
+
+bool BenchmarkHistory::compare(const std::string& detector, std::string baselineCommit, std::string candidateCommit) const
+{
+  const std::vector<BenchmarkRecord> records = load();
+  // The latest record of the candidate determines which records are comparable.
+  const BenchmarkRecord* reference = nullptr;
+  for (auto it = records.rbegin(); it != records.rend(); ++it)
+  {
+    if (it->detector == detector && (candidateCommit.empty() || it->commit == candidateCommit))
+    {
+      reference = &*it;
+      break;
+    }
+  }
+  if (!reference)
+  {
+    throw std::runtime_error("There is no benchmark record of the candidate!");
+  }
+  candidateCommit = reference->commit;
+  if (baselineCommit.empty())
+  {
+    for (auto it = records.rbegin(); it != records.rend(); ++it)
+    {
+      if (it->isComparableTo(*reference) && it->commit != candidateCommit)
+      {
+        baselineCommit = it->commit;
+        break;
+      }
+    }
+  }
+
+  // The runs are kept apart, so that the variation between them is part of the comparison.
+  std::vector<std::vector<float>> baselineRuns;
+  std::vector<std::vector<float>> candidateRuns;
+  std::vector<float> baselineTimes;
+  std::vector<float> candidateTimes;
+  const BenchmarkRecord* baseline = nullptr;
+  for (const auto& record : records)
+  {
+    if (!record.isComparableTo(*reference) || record.executionTimes.empty())
+    {
+      continue;
+    }
+    if (record.commit == baselineCommit)
+    {
+      baselineRuns.push_back(record.executionTimes);
+      baselineTimes.insert(baselineTimes.end(), record.executionTimes.begin(), record.executionTimes.end());
+      baseline = &record;
+    }
+    else if (record.commit == candidateCommit)
+    {
+      candidateRuns.push_back(record.executionTimes);
+      candidateTimes.insert(candidateTimes.end(), record.executionTimes.begin(), record.executionTimes.end());
+    }
+  }
+  if (!baseline || candidateRuns.empty())
+  {
+    throw std::runtime_error("There is no comparable benchmark record of the baseline!");
+  }
+
+  std::cout << "Comparing " << detector << " on " << reference->database << " (" << reference->machineDescription << ")\n"
+            << "Baseline:  " << baselineCommit << " (" << baselineRuns.size() << " runs, " << baselineTimes.size() << " buffers)\n"
+            << "Candidate: " << candidateCommit << " (" << candidateRuns.size() << " runs, " << candidateTimes.size() << " buffers)\n\n";
+  if (baselineRuns.size() < 2 || candidateRuns.size() < 2)
+  {
+    std::cout << "Warning: the variation between runs can only be taken into account with at least two runs per commit.\n\n";
+  }
+
+  const double confidence = 1.0 - significanceLevel;
+  double lower = 0.0;
+  double upper = 0.0;
+  bootstrapMedianChange(baselineRuns, candidateRuns, bootstrapResamples, confidence, lower, upper);
+  const double baselineMedian = median(baselineTimes);
+  const double candidateMedian = median(candidateTimes);
+  const bool slower = lower > minimumEffect;
+  std::cout << std::fixed << std::setprecision(3)
+            << "Median execution time per buffer: " << 1000.0 * baselineMedian << " ms/s -> " << 1000.0 * candidateMedian << " ms/s\n"
+            << std::setprecision(1) << "Change of the median: [" << 100.0 * lower << "%, " << 100.0 * upper << "%] ("
+            << 100.0 * confidence << "% CI)\n";
+
+  const bool lessRecall = getRecall(*reference) < getRecall(*baseline);
+  const bool moreFalsePositives = reference->falsePositives > baseline->falsePositives;
+  const bool smallerRocArea = reference->rocArea < baseline->rocArea;
+  const bool moreDelay = reference->averageDelay > baseline->averageDelay;
+  std::cout << std::setprecision(3)
+            << "Recall: " << getRecall(*baseline) << " -> " << getRecall(*reference) << '\n'
+            << "False positives: " << baseline->falsePositives << " -> " << reference->falsePositives << '\n'
+            << "ROC area: " << baseline->rocArea << " -> " << reference->rocArea << '\n'
+            << "Average delay: " << baseline->averageDelay << " s -> " << reference->averageDelay << " s\n";
+  // Allocations can only be compared if both builds have tracked them.
+  const bool allocationsTracked = baseline->allocationTrackedBuffers > 0 && reference->allocationTrackedBuffers > 0;
+  const bool moreAllocations = allocationsTracked && getAllocationsPerBuffer(*reference) > getAllocationsPerBuffer(*baseline);
+  if (allocationsTracked)
+  {
+    std::cout << "Steady state allocations per buffer: " << getAllocationsPerBuffer(*baseline) << " -> "
+              << getAllocationsPerBuffer(*reference) << '\n';
+  }
+  std::cout << '\n' << std::defaultfloat << std::setprecision(6);
+
+  const bool regression = slower || lessRecall || moreFalsePositives || smallerRocArea || moreDelay || moreAllocations;
+  if (slower)
+  {
+    std::cout << "Regression: the execution time has increased significantly.\n";
+  }
+  if (lessRecall || moreFalsePositives || smallerRocArea)
+  {
+    std::cout << "Regression: the accuracy has decreased.\n";
+  }
+  if (moreDelay)
+  {
+    std::cout << "Regression: the detection latency has increased.\n";
+  }
+  if (moreAllocations)
+  {
+    std::cout << "Regression: the detector allocates more memory in its steady state.\n";
+  }
+  if (!regression)
+  {
+    std::cout << "No regression.\n";
+  }
+  return regression;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file BenchmarkHistory.hpp declares the BenchmarkHistory class
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "Engine/Benchmark.hpp"
+
+
+/**
+ * @class BenchmarkHistory is a local store of benchmark records that can compare two commits
+ *
+ * The history is a file with one JSON object per line, so that records are only ever appended. Two commits are
+ * compared on the records that are comparable to the latest record of the candidate commit (same detector,
+ * parameters, database and machine). Each record is a run, and the execution times per buffer of two commits are
+ * compared by a hierarchical bootstrap confidence interval of the relative change of the median that resamples whole
+ * runs before the buffers within them. A slowdown is only flagged as regression if the whole interval is above a
+ * minimum effect, so that noise of the machine and differences between runs do not fail a comparison. Accuracy and latency are deterministic and are compared directly.
+ */
+class BenchmarkHistory final
+{
+public:
+  /**
+   * @brief BenchmarkHistory opens a history file
+   * @param fileName the name of the history file (it does not have to exist yet)
+   */
+  explicit BenchmarkHistory(const QString& fileName);
+  /**
+   * @brief load reads all records from the history file
+   * @return the records in the order in which they have been appended
+   * @throw std::runtime_error if the file exists but cannot be read
+   */
+  std::vector<BenchmarkRecord> load() const;
+  /**
+   * @brief append adds a record to the history file
+   * @param record the record
+   * @throw std::runtime_error if the file cannot be written
+   */
+  void append(const BenchmarkRecord& record) const;
+  /**
+   * @brief compare compares a candidate commit to a baseline commit and prints the comparison
+   * @param detector the name of the detector
+   * @param baselineCommit the baseline commit (empty for the commit before the candidate)
+   * @param candidateCommit the candidate commit (empty for the commit of the latest record)
+   * @return whether the candidate has a significant regression
+   * @throw std::runtime_error if there are no comparable records for both commits
+   */
+  bool compare(const std::string& detector, std::string baselineCommit, std::string candidateCommit) const;
+  /// the default name of the history file
+  static const char* defaultFileName;
+private:
+  /// the name of the history file
+  QString fileName;
+  /// the significance level of the timing comparison (one minus the confidence level of the interval)
+  static constexpr double significanceLevel = 0.01;
+  /// the relative increase of the median execution time that is tolerated
+  static constexpr double minimumEffect = 0.02;
+  /// the number of bootstrap resamples
+  static constexpr unsigned int bootstrapResamples = 1000;
+};
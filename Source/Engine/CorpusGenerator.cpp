@@ -0,0 +1,322 @@
+/**
+ * @file CorpusGenerator.cpp implements methods of the CorpusGenerator class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <sndfile.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Engine/SampleDatabase.hpp"
+#include "Engine/WorkerPool.hpp"
+
+#include "CorpusGenerator.hpp"
+
+
+constexpr unsigned int CorpusGenerator::blockSize;
+
+namespace
+{
+  /// the duration of the fade in and out of a whistle in seconds
+  constexpr double whistleRampDuration = 0.01;
+  /// the minimum duration between two whistles in seconds (so that their labels are separate)
+  constexpr double minWhistleGap = 0.1;
+  /// the value of pi
+  constexpr double pi = 3.14159265358979323846;
+
+  /**
+   * @class SplitMix64 is a small and fast random generator whose sequence only depends on its seed
+   */
+  class SplitMix64 final
+  {
+  public:
+    /**
+     * @brief SplitMix64 seeds the generator
+     * @param seed the seed
+     */
+    explicit SplitMix64(const std::uint64_t seed) :
+      state(seed)
+    {
+    }
+    /**
+     * @brief next returns the next random number
+     * @return a uniformly distributed 64 bit number
+     */
+    std::uint64_t next()
+    {
+      std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+    /**
+     * @brief uniform returns a uniformly distributed number in [min, max)
+     * @param min the minimum
+     * @param max the maximum
+     * @return the random number
+     */
+    double uniform(const double min = 0.0, const double max = 1.0)
+    {
+      return min + (max - min) * static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+  private:
+    /// the state of the generator
+    std::uint64_t state;
+  };
+
+  /**
+   * @brief readRange reads a range [min, max] from a JSON object if it is specified
+   * @param object the JSON object
+   * @param name the name of the range in the object
+   * @param min is set to the minimum of the range
+   * @param max is set to the maximum of the range
+   */
+  void readRange(const QJsonObject& object, const char* name, double& min, double& max)
+  {
+    if (!object.contains(name))
+    {
+      return;
+    }
+    const QJsonArray range = object[name].toArray();
+    if (range.size() != 2 || range[0].toDouble() > range[1].toDouble())
+    {
+      throw std::runtime_error(std::string("The corpus range ") + name + " needs to be [min, max]!");
+    }
+    min = range[0].toDouble();
+    max = range[1].toDouble();
+  }
+
+  /**
+   * @brief getFileName returns the name of a file of the corpus relative to the database
+   * @param index the index of the file
+   * @return the name of the file
+   */
+  QString getFileName(const unsigned int index)
+  {
+    std::ostringstream name;
+    name << "synthetic" << std::setw(5) << std::setfill('0') << index << ".wav";
+    return QString::fromStdString(name.str());
+  }
+}
+
+void CorpusGenerator::read(const QJsonObject& object, const QString& fileName)
+{
+  QFileInfo fileInfo(fileName);
+  outputDirectory = fileInfo.absoluteDir().absoluteFilePath(object.contains("output") ? object["output"].toString() : fileInfo.completeBaseName());
+  files = static_cast<unsigned int>(object["files"].toInt(static_cast<int>(files)));
+  duration = object["duration"].toDouble(duration);
+  channels = static_cast<unsigned int>(object["channels"].toInt(static_cast<int>(channels)));
+  sampleRate = static_cast<unsigned int>(object["sampleRate"].toInt(static_cast<int>(sampleRate)));
+  seed = static_cast<std::uint64_t>(object["seed"].toDouble(0.0));
+  noiseLevel = object["noiseLevel"].toDouble(noiseLevel);
+  clipLevel = object["clipLevel"].toDouble(clipLevel);
+  const QJsonObject whistles = object["whistles"].toObject();
+  whistlesPerMinute = whistles["perMinute"].toDouble(whistlesPerMinute);
+  readRange(whistles, "frequency", minFrequency, maxFrequency);
+  readRange(whistles, "duration", minWhistleDuration, maxWhistleDuration);
+  readRange(whistles, "amplitude", minAmplitude, maxAmplitude);
+  harmonics = static_cast<unsigned int>(whistles["harmonics"].toInt(static_cast<int>(harmonics)));
+  harmonicDecay = whistles["harmonicDecay"].toDouble(harmonicDecay);
+  readRange(whistles, "vibratoRate", minVibratoRate, maxVibratoRate);
+  readRange(whistles, "vibratoDepth", minVibratoDepth, maxVibratoDepth);
+  if (files == 0 || duration <= 0.0 || channels == 0 || sampleRate == 0)
+  {
+    throw std::runtime_error("The corpus needs at least one file with a positive duration, channels and sample rate!");
+  }
+  if (minWhistleDuration <= 0.0 || harmonics == 0 || whistlesPerMinute < 0.0)
+  {
+    throw std::runtime_error("The whistles of the corpus need a positive duration and at least one harmonic!");
+  }
+  if (duration * sampleRate > std::numeric_limits<int>::max())
+  {
+    throw std::runtime_error("The files of the corpus are too long to be labeled!");
+  }
+  if (clipLevel <= 0.0 || clipLevel > 1.0)
+  {
+    throw std::runtime_error("The clip level of the corpus has to be in (0, 1]!");
+  }
+}
+
+void CorpusGenerator::readFromFile(const QString& fileName)
+{
+  QFile inFile(fileName);
+  if (!inFile.open(QIODevice::ReadOnly))
+  {
+    throw std::runtime_error("Could not open corpus specification file for reading!");
+  }
+  QByteArray fileContent = inFile.readAll();
+  QJsonDocument doc = QJsonDocument::fromJson(fileContent);
+  read(doc.object(), fileName);
+}
+
+void CorpusGenerator::run() const
+{
+  QDir().mkpath(outputDirectory);
+  const QDir directory(outputDirectory);
+  std::vector<std::vector<WhistleLabel>> labels(files);
+  WorkerPool pool;
+  std::cout << "Generating " << files << " files of " << duration << " s on " << pool.getNumberOfThreads() << " threads...\n";
+  pool.run(files, [&](const unsigned int i)
+  {
+    generateFile(i, directory.absoluteFilePath(getFileName(i)), labels[i]);
+  });
+
+  SampleDatabase db;
+  for (unsigned int i = 0; i < files; i++)
+  {
+    AudioFile file;
+    file.path = getFileName(i);
+    file.numberOfChannels = channels;
+    file.sampleRate = sampleRate;
+    for (unsigned int c = 0; c < channels; c++)
+    {
+      AudioChannel channel;
+      channel.channel = c;
+      for (const auto& label : labels[i])
+      {
+        channel.whistleLabels.append(label);
+      }
+      channel.completelyLabeled = true;
+      file.channels.append(channel);
+    }
+    db.audioFiles.append(file);
+  }
+  const QString databaseFileName = directory.absoluteFilePath("corpus.json");
+  db.writeToFile(databaseFileName);
+  std::cout << "The corpus has been written to " << databaseFileName.toStdString() << '\n';
+}
+
+void CorpusGenerator::generateFile(const unsigned int index, const QString& fileName, std::vector<WhistleLabel>& labels) const
+{
+  // Each file has its own generator, so that it does not depend on which thread generates which file.
+  SplitMix64 random(seed ^ (0x9e3779b97f4a7c15ULL * (index + 1)));
+  const std::uint64_t totalFrames = static_cast<std::uint64_t>(duration * sampleRate);
+
+  // 1. Draw the whistles (the gaps between them are exponentially distributed).
+  std::vector<Whistle> whistles;
+  labels.clear();
+  if (whistlesPerMinute > 0.0)
+  {
+    const double meanGap = 60.0 * sampleRate / whistlesPerMinute;
+    double position = 0.0;
+    while (true)
+    {
+      position += -std::log(1.0 - random.uniform()) * meanGap;
+      Whistle whistle;
+      whistle.start = static_cast<unsigned int>(position);
+      whistle.length = std::max(1u, static_cast<unsigned int>(random.uniform(minWhistleDuration, maxWhistleDuration) * sampleRate));
+      if (static_cast<std::uint64_t>(whistle.start) + whistle.length > totalFrames)
+      {
+        break;
+      }
+      whistle.frequency = random.uniform(minFrequency, maxFrequency);
+      whistle.amplitude = random.uniform(minAmplitude, maxAmplitude);
+      whistle.vibratoRate = random.uniform(minVibratoRate, maxVibratoRate);
+      whistle.vibratoDepth = random.uniform(minVibratoDepth, maxVibratoDepth);
+      whistle.vibratoPhase = random.uniform(0.0, 2.0 * pi);
+      whistles.push_back(whistle);
+      WhistleLabel label;
+      label.start = static_cast<int>(whistle.start);
+      label.end = static_cast<int>(whistle.start + whistle.length);
+      labels.push_back(label);
+      position = whistle.start + whistle.length + minWhistleGap * sampleRate;
+    }
+  }
+  // The first channel has the nominal level, the others are attenuated as if their microphones were farther away.
+  std::vector<float> gains(channels, 1.f);
+  for (unsigned int c = 1; c < channels; c++)
+  {
+    gains[c] = static_cast<float>(random.uniform(0.5, 1.0));
+  }
+
+  // 2. Synthesize and write the file block by block.
+  SF_INFO sfinfo;
+  std::memset(&sfinfo, 0, sizeof(sfinfo));
+  sfinfo.samplerate = static_cast<int>(sampleRate);
+  sfinfo.channels = static_cast<int>(channels);
+  sfinfo.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+  SNDFILE* f = sf_open(fileName.toStdString().c_str(), SFM_WRITE, &sfinfo);
+  if (f == nullptr)
+  {
+    throw std::runtime_error("Could not open audio file for writing!");
+  }
+  std::vector<float> block(static_cast<std::size_t>(blockSize) * channels);
+  std::vector<float> tone(blockSize);
+  // Uniform noise in [-1, 1) has an RMS of 1 / sqrt(3).
+  const double noiseScale = noiseLevel * std::sqrt(3.0);
+  const double rampLength = whistleRampDuration * sampleRate;
+  const float clip = static_cast<float>(clipLevel);
+  std::size_t firstWhistle = 0;
+  for (std::uint64_t blockStart = 0; blockStart < totalFrames; blockStart += blockSize)
+  {
+    const unsigned int frames = static_cast<unsigned int>(std::min<std::uint64_t>(blockSize, totalFrames - blockStart));
+    for (std::size_t i = 0; i < static_cast<std::size_t>(frames) * channels; i++)
+    {
+      block[i] = static_cast<float>(noiseScale * random.uniform(-1.0, 1.0));
+    }
+    while (firstWhistle < whistles.size() && whistles[firstWhistle].start + whistles[firstWhistle].length <= blockStart)
+    {
+      firstWhistle++;
+    }
+    for (std::size_t w = firstWhistle; w < whistles.size() && whistles[w].start < blockStart + frames; w++)
+    {
+      const Whistle& whistle = whistles[w];
+      const std::uint64_t begin = std::max<std::uint64_t>(whistle.start, blockStart);
+      const std::uint64_t end = std::min<std::uint64_t>(whistle.start + whistle.length, blockStart + frames);
+      const double nyquist = 0.5 * sampleRate;
+      for (std::uint64_t t = begin; t < end; t++)
+      {
+        // The phase is the integral of the instantaneous frequency, so it is continuous across blocks.
+        const double offset = static_cast<double>(t - whistle.start);
+        const double time = offset / sampleRate;
+        double phase = 2.0 * pi * whistle.frequency * time;
+        if (whistle.vibratoRate > 0.0)
+        {
+          phase -= whistle.vibratoDepth / whistle.vibratoRate
+            * (std::cos(2.0 * pi * whistle.vibratoRate * time + whistle.vibratoPhase) - std::cos(whistle.vibratoPhase));
+        }
+        const double envelope = std::min({ 1.0, (offset + 1.0) / rampLength, (whistle.length - offset) / rampLength });
+        double value = 0.0;
+        double amplitude = whistle.amplitude;
+        for (unsigned int h = 1; h <= harmonics && h * (whistle.frequency + whistle.vibratoDepth) < nyquist; h++)
+        {
+          value += amplitude * std::sin(h * phase);
+          amplitude *= harmonicDecay;
+        }
+        tone[static_cast<std::size_t>(t - blockStart)] = static_cast<float>(envelope * value);
+      }
+      for (std::uint64_t t = begin; t < end; t++)
+      {
+        float* frame = block.data() + static_cast<std::size_t>(t - blockStart) * channels;
+        for (unsigned int c = 0; c < channels; c++)
+        {
+          frame[c] += gains[c] * tone[static_cast<std::size_t>(t - blockStart)];
+        }
+      }
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(frames) * channels; i++)
+    {
+      block[i] = std::min(std::max(block[i], -clip), clip);
+    }
+    if (sf_writef_float(f, block.data(), frames) != frames)
+    {
+      sf_close(f);
+      throw std::runtime_error("Could not write samples to audio file!");
+    }
+  }
+  sf_close(f);
+}
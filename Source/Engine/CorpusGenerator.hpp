@@ -0,0 +1,119 @@
+/**
+ * @file CorpusGenerator.hpp declares the CorpusGenerator class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <QString>
+
+#include "Engine/WhistleLabel.hpp"
+
+
+class QJsonObject;
+
+/**
+ * @class CorpusGenerator synthesizes a sample database of labeled whistles in noise
+ *
+ * The corpus is described by a JSON object of the form
+ * { "output": directory, "files": n, "duration": s, "channels": n, "sampleRate": Hz, "seed": s,
+ *   "whistles": { "perMinute": n, "frequency": [min, max], "duration": [min, max], "amplitude": [min, max],
+ *                 "harmonics": n, "harmonicDecay": f, "vibratoRate": [min, max], "vibratoDepth": [min, max] },
+ *   "noiseLevel": rms, "clipLevel": level }.
+ * Each file is synthesized block by block from its own random generator, so that the files are the same for the same
+ * seed regardless of the number of threads and the memory does not grow with the duration. The database labels every
+ * whistle exactly and all channels are marked as completely labeled.
+ */
+class CorpusGenerator final
+{
+public:
+  /**
+   * @brief read deserializes the corpus specification
+   * @param object the JSON object from which the specification is deserialized
+   * @param fileName the name of the file from which the specification is deserialized (relative paths refer to its directory)
+   */
+  void read(const QJsonObject& object, const QString& fileName);
+  /**
+   * @brief readFromFile reads a corpus specification from a file
+   * @param fileName the name of the file
+   */
+  void readFromFile(const QString& fileName);
+  /**
+   * @brief run synthesizes all files and writes the sample database
+   */
+  void run() const;
+  /// the directory to which the files and the database are written
+  QString outputDirectory;
+  /// the number of files
+  unsigned int files = 1;
+  /// the duration of each file in seconds
+  double duration = 60.0;
+  /// the number of channels per file
+  unsigned int channels = 1;
+  /// the sample rate of the files
+  unsigned int sampleRate = 44100;
+  /// the seed from which all files are drawn
+  std::uint64_t seed = 0;
+  /// the average number of whistles per minute
+  double whistlesPerMinute = 6.0;
+  /// the minimum of the fundamental frequency of whistles in Hz
+  double minFrequency = 2000.0;
+  /// the maximum of the fundamental frequency of whistles in Hz
+  double maxFrequency = 4000.0;
+  /// the minimum of the duration of whistles in seconds
+  double minWhistleDuration = 0.3;
+  /// the maximum of the duration of whistles in seconds
+  double maxWhistleDuration = 1.5;
+  /// the minimum of the amplitude of the fundamental of whistles
+  double minAmplitude = 0.05;
+  /// the maximum of the amplitude of the fundamental of whistles
+  double maxAmplitude = 0.5;
+  /// the number of harmonics including the fundamental
+  unsigned int harmonics = 3;
+  /// the factor by which the amplitude decreases from one harmonic to the next
+  double harmonicDecay = 0.3;
+  /// the minimum of the vibrato rate in Hz
+  double minVibratoRate = 0.0;
+  /// the maximum of the vibrato rate in Hz
+  double maxVibratoRate = 8.0;
+  /// the minimum of the vibrato depth in Hz
+  double minVibratoDepth = 0.0;
+  /// the maximum of the vibrato depth in Hz
+  double maxVibratoDepth = 100.0;
+  /// the RMS of the white background noise
+  double noiseLevel = 0.01;
+  /// the absolute value at which the samples are clipped (at most 1)
+  double clipLevel = 1.0;
+private:
+  /**
+   * @struct Whistle is a synthesized whistle
+   */
+  struct Whistle
+  {
+    /// the first sample of the whistle
+    unsigned int start;
+    /// the number of samples of the whistle
+    unsigned int length;
+    /// the center of the fundamental frequency in Hz
+    double frequency;
+    /// the amplitude of the fundamental
+    double amplitude;
+    /// the vibrato rate in Hz
+    double vibratoRate;
+    /// the vibrato depth in Hz
+    double vibratoDepth;
+    /// the phase of the vibrato at the start of the whistle
+    double vibratoPhase;
+  };
+  /**
+   * @brief generateFile synthesizes a file and writes it
+   * @param index the index of the file in the corpus
+   * @param fileName the name of the file
+   * @param labels is filled with the labels of the whistles in the file
+   */
+  void generateFile(unsigned int index, const QString& fileName, std::vector<WhistleLabel>& labels) const;
+  /// the number of frames that are synthesized at once
+  static constexpr unsigned int blockSize = 4096;
+};
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <QMetaType>
 
 
@@ -17,6 +20,24 @@ public:
    * @brief EvaluationResults initializes members
    */
   EvaluationResults();
+  /**
+   * @struct ThresholdPoint contains the results that would have been achieved if the scores had been thresholded
+   */
+  struct ThresholdPoint
+  {
+    /// the threshold above (or at) which a scored frame is considered to be a detection
+    float threshold = 0.f;
+    /// the fraction of scored frames inside labeled whistles that reach the threshold
+    float truePositiveRate = 0.f;
+    /// the fraction of scored frames outside of labeled whistles that reach the threshold (only in completely labeled channels)
+    float falsePositiveRate = 0.f;
+    /// the number of labeled whistles that contain at least one frame that reaches the threshold
+    unsigned int truePositives = 0;
+    /// the number of frames reaching the threshold outside of labeled whistles (at most one per second)
+    unsigned int falsePositives = 0;
+    /// the average delay from begin of the label to the first frame that reaches the threshold
+    float averageDelay = 0.f;
+  };
   /// the number of labeled whistles
   unsigned int positives = 0;
   /// the number of labeled whistles that have been hit
@@ -35,6 +56,18 @@ public:
   float minimumExecutionTimePerTime = 0.f;
   /// the average execution time that is needed to process 1s of audio data
   float averageExecutionTimePerTime = 0.f;
+  /// the average execution time that is needed to process 1s of audio data of a single channel (less if channels are processed together)
+  float averageExecutionTimePerChannel = 0.f;
+  /// the results for a range of thresholds on the scores (ascending thresholds, empty if the detector does not emit scores)
+  std::vector<ThresholdPoint> thresholdCurve;
+  /// the area under the frame level ROC curve (only valid if the threshold curve is not empty)
+  float rocArea = 0.f;
+  /// the number of buffers after the warm-up whose allocations have been counted (0 if allocation tracking is not compiled in)
+  std::uint64_t allocationTrackedBuffers = 0;
+  /// the number of allocations by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocations = 0;
+  /// the number of bytes allocated by the detector during the tracked buffers
+  std::uint64_t steadyStateAllocatedBytes = 0;
 };
 
 Q_DECLARE_METATYPE(EvaluationResults)
@@ -0,0 +1,227 @@
+/**
+ * @file NoiseAugmentation.cpp implements methods of the NoiseAugmentation class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Detector/EvaluationHandle.hpp"
+#include "Detector/EvaluationScorer.hpp"
+#include "Detector/Hasher.hpp"
+#include "Detector/WhistleDetectorBase.hpp"
+#include "Engine/SampleDatabase.hpp"
+
+#include "NoiseAugmentation.hpp"
+
+
+namespace
+{
+  /// the number of samples whose squares are summed in single precision before they are added to the total
+  constexpr std::size_t powerBlockSize = 4096;
+
+  /**
+   * @brief computePower computes the mean power of samples
+   * @param samples the samples
+   * @param count the number of samples
+   * @return the mean of the squared samples (0 if there are no samples)
+   */
+  double computePower(const float* samples, const std::size_t count)
+  {
+    double energy = 0.0;
+    for (std::size_t start = 0; start < count; start += powerBlockSize)
+    {
+      const std::size_t end = std::min(start + powerBlockSize, count);
+      std::size_t i = start;
+      float blockEnergy = 0.f;
+#ifdef __SSE2__
+      __m128 e = _mm_setzero_ps();
+      for (; i + 4 <= end; i += 4)
+      {
+        const __m128 x = _mm_loadu_ps(samples + i);
+        e = _mm_add_ps(e, _mm_mul_ps(x, x));
+      }
+      alignas(16) float lanes[4];
+      _mm_store_ps(lanes, e);
+      blockEnergy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+      for (; i < end; i++)
+      {
+        blockEnergy += samples[i] * samples[i];
+      }
+      energy += blockEnergy;
+    }
+    return count > 0 ? energy / static_cast<double>(count) : 0.0;
+  }
+}
+
+void NoiseAugmentation::read(const QJsonObject& object, const QString& fileName)
+{
+  QFileInfo fileInfo(fileName);
+  snrs.clear();
+  const QJsonArray snrArray = object["snrs"].toArray();
+  for (int i = 0; i < snrArray.size(); i++)
+  {
+    snrs.push_back(static_cast<float>(snrArray[i].toDouble()));
+  }
+  if (snrs.empty())
+  {
+    throw std::runtime_error("The noise augmentation does not specify any SNRs!");
+  }
+  copies = static_cast<unsigned int>(std::max(object["copies"].toInt(1), 1));
+  seed = static_cast<unsigned int>(object["seed"].toInt(0));
+
+  SampleDatabase noiseDatabase;
+  noiseDatabase.readFromFile(fileInfo.absoluteDir().absoluteFilePath(object["noise"].toString()));
+  noises.clear();
+  Hasher hasher;
+  hasher.add(seed);
+  hasher.add(copies);
+  for (const float snr : snrs)
+  {
+    hasher.add(snr);
+  }
+  for (auto& file : noiseDatabase.audioFiles)
+  {
+    file.decode();
+    const auto& samples = file.channels[0].samples;
+    const double power = computePower(samples.data(), static_cast<std::size_t>(samples.size()));
+    if (power <= 0.0)
+    {
+      std::cerr << "The noise recording " << file.path.toStdString() << " is silent!\n";
+      continue;
+    }
+    noises.push_back({ file.sampleRate, std::vector<float>(samples.begin(), samples.end()), power });
+    hasher.add(file.sampleRate);
+    hasher.add(static_cast<std::uint64_t>(samples.size()));
+    hasher.add(samples.data(), static_cast<std::size_t>(samples.size()) * sizeof(float));
+  }
+  if (noises.empty())
+  {
+    throw std::runtime_error("The noise augmentation does not contain any noise recordings!");
+  }
+  key = hasher.hash;
+}
+
+void NoiseAugmentation::readFromFile(const QString& fileName)
+{
+  QFile inFile(fileName);
+  if (!inFile.open(QIODevice::ReadOnly))
+  {
+    throw std::runtime_error("Could not open noise augmentation file for reading!");
+  }
+  QByteArray fileContent = inFile.readAll();
+  QJsonDocument doc = QJsonDocument::fromJson(fileContent);
+  read(doc.object(), fileName);
+}
+
+bool NoiseAugmentation::getMix(const AudioFile& file, const unsigned int fileIndex, const float snr, const unsigned int copy, NoiseMix& mix) const
+{
+  std::vector<const Noise*> candidates;
+  for (const auto& noise : noises)
+  {
+    if (noise.sampleRate == file.sampleRate)
+    {
+      candidates.push_back(&noise);
+    }
+  }
+  const auto& samples = file.channels[0].samples;
+  const double power = computePower(samples.data(), static_cast<std::size_t>(samples.size()));
+  if (candidates.empty() || power <= 0.0)
+  {
+    return false;
+  }
+  // The generator is seeded per copy, so that the noise does not depend on the order in which copies are drawn.
+  Hasher hasher;
+  hasher.add(seed);
+  hasher.add(fileIndex);
+  hasher.add(snr);
+  hasher.add(copy);
+  std::mt19937_64 generator(hasher.hash);
+  const Noise& noise = *candidates[std::uniform_int_distribution<std::size_t>(0, candidates.size() - 1)(generator)];
+  mix.noise = noise.samples.data();
+  mix.noiseLength = noise.samples.size();
+  mix.offset = std::uniform_int_distribution<std::size_t>(0, noise.samples.size() - 1)(generator);
+  mix.gain = static_cast<float>(std::sqrt(power / (noise.power * std::pow(10.0, snr / 10.0))));
+  return true;
+}
+
+void NoiseAugmentation::augment(WhistleDetectorBase& detector, const SampleDatabase& db, const std::function<void(unsigned int)>& beginFile) const
+{
+  unsigned int noisyCopies = 0;
+  for (int i = 0; i < db.audioFiles.size(); i++)
+  {
+    const AudioFile& file = db.audioFiles[i];
+    if (beginFile)
+    {
+      beginFile(static_cast<unsigned int>(i));
+    }
+    for (const float snr : snrs)
+    {
+      for (unsigned int copy = 0; copy < copies; copy++)
+      {
+        NoiseMix mix;
+        if (getMix(file, static_cast<unsigned int>(i), snr, copy, mix))
+        {
+          EvaluationHandle eh(file, &mix);
+          detector.evaluate(eh);
+          noisyCopies++;
+        }
+      }
+    }
+  }
+  std::cout << "Processed " << noisyCopies << " noisy copies of " << db.audioFiles.size() << " files.\n";
+}
+
+std::vector<EvaluationResults> NoiseAugmentation::evaluate(WhistleDetectorBase& detector, const SampleDatabase& db) const
+{
+  std::vector<EvaluationResults> results(snrs.size());
+  unsigned int filesWithoutNoise = 0;
+  for (std::size_t s = 0; s < snrs.size(); s++)
+  {
+    EvaluationScorer scorer(results[s], false);
+    filesWithoutNoise = 0;
+    for (int i = 0; i < db.audioFiles.size(); i++)
+    {
+      const AudioFile& file = db.audioFiles[i];
+      NoiseMix mix;
+      const bool noisy = getMix(file, static_cast<unsigned int>(i), snrs[s], 0, mix);
+      // Files without a matching noise recording are evaluated unchanged, so that all SNRs cover the same labels.
+      EvaluationHandle eh(file, noisy ? &mix : nullptr);
+      detector.evaluate(eh);
+      scorer.add(file, eh.getOutput());
+      filesWithoutNoise += noisy ? 0 : 1;
+    }
+    scorer.finish();
+  }
+
+  std::cout << "\nSNR [dB]  Recall  False positives  ROC area\n" << std::fixed;
+  for (std::size_t s = 0; s < snrs.size(); s++)
+  {
+    const EvaluationResults& r = results[s];
+    const float recall = r.positives > 0 ? static_cast<float>(r.truePositives) / static_cast<float>(r.positives) : 0.f;
+    std::cout << std::setw(8) << std::setprecision(1) << snrs[s] << "  " << std::setw(6) << std::setprecision(3) << recall
+              << "  " << std::setw(15) << r.falsePositives << "  " << std::setw(8) << r.rocArea << '\n';
+  }
+  std::cout << std::defaultfloat << std::setprecision(6);
+  if (filesWithoutNoise > 0)
+  {
+    std::cout << filesWithoutNoise << " files have been evaluated without noise because there is no noise recording with their sample rate.\n";
+  }
+  return results;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file NoiseAugmentation.hpp declares the NoiseAugmentation class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <QString>
+
+#include "Detector/NoiseMix.hpp"
+#include "Engine/EvaluationResults.hpp"
+
+
+class AudioFile;
+class QJsonObject;
+class SampleDatabase;
+class WhistleDetectorBase;
+
+/**
+ * @class NoiseAugmentation adds noise recordings to the files of a sample database at several signal-to-noise ratios
+ *
+ * The augmentation is described by a JSON object of the form
+ * { "noise": database, "snrs": [dB], "copies": n, "seed": s }.
+ * The noise recordings (e.g. robot fans, crowds or other whistles) are the first channels of the files of a sample
+ * database. For each file, SNR and copy, a recording with the sample rate of the file and an offset into it are drawn
+ * and the recording is scaled such that the ratio of the mean power of the first channel of the file to the mean power
+ * of the noise is the SNR. The noise is added while the detector reads the file, so that noisy files are never stored.
+ */
+class NoiseAugmentation final
+{
+public:
+  /**
+   * @brief read deserializes the augmentation and loads the noise recordings
+   * @param object the JSON object from which the augmentation is deserialized
+   * @param fileName the name of the file from which the augmentation is deserialized (relative paths refer to its directory)
+   */
+  void read(const QJsonObject& object, const QString& fileName);
+  /**
+   * @brief readFromFile reads an augmentation from a file
+   * @param fileName the name of the file
+   */
+  void readFromFile(const QString& fileName);
+  /**
+   * @brief getMix draws the noise for a noisy copy of a file (the same arguments always yield the same noise)
+   * @param file the file to which the noise is added
+   * @param fileIndex the index of the file in its database
+   * @param snr the signal-to-noise ratio in dB
+   * @param copy the index of the noisy copy
+   * @param mix is filled with the noise
+   * @return whether there is a noise recording with the sample rate of the file (and the file is not silent)
+   */
+  bool getMix(const AudioFile& file, unsigned int fileIndex, float snr, unsigned int copy, NoiseMix& mix) const;
+  /**
+   * @brief augment lets a detector process the noisy copies of all files of a database at all SNRs (e.g. during training)
+   * @param detector the detector that processes the files
+   * @param db the database whose files are processed
+   * @param beginFile is called with the index of each file in the database before its noisy copies are processed (may be empty)
+   */
+  void augment(WhistleDetectorBase& detector, const SampleDatabase& db, const std::function<void(unsigned int)>& beginFile = nullptr) const;
+  /**
+   * @brief evaluate evaluates a detector on a noisy copy of a database at each SNR and prints a table of the results
+   * @param detector the detector that is evaluated
+   * @param db the database on which the detector is evaluated
+   * @return the results of the evaluation at each SNR
+   */
+  std::vector<EvaluationResults> evaluate(WhistleDetectorBase& detector, const SampleDatabase& db) const;
+  /// the signal-to-noise ratios in dB
+  std::vector<float> snrs;
+  /// the number of noisy copies of each file per SNR that augment processes
+  unsigned int copies = 1;
+  /// the seed from which the noise of each copy is drawn
+  unsigned int seed = 0;
+  /// a hash of the augmentation including the noise recordings (e.g. for keys of caches)
+  std::uint64_t key = 0;
+private:
+  /**
+   * @struct Noise is a noise recording
+   */
+  struct Noise
+  {
+    /// the sample rate of the recording
+    unsigned int sampleRate;
+    /// the samples of the recording
+    std::vector<float> samples;
+    /// the mean power of the samples
+    double power;
+  };
+  /// the noise recordings
+  std::vector<Noise> noises;
+};
@@ -0,0 +1,185 @@
+/**
+ * @file ParameterSweep.cpp implements methods of the ParameterSweep class
+ */
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Detector/WhistleDetectorBase.hpp"
+#include "Detector/WhistleDetectorFactoryBase.hpp"
+#include "Engine/SampleDatabase.hpp"
+#include "Engine/WorkerPool.hpp"
+
+#include "ParameterSweep.hpp"
+
+
+void ParameterSweep::read(const QJsonObject& object, const QString& fileName)
+{
+  QFileInfo fileInfo(fileName);
+  detector = object["detector"].toString();
+  if (detector.isEmpty())
+  {
+    throw std::runtime_error("The parameter sweep does not specify a detector!");
+  }
+  if (object.contains("output"))
+  {
+    outputFileName = fileInfo.absoluteDir().absoluteFilePath(object["output"].toString());
+  }
+  else
+  {
+    outputFileName = fileInfo.absoluteDir().absoluteFilePath(fileInfo.completeBaseName() + ".csv");
+  }
+
+  // 1. Build the cartesian product of all grid values.
+  configurations.assign(1, ParameterMap());
+  const QJsonObject grid = object["grid"].toObject();
+  for (const QString& name : grid.keys())
+  {
+    const QJsonArray values = grid[name].toArray();
+    if (values.isEmpty())
+    {
+      throw std::runtime_error("Grid parameter " + name.toStdString() + " does not have any values!");
+    }
+    std::vector<ParameterMap> product;
+    product.reserve(configurations.size() * static_cast<unsigned int>(values.size()));
+    for (const auto& configuration : configurations)
+    {
+      for (int i = 0; i < values.size(); i++)
+      {
+        product.push_back(configuration);
+        product.back()[name.toStdString()] = values[i].toDouble();
+      }
+    }
+    configurations.swap(product);
+  }
+
+  // 2. Combine each grid point with the random samples.
+  const QJsonObject random = object["random"].toObject();
+  const int samples = random["samples"].toInt(0);
+  const QJsonObject ranges = random["ranges"].toObject();
+  if (samples <= 0 || ranges.isEmpty())
+  {
+    return;
+  }
+  std::mt19937 generator(static_cast<std::mt19937::result_type>(random["seed"].toInt(0)));
+  std::vector<ParameterMap> sampled;
+  sampled.reserve(configurations.size() * static_cast<unsigned int>(samples));
+  for (const auto& configuration : configurations)
+  {
+    for (int i = 0; i < samples; i++)
+    {
+      sampled.push_back(configuration);
+      for (const QString& name : ranges.keys())
+      {
+        const QJsonArray range = ranges[name].toArray();
+        if (range.size() != 2 || range[0].toDouble() > range[1].toDouble())
+        {
+          throw std::runtime_error("Random parameter " + name.toStdString() + " needs a range [min, max]!");
+        }
+        const double min = range[0].toDouble();
+        const double max = range[1].toDouble();
+        double value;
+        if (std::floor(min) == min && std::floor(max) == max)
+        {
+          value = static_cast<double>(std::uniform_int_distribution<long long>(static_cast<long long>(min), static_cast<long long>(max))(generator));
+        }
+        else
+        {
+          value = std::uniform_real_distribution<double>(min, max)(generator);
+        }
+        sampled.back()[name.toStdString()] = value;
+      }
+    }
+  }
+  configurations.swap(sampled);
+}
+
+void ParameterSweep::readFromFile(const QString& fileName)
+{
+  QFile inFile(fileName);
+  if (!inFile.open(QIODevice::ReadOnly))
+  {
+    throw std::runtime_error("Could not open parameter sweep file for reading!");
+  }
+  QByteArray fileContent = inFile.readAll();
+  QJsonDocument doc = QJsonDocument::fromJson(fileContent);
+  read(doc.object(), fileName);
+}
+
+void ParameterSweep::run(const SampleDatabase& db)
+{
+  const std::string detectorName = detector.toStdString();
+  results.assign(configurations.size(), EvaluationResults());
+  // Detectors are constructed one at a time because some of them load files in their constructors (and FANN
+  // changes the locale while doing so).
+  std::mutex constructionMutex;
+  WorkerPool pool;
+  std::cout << "Sweeping " << configurations.size() << " configurations of " << detectorName << " on "
+            << pool.getNumberOfThreads() << " threads...\n";
+  pool.run(static_cast<unsigned int>(configurations.size()), [&](const unsigned int i)
+  {
+    std::shared_ptr<WhistleDetectorBase> instance;
+    {
+      std::lock_guard<std::mutex> lock(constructionMutex);
+      instance = WhistleDetectorFactoryBase::make(detectorName, configurations[i]);
+    }
+    instance->evaluateOnDatabase(db, &results[i], false);
+  });
+  writeResults();
+}
+
+void ParameterSweep::writeResults() const
+{
+  std::ofstream csv(outputFileName.toStdString());
+  if (!csv.is_open())
+  {
+    throw std::runtime_error("Could not open parameter sweep results file for writing!");
+  }
+  std::set<std::string> names;
+  for (const auto& configuration : configurations)
+  {
+    for (const auto& parameter : configuration)
+    {
+      names.insert(parameter.first);
+    }
+  }
+  for (const auto& name : names)
+  {
+    csv << name << ',';
+  }
+  csv << "positives,truePositives,falsePositives,minimumDelay,averageDelay,maximumDelay,"
+      << "minimumExecutionTimePerTime,averageExecutionTimePerTime,maximumExecutionTimePerTime,rocArea\n";
+  for (unsigned int i = 0; i < configurations.size(); i++)
+  {
+    for (const auto& name : names)
+    {
+      auto it = configurations[i].find(name);
+      if (it != configurations[i].end())
+      {
+        csv << it->second;
+      }
+      csv << ',';
+    }
+    const EvaluationResults& r = results[i];
+    csv << r.positives << ',' << r.truePositives << ',' << r.falsePositives << ','
+        << r.minimumDelay << ',' << r.averageDelay << ',' << r.maximumDelay << ','
+        << r.minimumExecutionTimePerTime << ',' << r.averageExecutionTimePerTime << ',' << r.maximumExecutionTimePerTime << ','
+        << (r.thresholdCurve.empty() ? 0.f : r.rocArea) << '\n';
+  }
+  csv.close();
+}
@@ -0,0 +1,58 @@
+/**
+ * @file ParameterSweep.hpp declares the ParameterSweep class
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QString>
+
+#include "Detector/DetectorParameters.hpp"
+#include "Engine/EvaluationResults.hpp"
+
+
+class QJsonObject;
+class SampleDatabase;
+
+/**
+ * @class ParameterSweep evaluates a detector with many parameter configurations in parallel
+ *
+ * The configurations are described by a JSON object of the form
+ * { "detector": name, "grid": { parameter: [values] }, "random": { "samples": n, "seed": s, "ranges": { parameter: [min, max] } }, "output": file }.
+ * Every combination of grid values is combined with every random sample. Ranges whose bounds are both integers are
+ * sampled as integers. The results are written as a CSV table with one row per configuration.
+ */
+class ParameterSweep final
+{
+public:
+  /**
+   * @brief read deserializes the sweep specification
+   * @param object the JSON object from which the specification is deserialized
+   * @param fileName the name of the file from which the specification is deserialized (relative output paths refer to its directory)
+   */
+  void read(const QJsonObject& object, const QString& fileName);
+  /**
+   * @brief readFromFile reads a sweep specification from a file
+   * @param fileName the name of the file
+   */
+  void readFromFile(const QString& fileName);
+  /**
+   * @brief run evaluates all configurations on a database and writes the results to the output file
+   * @param db the database on which the detector is evaluated
+   */
+  void run(const SampleDatabase& db);
+  /// the name of the detector that is evaluated
+  QString detector;
+  /// the name of the file to which the results are written
+  QString outputFileName;
+  /// the parameter configurations that are evaluated
+  std::vector<ParameterMap> configurations;
+  /// the results of the evaluation (one per configuration, only valid after run)
+  std::vector<EvaluationResults> results;
+private:
+  /**
+   * @brief writeResults writes the configurations and their results as CSV table
+   */
+  void writeResults() const;
+};
@@ -0,0 +1,229 @@
+/**
+ * @file Prelabeler.cpp implements methods of the Prelabeler class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "Detector/BandLimitedSpectrum.hpp"
+#include "Detector/EvaluationHandle.hpp"
+#include "Detector/WhistleDetectorBase.hpp"
+#include "Detector/WhistleDetectorFactoryBase.hpp"
+#include "Engine/SampleDatabase.hpp"
+#include "Engine/WorkerPool.hpp"
+
+#include "Prelabeler.hpp"
+
+
+constexpr unsigned int Prelabeler::frameSize;
+constexpr unsigned int Prelabeler::frameHopSize;
+
+QVector<WhistleProposal> Prelabeler::run(const SampleDatabase& db) const
+{
+  struct Task
+  {
+    const AudioFile* file;
+    const AudioChannel* channel;
+    std::vector<WhistleLabel> labels;
+  };
+  std::vector<Task> tasks;
+  for (const auto& file : db.audioFiles)
+  {
+    for (const auto& channel : file.channels)
+    {
+      if (!channel.completelyLabeled)
+      {
+        tasks.push_back({ &file, &channel, {} });
+      }
+    }
+  }
+  WorkerPool pool;
+  std::cout << "Pre-labeling " << tasks.size() << " channels with " << detector << " on "
+            << pool.getNumberOfThreads() << " threads...\n";
+  // Detectors are constructed in advance (one per thread) because some of them load files in their constructors.
+  // Each task borrows one of them for the time it runs.
+  std::vector<std::shared_ptr<WhistleDetectorBase>> idleDetectors;
+  for (unsigned int i = 0; i < std::min<std::size_t>(pool.getNumberOfThreads(), tasks.size()); i++)
+  {
+    idleDetectors.push_back(WhistleDetectorFactoryBase::make(detector));
+  }
+  std::mutex idleMutex;
+  pool.run(static_cast<unsigned int>(tasks.size()), [&](const unsigned int i)
+  {
+    std::shared_ptr<WhistleDetectorBase> instance;
+    {
+      std::lock_guard<std::mutex> lock(idleMutex);
+      instance = idleDetectors.back();
+      idleDetectors.pop_back();
+    }
+    Task& task = tasks[i];
+    AudioFile file;
+    file.path = task.file->path;
+    file.numberOfChannels = 1;
+    file.sampleRate = task.file->sampleRate;
+    file.channels.append(*task.channel);
+    EvaluationHandle eh(file);
+    instance->evaluate(eh);
+    task.labels = propose(*task.channel, file.sampleRate, eh.getOutput().detections);
+    std::lock_guard<std::mutex> lock(idleMutex);
+    idleDetectors.push_back(instance);
+  });
+  QVector<WhistleProposal> proposals;
+  for (const auto& task : tasks)
+  {
+    for (const auto& label : task.labels)
+    {
+      WhistleProposal proposal;
+      proposal.fileId = task.file->id;
+      proposal.path = task.file->path;
+      proposal.sampleRate = task.file->sampleRate;
+      proposal.channel = task.channel->channel;
+      proposal.label = label;
+      proposals.append(proposal);
+    }
+  }
+  std::cout << "Proposed " << proposals.size() << " whistles.\n";
+  return proposals;
+}
+
+std::vector<WhistleLabel> Prelabeler::propose(const AudioChannel& channel, const unsigned int sampleRate,
+                                              std::vector<unsigned int> detections) const
+{
+  std::vector<WhistleLabel> result;
+  const int size = channel.samples.size();
+  if (detections.empty() || sampleRate == 0)
+  {
+    return result;
+  }
+  std::sort(detections.begin(), detections.end());
+
+  // Detections that are close to each other are merged into the core of a whistle.
+  const unsigned int maxGap = static_cast<unsigned int>(mergeGap * sampleRate);
+  WhistleLabel core;
+  unsigned int count = 0;
+  for (std::size_t i = 0; i < detections.size(); i++)
+  {
+    if (count > 0 && detections[i] - detections[i - 1] > maxGap)
+    {
+      if (count >= minDetections)
+      {
+        result.push_back(core);
+      }
+      count = 0;
+    }
+    if (count == 0)
+    {
+      core.start = static_cast<int>(std::min(detections[i], static_cast<unsigned int>(size)));
+    }
+    core.end = static_cast<int>(std::min(detections[i] + 1, static_cast<unsigned int>(size)));
+    count++;
+  }
+  if (count >= minDetections)
+  {
+    result.push_back(core);
+  }
+  if (size < static_cast<int>(frameSize))
+  {
+    return result;
+  }
+
+  // The boundaries are placed where the band power crosses a threshold relative to the peak inside the core.
+  BandLimitedSpectrum spectrum(frameSize, true);
+  const unsigned int minBin = std::min(static_cast<unsigned int>(std::ceil(minFrequency * frameSize / sampleRate)), frameSize / 2);
+  const unsigned int maxBin = std::min(static_cast<unsigned int>(maxFrequency * frameSize / sampleRate) + 1, frameSize / 2 + 1);
+  const int radius = static_cast<int>(searchRadius * sampleRate);
+  const double relativeThreshold = std::pow(10.0, boundaryLevel / 10.0);
+  std::vector<double> powers;
+  for (auto& label : result)
+  {
+    // Frame k starts at first + k * frameHopSize.
+    const int first = std::max(label.start - radius, 0);
+    const int last = std::min(label.end + radius, size) - static_cast<int>(frameSize);
+    if (last < first)
+    {
+      continue;
+    }
+    powers.clear();
+    for (int pos = first; pos <= last; pos += frameHopSize)
+    {
+      spectrum.analyze(channel.samples.constData() + pos);
+      powers.push_back(spectrum.bandPower(minBin, std::max(minBin, maxBin)));
+    }
+    const auto frameStart = [&](const std::size_t k){ return first + static_cast<int>(k * frameHopSize); };
+    // These are the first and last frames that overlap with the core.
+    std::size_t startFrame = 0;
+    while (startFrame + 1 < powers.size() && frameStart(startFrame) + static_cast<int>(frameSize) <= label.start)
+    {
+      startFrame++;
+    }
+    std::size_t endFrame = startFrame;
+    while (endFrame + 1 < powers.size() && frameStart(endFrame + 1) < label.end)
+    {
+      endFrame++;
+    }
+    const std::size_t peakFrame = static_cast<std::size_t>(
+      std::max_element(powers.begin() + static_cast<std::ptrdiff_t>(startFrame), powers.begin() + static_cast<std::ptrdiff_t>(endFrame) + 1) - powers.begin());
+    if (powers[peakFrame] <= 0)
+    {
+      continue;
+    }
+    const double threshold = powers[peakFrame] * relativeThreshold;
+    // A boundary moves outwards while the band power stays above the threshold and inwards (but not beyond the peak)
+    // while it is below.
+    if (powers[startFrame] >= threshold)
+    {
+      while (startFrame > 0 && powers[startFrame - 1] >= threshold)
+      {
+        startFrame--;
+      }
+    }
+    else
+    {
+      while (startFrame < peakFrame && powers[startFrame] < threshold)
+      {
+        startFrame++;
+      }
+    }
+    if (powers[endFrame] >= threshold)
+    {
+      while (endFrame + 1 < powers.size() && powers[endFrame + 1] >= threshold)
+      {
+        endFrame++;
+      }
+    }
+    else
+    {
+      while (endFrame > peakFrame && powers[endFrame] < threshold)
+      {
+        endFrame--;
+      }
+    }
+    // Each frame stands for the hop around its center.
+    label.start = frameStart(startFrame) + static_cast<int>((frameSize - frameHopSize) / 2);
+    label.end = std::min(frameStart(endFrame) + static_cast<int>((frameSize + frameHopSize) / 2), size);
+  }
+
+  // Refinement may have made proposals overlap, and whistles that are already labeled are not proposed again.
+  std::sort(result.begin(), result.end(), [](const WhistleLabel& a, const WhistleLabel& b){ return a.start < b.start; });
+  std::vector<WhistleLabel> merged;
+  for (const auto& label : result)
+  {
+    if (!merged.empty() && label.start <= merged.back().end)
+    {
+      merged.back().end = std::max(merged.back().end, label.end);
+    }
+    else
+    {
+      merged.push_back(label);
+    }
+  }
+  merged.erase(std::remove_if(merged.begin(), merged.end(), [&](const WhistleLabel& label)
+  {
+    return std::any_of(channel.whistleLabels.begin(), channel.whistleLabels.end(),
+      [&](const WhistleLabel& existing){ return label.start < existing.end && existing.start < label.end; });
+  }), merged.end());
+  return merged;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file Prelabeler.hpp declares the Prelabeler class
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+#include "WhistleLabel.hpp"
+
+
+class AudioChannel;
+class SampleDatabase;
+
+/**
+ * @struct WhistleProposal is a whistle label that has been proposed for a channel but not yet accepted
+ */
+struct WhistleProposal
+{
+  /// the id of the file in its sample database
+  unsigned int fileId = 0;
+  /// the path of the file
+  QString path;
+  /// the sample rate of the file
+  unsigned int sampleRate = 0;
+  /// the channel number of the channel in the file
+  unsigned int channel = 0;
+  /// the proposed interval
+  WhistleLabel label;
+};
+
+Q_DECLARE_METATYPE(WhistleProposal)
+
+/**
+ * @class Prelabeler proposes whistle labels for all channels that are not completely labeled
+ *
+ * A detector is run on the channels in parallel. Its detections are merged into intervals whose boundaries are then
+ * moved to where the power in the whistle band falls below a fraction of its peak inside the interval. Proposals that
+ * overlap with an existing label are dropped.
+ */
+class Prelabeler final
+{
+public:
+  /**
+   * @brief run proposes whistle labels
+   * @param db the database whose channels are labeled
+   * @return the proposals, ordered by file, channel and start
+   */
+  QVector<WhistleProposal> run(const SampleDatabase& db) const;
+  /// the name of the detector that finds the whistles
+  std::string detector;
+  /// the maximum time between two detections of the same whistle (in seconds)
+  double mergeGap = 0.5;
+  /// the minimum number of detections of a whistle
+  unsigned int minDetections = 1;
+  /// the lowest frequency of the band in which whistles are expected (in Hz)
+  double minFrequency = 2000;
+  /// the highest frequency of the band in which whistles are expected (in Hz)
+  double maxFrequency = 4000;
+  /// the maximum distance by which a boundary is moved outwards during refinement (in seconds)
+  double searchRadius = 0.5;
+  /// the band power relative to the peak of a whistle at which its boundaries are placed (in dB)
+  double boundaryLevel = -20;
+private:
+  /**
+   * @brief propose merges and refines the detections in a channel
+   * @param channel the channel
+   * @param sampleRate the sample rate of the channel
+   * @param detections the positions of the detections in the channel
+   * @return the proposed intervals, ordered by start
+   */
+  std::vector<WhistleLabel> propose(const AudioChannel& channel, unsigned int sampleRate, std::vector<unsigned int> detections) const;
+  /// the number of samples per frame of the refinement
+  static constexpr unsigned int frameSize = 256;
+  /// the number of samples by which consecutive frames of the refinement are apart
+  static constexpr unsigned int frameHopSize = frameSize / 2;
+};
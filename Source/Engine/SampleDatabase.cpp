@@ -12,11 +12,14 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 
+#include "Detector/Trace.hpp"
+
 #include "SampleDatabase.hpp"
 
 
 void SampleDatabase::read(const QJsonObject& object, const QString& fileName)
 {
+  TRACE_SCOPE("SampleDatabase::read");
   QFileInfo fileInfo(fileName);
   name = fileInfo.fileName();
   QJsonArray audioFileArray = object["audioFiles"].toArray();
@@ -26,6 +29,7 @@ void SampleDatabase::read(const QJsonObject& object, const QString& fileName)
     QJsonObject whistleLabelObject = audioFileArray[audioFileIndex].toObject();
     AudioFile audioFile;
     audioFile.read(whistleLabelObject, fileInfo.absoluteDir());
+    audioFile.id = nextFileId++;
     audioFiles.append(audioFile);
   }
   exists = true;
@@ -45,6 +49,7 @@ void SampleDatabase::write(QJsonObject& object) const
 
 void SampleDatabase::readFromFile(const QString& fileName)
 {
+  TRACE_SCOPE("SampleDatabase::readFromFile");
   QFile inFile(fileName);
   if (!inFile.open(QIODevice::ReadOnly))
   {
@@ -31,7 +31,7 @@ public:
    */
   void write(QJsonObject& object) const;
   /**
-   * @brief readFromFile reads a sample database from a file
+   * @brief readFromFile reads a sample database from a file (the samples of its files are decoded separately)
    * @param fileName the name of the file
    */
   void readFromFile(const QString& fileName);
@@ -50,6 +50,8 @@ public:
   QString name;
   /// a list of audio files in the database
   QList<AudioFile> audioFiles;
+  /// the id that is given to the next file that is added
+  unsigned int nextFileId = 1;
 };
 
 Q_DECLARE_METATYPE(SampleDatabase)
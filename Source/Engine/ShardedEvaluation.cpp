@@ -0,0 +1,296 @@
+/**
+ * @file ShardedEvaluation.cpp implements methods of the ShardedEvaluation class
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+
+#include "Detector/EvaluationScorer.hpp"
+#include "Detector/OutputCache.hpp"
+#include "Detector/WhistleDetectorBase.hpp"
+#include "Detector/WhistleDetectorFactoryBase.hpp"
+
+#include "ShardedEvaluation.hpp"
+
+
+constexpr unsigned int ShardedEvaluation::maxAttempts;
+
+ShardedEvaluation::ShardedEvaluation(const QString& databaseFileName, const std::string& detector, const ParameterMap& parameters) :
+  databaseFileName(databaseFileName),
+  detector(detector),
+  parameters(parameters)
+{
+}
+
+ShardedEvaluation::~ShardedEvaluation()
+{
+  for (auto& worker : workers)
+  {
+    if (worker.running)
+    {
+      QObject::disconnect(worker.process.get(), nullptr, nullptr, nullptr);
+      worker.process->kill();
+      worker.process->waitForFinished();
+    }
+  }
+}
+
+bool ShardedEvaluation::run(EvaluationResults& results, const unsigned int numberOfWorkers)
+{
+  db.readFromFile(databaseFileName);
+  // An unknown detector or parameter is reported here instead of by every worker.
+  WhistleDetectorFactoryBase::make(detector, parameters);
+  const std::size_t numberOfFiles = static_cast<std::size_t>(db.audioFiles.size());
+  outputs.assign(numberOfFiles, DetectorOutput());
+  attempts.assign(numberOfFiles, 0);
+  pendingFiles.clear();
+  for (int i = 0; i < db.audioFiles.size(); i++)
+  {
+    pendingFiles.push_back(i);
+  }
+  remainingFiles = numberOfFiles;
+  failed = false;
+
+  const unsigned int numberOfProcesses = static_cast<unsigned int>(std::min<std::size_t>(std::max(numberOfWorkers, 1u), numberOfFiles));
+  std::cout << "Evaluating " << detector << " on " << numberOfFiles << " files in " << numberOfProcesses << " worker processes...\n";
+  QEventLoop eventLoop;
+  loop = &eventLoop;
+  for (unsigned int i = 0; i < numberOfProcesses; i++)
+  {
+    if (!startWorker())
+    {
+      abort();
+      break;
+    }
+  }
+  if (runningWorkers > 0)
+  {
+    eventLoop.exec();
+  }
+  loop = nullptr;
+  if (failed || remainingFiles > 0)
+  {
+    return false;
+  }
+  if (workers.size() > numberOfProcesses)
+  {
+    std::cout << "Restarted " << (workers.size() - numberOfProcesses) << " worker processes.\n";
+  }
+
+  // Scoring the outputs in the order of the database makes the results independent of the order in which they arrived.
+  EvaluationScorer scorer(results, true);
+  for (std::size_t i = 0; i < numberOfFiles; i++)
+  {
+    scorer.add(db.audioFiles[static_cast<int>(i)], outputs[i]);
+  }
+  scorer.finish();
+  return true;
+}
+
+int ShardedEvaluation::work()
+{
+  // The standard output is reserved for the records, so everything else that is printed goes to the standard error.
+  std::cout.rdbuf(std::cerr.rdbuf());
+  QFile out;
+  if (!out.open(stdout, QIODevice::WriteOnly))
+  {
+    std::cerr << "Could not open the standard output of the worker!\n";
+    return 1;
+  }
+  std::shared_ptr<WhistleDetectorBase> instance;
+  try
+  {
+    db.readFromFile(databaseFileName);
+    instance = WhistleDetectorFactoryBase::make(detector, parameters);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  std::string line;
+  while (std::getline(std::cin, line))
+  {
+    int index = -1;
+    std::istringstream(line) >> index;
+    if (index < 0 || index >= db.audioFiles.size())
+    {
+      std::cerr << "The worker has been asked for an invalid file!\n";
+      return 1;
+    }
+    AudioFile& file = db.audioFiles[index];
+    try
+    {
+      file.decode();
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << file.path.toStdString() << ": " << e.what() << '\n';
+      return 1;
+    }
+    DetectorOutput output;
+    instance->evaluateWithCache(file, output);
+    // The samples are released after each file, so that a worker never holds more than one file in memory.
+    for (auto& channel : file.channels)
+    {
+      channel.samples = QVector<float>();
+    }
+    file.decoded = false;
+    if (!OutputCache::write(out, static_cast<std::uint64_t>(index), output) || !out.flush())
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool ShardedEvaluation::parseParameter(const QString& argument, ParameterMap& parameters)
+{
+  const int separator = argument.indexOf('=');
+  if (separator <= 0)
+  {
+    return false;
+  }
+  bool ok = false;
+  const double value = argument.mid(separator + 1).toDouble(&ok);
+  if (!ok)
+  {
+    return false;
+  }
+  parameters[argument.left(separator).toStdString()] = value;
+  return true;
+}
+
+bool ShardedEvaluation::startWorker()
+{
+  workers.emplace_back();
+  Worker& worker = workers.back();
+  worker.process.reset(new QProcess);
+  worker.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  QObject::connect(worker.process.get(), &QProcess::readyReadStandardOutput, [this, &worker]
+  {
+    receive(worker);
+  });
+  QObject::connect(worker.process.get(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                   [this, &worker](int, QProcess::ExitStatus)
+  {
+    finish(worker);
+  });
+  QStringList arguments;
+  arguments << "--evaluation-worker" << databaseFileName << QString::fromStdString(detector);
+  for (const auto& parameter : parameters)
+  {
+    // All significant digits are passed, so that the workers evaluate exactly the same configuration.
+    arguments << QString::fromStdString(parameter.first) + '=' + QString::number(parameter.second, 'g', 17);
+  }
+  worker.process->start(QCoreApplication::applicationFilePath(), arguments);
+  if (!worker.process->waitForStarted())
+  {
+    std::cerr << "Could not start a worker process!\n";
+    return false;
+  }
+  worker.running = true;
+  runningWorkers++;
+  assign(worker);
+  return true;
+}
+
+void ShardedEvaluation::assign(Worker& worker)
+{
+  if (failed || pendingFiles.empty())
+  {
+    // Closing the standard input tells the worker to exit.
+    worker.file = -1;
+    worker.process->closeWriteChannel();
+    return;
+  }
+  worker.file = pendingFiles.front();
+  pendingFiles.pop_front();
+  attempts[static_cast<std::size_t>(worker.file)]++;
+  worker.process->write(QByteArray::number(worker.file).append('\n'));
+}
+
+void ShardedEvaluation::receive(Worker& worker)
+{
+  worker.buffer.append(worker.process->readAllStandardOutput());
+  while (true)
+  {
+    std::uint64_t recordSize = 0;
+    if (!OutputCache::getRecordSize(worker.buffer.constData(), static_cast<std::uint64_t>(worker.buffer.size()), recordSize)
+        || (recordSize > 0 && worker.file < 0))
+    {
+      // The file of the worker is evaluated again by another worker.
+      std::cerr << "A worker process has sent invalid data!\n";
+      worker.process->kill();
+      return;
+    }
+    if (recordSize == 0 || recordSize > static_cast<std::uint64_t>(worker.buffer.size()))
+    {
+      return;
+    }
+    QByteArray record = worker.buffer.left(static_cast<int>(recordSize));
+    worker.buffer.remove(0, static_cast<int>(recordSize));
+    QBuffer device(&record);
+    if (!device.open(QIODevice::ReadOnly)
+        || !OutputCache::read(device, static_cast<std::uint64_t>(worker.file), outputs[static_cast<std::size_t>(worker.file)]))
+    {
+      std::cerr << "A worker process has sent invalid data!\n";
+      worker.process->kill();
+      return;
+    }
+    remainingFiles--;
+    assign(worker);
+  }
+}
+
+void ShardedEvaluation::finish(Worker& worker)
+{
+  worker.running = false;
+  runningWorkers--;
+  if (worker.file >= 0)
+  {
+    const std::string path = db.audioFiles[worker.file].path.toStdString();
+    if (attempts[static_cast<std::size_t>(worker.file)] >= maxAttempts)
+    {
+      std::cerr << "Giving up on " << path << " after " << maxAttempts << " worker processes exited while evaluating it!\n";
+      abort();
+    }
+    else
+    {
+      std::cerr << "A worker process exited while evaluating " << path << ", starting a new one.\n";
+      pendingFiles.push_front(worker.file);
+    }
+    worker.file = -1;
+  }
+  if (!failed && !pendingFiles.empty() && !startWorker())
+  {
+    abort();
+  }
+  if (runningWorkers == 0)
+  {
+    loop->quit();
+  }
+}
+
+void ShardedEvaluation::abort()
+{
+  failed = true;
+  pendingFiles.clear();
+  for (auto& worker : workers)
+  {
+    if (worker.running && worker.file < 0)
+    {
+      worker.process->closeWriteChannel();
+    }
+  }
+}
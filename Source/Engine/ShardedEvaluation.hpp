@@ -0,0 +1,135 @@
+/**
+ * @file ShardedEvaluation.hpp declares the ShardedEvaluation class
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include "Detector/DetectorOutput.hpp"
+#include "Detector/DetectorParameters.hpp"
+#include "Engine/EvaluationResults.hpp"
+#include "Engine/SampleDatabase.hpp"
+
+
+class QEventLoop;
+class QProcess;
+
+/**
+ * @class ShardedEvaluation evaluates a detector on a sample database in several local worker processes
+ *
+ * The coordinator hands out the files of the database one at a time through the standard input of the workers, which
+ * are instances of this program started with --evaluation-worker. Each worker answers with the raw output of the
+ * detector on the file as output cache record on its standard output. Since all outputs are scored by a single scorer
+ * in the order of the database, the results are exactly the same as those of an evaluation in a single process. The
+ * workers do not share any global state (e.g. of FANN or FFTW) and a worker that crashes only loses the file it was
+ * working on, which is handed to a new worker.
+ */
+class ShardedEvaluation final
+{
+public:
+  /**
+   * @brief ShardedEvaluation describes an evaluation
+   * @param databaseFileName the name of the sample database file
+   * @param detector the name of the detector that is evaluated
+   * @param parameters the parameters of the detector that differ from its defaults
+   */
+  ShardedEvaluation(const QString& databaseFileName, const std::string& detector, const ParameterMap& parameters);
+  /**
+   * @brief ~ShardedEvaluation kills all workers that are still running
+   */
+  ~ShardedEvaluation();
+  /**
+   * @brief run evaluates the detector as coordinator
+   * @param results is filled with the results of the evaluation
+   * @param numberOfWorkers the number of worker processes that run in parallel
+   * @return whether the outputs on all files have been received
+   * @throw std::runtime_error if the database cannot be read or the detector cannot be created
+   */
+  bool run(EvaluationResults& results, unsigned int numberOfWorkers);
+  /**
+   * @brief work evaluates the detector as worker on the files that the coordinator requests
+   * @return the exit code of the worker process
+   */
+  int work();
+  /**
+   * @brief parseParameter parses a parameter from a command line argument of the form name=value
+   * @param argument the command line argument
+   * @param parameters the parameters to which the parameter is added
+   * @return whether the argument is a parameter
+   */
+  static bool parseParameter(const QString& argument, ParameterMap& parameters);
+private:
+  /**
+   * @struct Worker contains the state of a worker process
+   */
+  struct Worker
+  {
+    /// the worker process
+    std::unique_ptr<QProcess> process;
+    /// the index of the file on which the worker is working (-1 if it is idle)
+    int file = -1;
+    /// the bytes that have been received but do not form a complete record yet
+    QByteArray buffer;
+    /// whether the process is running
+    bool running = false;
+  };
+  /**
+   * @brief startWorker starts a new worker process and hands it a file
+   * @return whether the process could be started
+   */
+  bool startWorker();
+  /**
+   * @brief assign hands the next pending file to a worker or tells it to exit if there is none
+   * @param worker the worker that is idle
+   */
+  void assign(Worker& worker);
+  /**
+   * @brief receive reads all complete records that a worker has sent
+   * @param worker the worker that has sent something
+   */
+  void receive(Worker& worker);
+  /**
+   * @brief finish handles the exit of a worker process
+   * @param worker the worker whose process has exited
+   */
+  void finish(Worker& worker);
+  /**
+   * @brief abort stops handing out files after a file could not be evaluated
+   */
+  void abort();
+  /// the number of times that the evaluation of a file is attempted before the evaluation is given up
+  static constexpr unsigned int maxAttempts = 3;
+  /// the name of the sample database file
+  QString databaseFileName;
+  /// the name of the detector that is evaluated
+  std::string detector;
+  /// the parameters of the detector that differ from its defaults
+  ParameterMap parameters;
+  /// the sample database (the files are only decoded by the workers)
+  SampleDatabase db;
+  /// the outputs of the detector on the files of the database
+  std::vector<DetectorOutput> outputs;
+  /// the number of evaluations that have been attempted per file
+  std::vector<unsigned int> attempts;
+  /// the indices of the files that have not been handed to a worker
+  std::deque<int> pendingFiles;
+  /// the number of files whose output has not been received
+  std::size_t remainingFiles = 0;
+  /// the number of workers whose process is running
+  unsigned int runningWorkers = 0;
+  /// whether the evaluation has been given up
+  bool failed = false;
+  /// all workers that have been started (in a list because they are referenced by the signal handlers)
+  std::list<Worker> workers;
+  /// the event loop of the coordinator (only valid during run)
+  QEventLoop* loop = nullptr;
+};
@@ -0,0 +1,281 @@
+/**
+ * @file SpectrogramTiles.cpp implements methods of the SpectrogramTiles class
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "Detector/FFTWPlannerLock.hpp"
+#include "Engine/WorkerPool.hpp"
+
+#include "SpectrogramTiles.hpp"
+
+
+constexpr unsigned int SpectrogramTiles::fftSize;
+constexpr unsigned int SpectrogramTiles::numberOfBins;
+constexpr unsigned int SpectrogramTiles::tileWidth;
+constexpr unsigned int SpectrogramTiles::baseHopSize;
+constexpr unsigned int SpectrogramTiles::numberOfLevels;
+
+namespace
+{
+  /// the power (relative to a full scale sine) that is mapped to intensity 0 in dB
+  constexpr float floorDb = -100.f;
+  /// the power (relative to a full scale sine) that is mapped to intensity 255 in dB
+  constexpr float ceilingDb = 0.f;
+}
+
+SpectrogramTiles::SpectrogramTiles(const std::size_t maxBytes, std::function<void()> tileReady)
+  : maxTiles(std::max<std::size_t>(maxBytes / (numberOfBins * tileWidth), 1))
+  , tileReady(std::move(tileReady))
+  , window(fftSize)
+{
+  for (unsigned int i = 0; i < fftSize; i++)
+  {
+    window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / fftSize));
+  }
+  {
+    // The plan is created for arrays with the alignment of fftwf_alloc_*, so it can be executed on any such arrays.
+    float* in = fftwf_alloc_real(fftSize);
+    fftwf_complex* out = fftwf_alloc_complex(numberOfBins + 1);
+    FFTWPlannerLock lock;
+    fftPlan = fftwf_plan_dft_r2c_1d(fftSize, in, out, FFTW_ESTIMATE);
+    fftwf_free(out);
+    fftwf_free(in);
+  }
+  thread = std::thread(&SpectrogramTiles::run, this);
+}
+
+SpectrogramTiles::~SpectrogramTiles()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  condition.notify_all();
+  thread.join();
+  FFTWPlannerLock lock;
+  fftwf_destroy_plan(fftPlan);
+}
+
+void SpectrogramTiles::setSamples(const QVector<float>& samples)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  this->samples = samples;
+  generation++;
+  pending.clear();
+  cache.clear();
+  usage.clear();
+}
+
+std::shared_ptr<const SpectrogramTiles::Tile> SpectrogramTiles::getTile(const Key key)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  auto entry = cache.find(getId(key));
+  if (entry == cache.end())
+  {
+    return nullptr;
+  }
+  usage.splice(usage.begin(), usage, entry->second.usage);
+  return entry->second.tile;
+}
+
+void SpectrogramTiles::request(const std::vector<Key>& keys)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Tiles that are no longer requested (e.g. because the view has been scrolled away) are dropped.
+    pending.clear();
+    for (const auto& key : keys)
+    {
+      if (cache.find(getId(key)) == cache.end())
+      {
+        pending.push_back(key);
+      }
+    }
+  }
+  condition.notify_all();
+}
+
+unsigned int SpectrogramTiles::getHopSize(const unsigned int level)
+{
+  return baseHopSize << level;
+}
+
+void SpectrogramTiles::run()
+{
+  WorkerPool pool;
+  // A requested tile is pooled from 2^splitLevels finer tiles (at most down to level 0), so that even a single coarse
+  // tile is computed by all threads.
+  unsigned int splitLevels = 0;
+  while ((1U << splitLevels) < pool.getNumberOfThreads())
+  {
+    splitLevels++;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    condition.wait(lock, [this]{ return stop || !pending.empty(); });
+    if (stop)
+    {
+      return;
+    }
+    // Only as many tiles as there are threads are taken at once, so that new requests are served quickly.
+    const std::size_t count = std::min<std::size_t>(pending.size(), pool.getNumberOfThreads());
+    const std::vector<Key> batch(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+    const QVector<float> batchSamples = samples;
+    const unsigned int batchGeneration = generation;
+    lock.unlock();
+
+    std::vector<Key> parts;
+    std::vector<std::size_t> firstPart(count + 1);
+    for (std::size_t i = 0; i < count; i++)
+    {
+      firstPart[i] = parts.size();
+      const unsigned int levels = std::min(batch[i].level, splitLevels);
+      for (unsigned int j = 0; j < (1U << levels); j++)
+      {
+        parts.push_back({ batch[i].level - levels, (batch[i].index << levels) + j });
+      }
+    }
+    firstPart[count] = parts.size();
+    std::vector<std::shared_ptr<const Tile>> partTiles(parts.size());
+    pool.run(static_cast<unsigned int>(parts.size()), [&](const unsigned int i)
+    {
+      partTiles[i] = build(batchSamples, batchGeneration, parts[i]);
+    });
+    // Only the requested tiles are cached. The parts and intermediate tiles would otherwise evict the visible tiles of
+    // earlier batches when a long channel is zoomed out, so that the view would request them again and again.
+    for (std::size_t i = 0; i < count; i++)
+    {
+      std::vector<std::shared_ptr<const Tile>> tiles(partTiles.begin() + static_cast<std::ptrdiff_t>(firstPart[i]),
+                                                     partTiles.begin() + static_cast<std::ptrdiff_t>(firstPart[i + 1]));
+      Key key = parts[firstPart[i]];
+      while (tiles.size() > 1)
+      {
+        key.level++;
+        key.index /= 2;
+        for (std::size_t j = 0; j < tiles.size() / 2; j++)
+        {
+          auto tile = std::make_shared<Tile>();
+          downsample(*tiles[2 * j], *tiles[2 * j + 1], *tile);
+          tiles[j] = std::move(tile);
+        }
+        tiles.resize(tiles.size() / 2);
+      }
+      insert(batchGeneration, batch[i], std::move(tiles[0]));
+    }
+
+    lock.lock();
+    if (generation != batchGeneration)
+    {
+      continue;
+    }
+    lock.unlock();
+    tileReady();
+    lock.lock();
+  }
+}
+
+std::shared_ptr<const SpectrogramTiles::Tile> SpectrogramTiles::build(const QVector<float>& samples, const unsigned int generation, const Key key)
+{
+  {
+    // Tiles that are cached anyway (e.g. because they have been visible at a finer zoom) are reused.
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = cache.find(getId(key));
+    if (entry != cache.end() && this->generation == generation)
+    {
+      return entry->second.tile;
+    }
+  }
+  auto tile = std::make_shared<Tile>();
+  if (key.level == 0)
+  {
+    compute(samples, key.index, *tile);
+  }
+  else if (static_cast<std::int64_t>(key.index) * tileWidth * getHopSize(key.level) >= samples.size())
+  {
+    // Tiles behind the end of the channel are empty.
+    tile->intensities.assign(numberOfBins * tileWidth, 0);
+  }
+  else
+  {
+    const auto first = build(samples, generation, { key.level - 1, 2 * key.index });
+    const auto second = build(samples, generation, { key.level - 1, 2 * key.index + 1 });
+    downsample(*first, *second, *tile);
+  }
+  return tile;
+}
+
+void SpectrogramTiles::insert(const unsigned int generation, const Key key, std::shared_ptr<const Tile> tile)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  const std::uint64_t id = getId(key);
+  if (this->generation != generation || cache.find(id) != cache.end())
+  {
+    return;
+  }
+  usage.push_front(id);
+  cache[id] = { std::move(tile), usage.begin() };
+  while (cache.size() > maxTiles)
+  {
+    cache.erase(usage.back());
+    usage.pop_back();
+  }
+}
+
+void SpectrogramTiles::compute(const QVector<float>& samples, const unsigned int index, Tile& tile) const
+{
+  const std::int64_t size = samples.size();
+  const std::int64_t hopSize = getHopSize(0);
+  // A full scale sine has the magnitude fftSize / 4 in its bin after the Hann window.
+  const float normalization = 1.f / ((fftSize / 4.f) * (fftSize / 4.f));
+  float* in = fftwf_alloc_real(fftSize);
+  fftwf_complex* out = fftwf_alloc_complex(numberOfBins + 1);
+  tile.intensities.assign(numberOfBins * tileWidth, 0);
+  for (unsigned int column = 0; column < tileWidth; column++)
+  {
+    const std::int64_t columnStart = (static_cast<std::int64_t>(index) * tileWidth + column) * hopSize;
+    if (columnStart >= size)
+    {
+      break;
+    }
+    // The frame is centered in the column.
+    const std::int64_t frameStart = columnStart + hopSize / 2 - fftSize / 2;
+    for (unsigned int i = 0; i < fftSize; i++)
+    {
+      const std::int64_t sample = frameStart + i;
+      in[i] = (sample >= 0 && sample < size) ? window[i] * samples[static_cast<int>(sample)] : 0.f;
+    }
+    fftwf_execute_dft_r2c(fftPlan, in, out);
+    for (unsigned int bin = 0; bin < numberOfBins; bin++)
+    {
+      const float power = out[bin][0] * out[bin][0] + out[bin][1] * out[bin][1];
+      const float db = 10.f * std::log10(power * normalization + 1e-20f);
+      const float intensity = std::min(std::max((db - floorDb) / (ceilingDb - floorDb), 0.f), 1.f) * 255.f;
+      tile.intensities[(numberOfBins - 1 - bin) * tileWidth + column] = static_cast<std::uint8_t>(intensity);
+    }
+  }
+  fftwf_free(out);
+  fftwf_free(in);
+}
+
+void SpectrogramTiles::downsample(const Tile& first, const Tile& second, Tile& tile)
+{
+  // The intensity is a monotonic function of the power, so the maximum intensity is the intensity of the maximum power.
+  tile.intensities.resize(numberOfBins * tileWidth);
+  for (unsigned int row = 0; row < numberOfBins; row++)
+  {
+    for (unsigned int column = 0; column < tileWidth; column++)
+    {
+      const std::uint8_t* finer = (column < tileWidth / 2 ? first : second).intensities.data() + row * tileWidth + 2 * (column % (tileWidth / 2));
+      tile.intensities[row * tileWidth + column] = std::max(finer[0], finer[1]);
+    }
+  }
+}
+
+std::uint64_t SpectrogramTiles::getId(const Key key)
+{
+  return (static_cast<std::uint64_t>(key.level) << 32) | key.index;
+}
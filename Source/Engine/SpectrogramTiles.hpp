@@ -0,0 +1,173 @@
+/**
+ * @file SpectrogramTiles.hpp declares the SpectrogramTiles class
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <QVector>
+
+#include <fftw3.h>
+
+
+/**
+ * @class SpectrogramTiles computes the spectrogram of a channel in tiles of fixed size in a background thread
+ *
+ * A tile contains tileWidth columns of numberOfBins intensities. At zoom level l, consecutive columns are
+ * baseHopSize * 2^l samples apart, so that a view needs about the same number of tiles at every zoom. Only the tiles
+ * of level 0 are transformed, the tiles of the other levels form a mipmap in which each column is the maximum of two
+ * columns of the next finer level, so that no sample is skipped at coarse zoom. Tiles are only computed when they are
+ * requested (the view requests the visible ones, the finer tiles from which they are pooled are computed on the way
+ * but not cached) and are kept in a cache that evicts the least recently used tiles when its memory budget is exceeded.
+ */
+class SpectrogramTiles final
+{
+public:
+  /// the number of samples per FFT
+  static constexpr unsigned int fftSize = 512;
+  /// the number of frequency bins per column (the Nyquist bin is dropped)
+  static constexpr unsigned int numberOfBins = fftSize / 2;
+  /// the number of columns per tile
+  static constexpr unsigned int tileWidth = 256;
+  /// the number of samples between consecutive columns at level 0
+  static constexpr unsigned int baseHopSize = 128;
+  /// the number of zoom levels
+  static constexpr unsigned int numberOfLevels = 14;
+  /**
+   * @struct Key identifies a tile
+   */
+  struct Key
+  {
+    /// the zoom level of the tile
+    unsigned int level;
+    /// the index of the tile in its level
+    unsigned int index;
+  };
+  /**
+   * @struct Tile contains the intensities of a tile
+   */
+  struct Tile
+  {
+    /// the intensities in [0, 255] (row r contains bin numberOfBins - 1 - r of all columns, i.e. high frequencies first)
+    std::vector<std::uint8_t> intensities;
+  };
+  /**
+   * @brief SpectrogramTiles starts the background thread
+   * @param maxBytes the memory budget of the cache
+   * @param tileReady is called (from the background thread) whenever new tiles are available
+   */
+  SpectrogramTiles(std::size_t maxBytes, std::function<void()> tileReady);
+  /**
+   * @brief ~SpectrogramTiles stops the background thread
+   */
+  ~SpectrogramTiles();
+  SpectrogramTiles(const SpectrogramTiles&) = delete;
+  SpectrogramTiles& operator=(const SpectrogramTiles&) = delete;
+  /**
+   * @brief setSamples replaces the channel (this discards all tiles and requests)
+   * @param samples the samples of the channel (shared, not copied)
+   */
+  void setSamples(const QVector<float>& samples);
+  /**
+   * @brief getTile returns a tile if it is in the cache
+   * @param key the key of the tile
+   * @return the tile or nullptr if it has not been computed yet
+   */
+  std::shared_ptr<const Tile> getTile(Key key);
+  /**
+   * @brief request replaces the tiles that are waiting to be computed
+   * @param keys the keys of the tiles in the order in which they should be computed
+   */
+  void request(const std::vector<Key>& keys);
+  /**
+   * @brief getHopSize returns the number of samples between consecutive columns at a level
+   * @param level the zoom level
+   * @return the number of samples between consecutive columns
+   */
+  static unsigned int getHopSize(unsigned int level);
+private:
+  /**
+   * @brief run is the main function of the background thread
+   */
+  void run();
+  /**
+   * @brief build takes a tile from the cache or computes it from the finer tiles it is pooled from (without caching any of them)
+   * @param samples the samples of the channel
+   * @param generation the generation of the channel
+   * @param key the key of the tile
+   * @return the tile
+   */
+  std::shared_ptr<const Tile> build(const QVector<float>& samples, unsigned int generation, Key key);
+  /**
+   * @brief insert inserts a tile into the cache and evicts the least recently used tiles if the cache is full
+   * @param generation the generation of the channel from which the tile has been computed
+   * @param key the key of the tile
+   * @param tile the tile
+   */
+  void insert(unsigned int generation, Key key, std::shared_ptr<const Tile> tile);
+  /**
+   * @brief compute computes a tile of level 0
+   * @param samples the samples of the channel
+   * @param index the index of the tile
+   * @param tile the tile that is filled
+   */
+  void compute(const QVector<float>& samples, unsigned int index, Tile& tile) const;
+  /**
+   * @brief downsample fills a tile with the maxima of pairs of adjacent columns of the two tiles of the next finer level that it covers
+   * @param first the first finer tile
+   * @param second the second finer tile
+   * @param tile the tile that is filled
+   */
+  static void downsample(const Tile& first, const Tile& second, Tile& tile);
+  /**
+   * @brief getId packs a key into an integer
+   * @param key the key
+   * @return an integer that is unique for each key
+   */
+  static std::uint64_t getId(Key key);
+  /**
+   * @struct Entry is a tile in the cache
+   */
+  struct Entry
+  {
+    /// the tile
+    std::shared_ptr<const Tile> tile;
+    /// the position of the tile in the usage list
+    std::list<std::uint64_t>::iterator usage;
+  };
+  /// the maximum number of tiles in the cache
+  const std::size_t maxTiles;
+  /// is called whenever new tiles are available
+  const std::function<void()> tileReady;
+  /// the Hann window
+  std::vector<float> window;
+  /// the plan for FFTW (only executed with new arrays, so that all workers can share it)
+  fftwf_plan fftPlan = nullptr;
+  /// the mutex that protects the state below
+  std::mutex mutex;
+  /// notifies the background thread that there are new requests or that it should stop
+  std::condition_variable condition;
+  /// the samples of the current channel
+  QVector<float> samples;
+  /// is incremented when the channel changes, so that tiles of an old channel are never inserted
+  unsigned int generation = 0;
+  /// the tiles that are waiting to be computed
+  std::vector<Key> pending;
+  /// the cached tiles
+  std::unordered_map<std::uint64_t, Entry> cache;
+  /// the ids of the cached tiles from the most to the least recently used one
+  std::list<std::uint64_t> usage;
+  /// whether the background thread should terminate
+  bool stop = false;
+  /// the background thread (declared last so that it starts after everything else has been initialized)
+  std::thread thread;
+};
@@ -0,0 +1,151 @@
+/**
+ * @file WaveformPyramid.cpp implements methods of the WaveformPyramid class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "WaveformPyramid.hpp"
+
+
+constexpr unsigned int WaveformPyramid::baseBucketSize;
+constexpr unsigned int WaveformPyramid::reductionFactor;
+
+namespace
+{
+  /**
+   * @brief reduce computes the minimum, maximum and energy of a range of samples
+   * @param samples the samples
+   * @param count the number of samples
+   * @param minimum is set to the smallest sample
+   * @param maximum is set to the largest sample
+   * @param energy is set to the sum of the squared samples
+   */
+  inline void reduce(const float* samples, const unsigned int count, float& minimum, float& maximum, float& energy)
+  {
+    unsigned int i = 0;
+    minimum = samples[0];
+    maximum = samples[0];
+    energy = 0.f;
+#ifdef __SSE2__
+    if (count >= 4)
+    {
+      __m128 mn = _mm_loadu_ps(samples);
+      __m128 mx = mn;
+      __m128 e = _mm_setzero_ps();
+      for (; i + 4 <= count; i += 4)
+      {
+        const __m128 x = _mm_loadu_ps(samples + i);
+        mn = _mm_min_ps(mn, x);
+        mx = _mm_max_ps(mx, x);
+        e = _mm_add_ps(e, _mm_mul_ps(x, x));
+      }
+      alignas(16) float lanes[3][4];
+      _mm_store_ps(lanes[0], mn);
+      _mm_store_ps(lanes[1], mx);
+      _mm_store_ps(lanes[2], e);
+      minimum = std::min(std::min(lanes[0][0], lanes[0][1]), std::min(lanes[0][2], lanes[0][3]));
+      maximum = std::max(std::max(lanes[1][0], lanes[1][1]), std::max(lanes[1][2], lanes[1][3]));
+      energy = (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+    }
+#endif
+    for (; i < count; i++)
+    {
+      minimum = std::min(minimum, samples[i]);
+      maximum = std::max(maximum, samples[i]);
+      energy += samples[i] * samples[i];
+    }
+  }
+}
+
+WaveformPyramid::WaveformPyramid(const float* samples, const unsigned int count)
+  : numberOfSamples(count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  buildBaseLevel(samples);
+  while (levels.back().minimum.size() > 1)
+  {
+    buildLevel();
+  }
+}
+
+WaveformPyramid::Summary WaveformPyramid::summarize(unsigned int begin, unsigned int end) const
+{
+  Summary summary;
+  end = std::min(end, numberOfSamples);
+  if (begin >= end)
+  {
+    return summary;
+  }
+  // The coarsest level whose buckets are not larger than the range needs at most reductionFactor + 1 buckets.
+  std::size_t l = 0;
+  while (l + 1 < levels.size() && levels[l + 1].bucketSize <= end - begin)
+  {
+    l++;
+  }
+  const Level& level = levels[l];
+  const unsigned int firstBucket = begin / level.bucketSize;
+  const unsigned int lastBucket = (end - 1) / level.bucketSize;
+  summary.minimum = level.minimum[firstBucket];
+  summary.maximum = level.maximum[firstBucket];
+  float energy = 0.f;
+  for (unsigned int b = firstBucket; b <= lastBucket; b++)
+  {
+    summary.minimum = std::min(summary.minimum, level.minimum[b]);
+    summary.maximum = std::max(summary.maximum, level.maximum[b]);
+    energy += level.energy[b];
+  }
+  const unsigned int coveredSamples = std::min((lastBucket + 1) * level.bucketSize, numberOfSamples) - firstBucket * level.bucketSize;
+  summary.rms = std::sqrt(energy / static_cast<float>(coveredSamples));
+  return summary;
+}
+
+unsigned int WaveformPyramid::size() const
+{
+  return numberOfSamples;
+}
+
+void WaveformPyramid::buildBaseLevel(const float* samples)
+{
+  const unsigned int numberOfBuckets = (numberOfSamples + baseBucketSize - 1) / baseBucketSize;
+  levels.emplace_back();
+  Level& level = levels.back();
+  level.bucketSize = baseBucketSize;
+  level.minimum.resize(numberOfBuckets);
+  level.maximum.resize(numberOfBuckets);
+  level.energy.resize(numberOfBuckets);
+  for (unsigned int b = 0; b < numberOfBuckets; b++)
+  {
+    const unsigned int first = b * baseBucketSize;
+    reduce(samples + first, std::min(baseBucketSize, numberOfSamples - first), level.minimum[b], level.maximum[b], level.energy[b]);
+  }
+}
+
+void WaveformPyramid::buildLevel()
+{
+  const Level& below = levels.back();
+  const unsigned int numberOfBucketsBelow = static_cast<unsigned int>(below.minimum.size());
+  const unsigned int numberOfBuckets = (numberOfBucketsBelow + reductionFactor - 1) / reductionFactor;
+  Level level;
+  level.bucketSize = below.bucketSize * reductionFactor;
+  level.minimum.resize(numberOfBuckets);
+  level.maximum.resize(numberOfBuckets);
+  level.energy.resize(numberOfBuckets);
+  for (unsigned int b = 0; b < numberOfBuckets; b++)
+  {
+    const unsigned int first = b * reductionFactor;
+    const unsigned int last = std::min(first + reductionFactor, numberOfBucketsBelow);
+    level.minimum[b] = *std::min_element(below.minimum.begin() + first, below.minimum.begin() + last);
+    level.maximum[b] = *std::max_element(below.maximum.begin() + first, below.maximum.begin() + last);
+    level.energy[b] = std::accumulate(below.energy.begin() + first, below.energy.begin() + last, 0.f);
+  }
+  levels.push_back(std::move(level));
+}
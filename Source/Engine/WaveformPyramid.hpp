@@ -0,0 +1,82 @@
+/**
+ * @file WaveformPyramid.hpp declares the WaveformPyramid class
+ */
+
+#pragma once
+
+#include <vector>
+
+
+/**
+ * @class WaveformPyramid summarizes the samples of a channel at multiple resolutions for drawing
+ *
+ * Each level divides the channel into buckets and stores the minimum, the maximum and the energy of the samples of
+ * each bucket. The buckets of each level are reductionFactor times as large as the ones of the level below, so that
+ * any range of samples can be summarized by touching at most a few buckets.
+ */
+class WaveformPyramid final
+{
+public:
+  /**
+   * @struct Summary describes the samples of a range
+   */
+  struct Summary
+  {
+    /// the smallest sample
+    float minimum = 0.f;
+    /// the largest sample
+    float maximum = 0.f;
+    /// the root mean square of the samples
+    float rms = 0.f;
+  };
+  /**
+   * @brief WaveformPyramid builds all levels of the pyramid
+   * @param samples the samples of the channel
+   * @param count the number of samples
+   */
+  WaveformPyramid(const float* samples, unsigned int count);
+  /**
+   * @brief summarize describes the samples of a range (with the resolution of the buckets that are used)
+   * @param begin the first sample of the range
+   * @param end the sample after the range
+   * @return the minimum, maximum and RMS of the range (zero if it is empty)
+   */
+  Summary summarize(unsigned int begin, unsigned int end) const;
+  /**
+   * @brief size returns the number of samples of the channel
+   * @return the number of samples
+   */
+  unsigned int size() const;
+  /// the number of samples in a bucket of the lowest level (ranges that are shorter should be drawn from the samples)
+  static constexpr unsigned int baseBucketSize = 64;
+  /// the factor by which the buckets of a level are larger than the ones of the level below
+  static constexpr unsigned int reductionFactor = 4;
+private:
+  /**
+   * @struct Level contains the buckets of one resolution (each statistic is stored contiguously)
+   */
+  struct Level
+  {
+    /// the number of samples in a bucket
+    unsigned int bucketSize = 0;
+    /// the smallest sample of each bucket
+    std::vector<float> minimum;
+    /// the largest sample of each bucket
+    std::vector<float> maximum;
+    /// the sum of the squared samples of each bucket
+    std::vector<float> energy;
+  };
+  /**
+   * @brief buildBaseLevel reduces the samples to the buckets of the lowest level
+   * @param samples the samples of the channel
+   */
+  void buildBaseLevel(const float* samples);
+  /**
+   * @brief buildLevel reduces the buckets of the last level to the next level
+   */
+  void buildLevel();
+  /// the number of samples of the channel
+  unsigned int numberOfSamples;
+  /// the levels from the finest to the coarsest one
+  std::vector<Level> levels;
+};
@@ -2,22 +2,65 @@
  * @file WhistleLabEngine.cpp implements methods for the whistle lab engine class
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
 #include <QAudioFormat>
 #include <QAudioOutput>
 #include <QIODevice>
 #include <QString>
 
+#include "Detector/StreamingWhistleDetectorBase.hpp"
 #include "Detector/WhistleDetectorBase.hpp"
 #include "Detector/WhistleDetectorFactoryBase.hpp"
+#include "Engine/NoiseAugmentation.hpp"
+#include "Engine/ParameterSweep.hpp"
+#include "Engine/WaveformPyramid.hpp"
 
 #include "WhistleLabEngine.hpp"
 
 
+namespace
+{
+  /// the number of seconds of audio that are pushed to the overlay detector at once
+  constexpr double overlayChunkDuration = 0.1;
+  /// the minimum time between two overlayProgress signals (so that the UI is not flooded)
+  constexpr std::chrono::milliseconds overlayUpdateInterval(50);
+  /// the maximum number of overlay outputs that are cached (the least recently used ones are evicted)
+  constexpr std::size_t maxOverlayCacheEntries = 64;
+
+  /**
+   * @brief append appends the detections and scores of an output to another one
+   * @param to the output to which is appended
+   * @param from the output that is appended
+   */
+  void append(DetectorOutput& to, const DetectorOutput& from)
+  {
+    to.detections.insert(to.detections.end(), from.detections.begin(), from.detections.end());
+    to.detectionPositions.insert(to.detectionPositions.end(), from.detectionPositions.begin(), from.detectionPositions.end());
+    to.scores.insert(to.scores.end(), from.scores.begin(), from.scores.end());
+  }
+}
+
 WhistleLabEngine::WhistleLabEngine(QObject* parent)
   : QObject(parent)
   , audioDeviceInfo(QAudioDeviceInfo::defaultOutputDevice())
+  , decoderCancelled(false)
+  , overlayCancelled(false)
 {
   audioOutputBuffer.setBuffer(&audioOutputArray);
+  // The decoder thread only announces decoded files, the samples are moved into the database in the engine thread.
+  connect(this, &WhistleLabEngine::fileDecoded, this, &WhistleLabEngine::installDecodedFiles, Qt::QueuedConnection);
+}
+
+WhistleLabEngine::~WhistleLabEngine()
+{
+  stopOverlay();
+  stopDecoding();
 }
 
 void WhistleLabEngine::evaluateDetector(const QString& name)
@@ -26,11 +69,16 @@ void WhistleLabEngine::evaluateDetector(const QString& name)
   {
     return;
   }
+  const SampleDatabase db = waitForDecoding();
 
   auto detector = WhistleDetectorFactoryBase::make(name.toStdString());
   EvaluationResults results;
-  detector->evaluateOnDatabase(sampleDatabase, &results);
+  detector->evaluateOnDatabase(db, &results);
   emit evaluationDone(results);
+  if (noiseAugmentation)
+  {
+    noiseAugmentation->evaluate(*detector, db);
+  }
 }
 
 void WhistleLabEngine::trainDetector(const QString& name)
@@ -39,9 +87,71 @@ void WhistleLabEngine::trainDetector(const QString& name)
   {
     return;
   }
+  const SampleDatabase db = waitForDecoding();
 
   auto detector = WhistleDetectorFactoryBase::make(name.toStdString());
-  detector->trainOnDatabase(sampleDatabase);
+  detector->trainOnDatabase(db, noiseAugmentation.get());
+}
+
+void WhistleLabEngine::setNoiseAugmentation(const QString& fileName)
+{
+  if (fileName.isEmpty())
+  {
+    noiseAugmentation.reset();
+    return;
+  }
+  try
+  {
+    std::unique_ptr<NoiseAugmentation> augmentation(new NoiseAugmentation);
+    augmentation->readFromFile(fileName);
+    noiseAugmentation = std::move(augmentation);
+    std::cout << "Noise augmentation has been loaded from " << fileName.toStdString() << '\n';
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Noise augmentation could not be loaded: " << e.what() << '\n';
+  }
+}
+
+void WhistleLabEngine::sweepParameters(const QString& fileName)
+{
+  if (!sampleDatabase.exists)
+  {
+    return;
+  }
+  const SampleDatabase db = waitForDecoding();
+
+  try
+  {
+    ParameterSweep sweep;
+    sweep.readFromFile(fileName);
+    sweep.run(db);
+    std::cout << "Parameter sweep results have been written to " << sweep.outputFileName.toStdString() << '\n';
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Parameter sweep failed: " << e.what() << '\n';
+  }
+}
+
+void WhistleLabEngine::prelabel(const QString& name)
+{
+  if (!sampleDatabase.exists)
+  {
+    return;
+  }
+  const SampleDatabase db = waitForDecoding();
+
+  try
+  {
+    Prelabeler prelabeler;
+    prelabeler.detector = name.toStdString();
+    emit whistlesProposed(prelabeler.run(db));
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Pre-labeling failed: " << e.what() << '\n';
+  }
 }
 
 void WhistleLabEngine::changeDatabase(const QString& readFileName, const QString& writeFileName)
@@ -51,16 +161,33 @@ void WhistleLabEngine::changeDatabase(const QString& readFileName, const QString
     sampleDatabase.writeToFile(writeFileName);
   }
   selectChannel("", 0);
+  stopDecoding();
+  {
+    std::lock_guard<std::mutex> lock(overlayCacheMutex);
+    overlayCache.clear();
+    overlayCacheUsage.clear();
+  }
   sampleDatabase.clear();
+  emit sampleDatabaseClosed();
   if (!readFileName.isEmpty())
   {
     sampleDatabase.readFromFile(readFileName);
+    emit sampleDatabaseOpened(sampleDatabase.name);
+    // Only the descriptions of the files are sent, so the UI never holds on to samples. The files can be browsed
+    // right away while their samples are decoded in the background.
+    for (auto& audioFile : sampleDatabase.audioFiles)
+    {
+      emit audioFileAdded(AudioFileInfo(audioFile));
+    }
+    startDecoding();
   }
-  emit sampleDatabaseChanged(sampleDatabase);
 }
 
 void WhistleLabEngine::selectChannel(const QString& path, const unsigned int channel)
 {
+  pendingChannelPath.clear();
+  activeChannelFile = AudioFile();
+  startOverlay();
   if (!sampleDatabase.exists)
   {
     emit channelChanged(AudioChannel());
@@ -88,6 +215,25 @@ void WhistleLabEngine::selectChannel(const QString& path, const unsigned int cha
     if (audioFile.path == path)
     {
       Q_ASSERT(channel < audioFile.numberOfChannels);
+      if (!audioFile.decoded)
+      {
+        // The file is decoded next and the channel is selected when it is ready.
+        pendingChannelPath = path;
+        pendingChannel = channel;
+        {
+          std::lock_guard<std::mutex> lock(decoderMutex);
+          const auto queued = std::find_if(decoderQueue.begin(), decoderQueue.end(),
+            [&audioFile](const AudioFile& file){ return file.id == audioFile.id; });
+          if (queued != decoderQueue.end())
+          {
+            AudioFile file = std::move(*queued);
+            decoderQueue.erase(queued);
+            decoderQueue.push_front(std::move(file));
+          }
+        }
+        emit channelChanged(AudioChannel());
+        return;
+      }
       for (auto& audioChannel : audioFile.channels)
       {
         if (audioChannel.channel == channel)
@@ -105,6 +251,14 @@ void WhistleLabEngine::selectChannel(const QString& path, const unsigned int cha
             return;
           }
 
+          // The pyramid is built here (in the engine thread) and stays with the channel, so the label view never
+          // has to touch all samples.
+          if (audioChannel.waveform == nullptr)
+          {
+            audioChannel.waveform = std::make_shared<const WaveformPyramid>(audioChannel.samples.data(),
+              static_cast<unsigned int>(audioChannel.samples.size()));
+          }
+
           audioOutputArray.setRawData(reinterpret_cast<const char*>(audioChannel.samples.data()),
             static_cast<uint>(audioChannel.samples.size() * sizeof(float)));
           audioOutputBuffer.open(QIODevice::ReadOnly);
@@ -113,6 +267,12 @@ void WhistleLabEngine::selectChannel(const QString& path, const unsigned int cha
           connect(audioOutput, &QAudioOutput::notify, this, &WhistleLabEngine::updatePlaybackPosition);
           audioOutput->setNotifyInterval(200);
           emit channelChanged(audioChannel);
+
+          activeChannelFile.path = audioFile.path;
+          activeChannelFile.numberOfChannels = 1;
+          activeChannelFile.sampleRate = audioFile.sampleRate;
+          activeChannelFile.channels.append(audioChannel);
+          startOverlay();
           return;
         }
       }
@@ -122,6 +282,102 @@ void WhistleLabEngine::selectChannel(const QString& path, const unsigned int cha
   Q_ASSERT(false);
 }
 
+void WhistleLabEngine::removeAudioFile(const unsigned int id)
+{
+  for (int i = 0; i < sampleDatabase.audioFiles.size(); i++)
+  {
+    if (sampleDatabase.audioFiles[i].id == id)
+    {
+      if (activeChannelFile.path == sampleDatabase.audioFiles[i].path)
+      {
+        selectChannel("", 0);
+      }
+      {
+        std::lock_guard<std::mutex> lock(decoderMutex);
+        const auto queued = std::find_if(decoderQueue.begin(), decoderQueue.end(),
+          [id](const AudioFile& file){ return file.id == id; });
+        if (queued != decoderQueue.end())
+        {
+          decoderQueue.erase(queued);
+          filesToDecode--;
+        }
+      }
+      sampleDatabase.audioFiles.removeAt(i);
+      emit audioFileRemoved(id);
+      return;
+    }
+  }
+}
+
+void WhistleLabEngine::addWhistleLabel(const unsigned int id, const unsigned int channel, const int start, const int end)
+{
+  for (auto& audioFile : sampleDatabase.audioFiles)
+  {
+    if (audioFile.id != id)
+    {
+      continue;
+    }
+    for (auto& audioChannel : audioFile.channels)
+    {
+      if (audioChannel.channel == channel && start < end)
+      {
+        // The labels of a channel are kept ordered by their start.
+        WhistleLabel label;
+        label.start = start;
+        label.end = end;
+        int index = 0;
+        while (index < audioChannel.whistleLabels.size() && audioChannel.whistleLabels[index].start <= start)
+        {
+          index++;
+        }
+        audioChannel.whistleLabels.insert(index, label);
+        emit audioFileChanged(AudioFileInfo(audioFile));
+        updateActiveChannelLabels(audioFile, audioChannel);
+      }
+    }
+    return;
+  }
+}
+
+void WhistleLabEngine::removeWhistleLabel(const unsigned int id, const unsigned int channel, const int labelIndex)
+{
+  for (auto& audioFile : sampleDatabase.audioFiles)
+  {
+    if (audioFile.id != id)
+    {
+      continue;
+    }
+    for (auto& audioChannel : audioFile.channels)
+    {
+      if (audioChannel.channel == channel && labelIndex >= 0 && labelIndex < audioChannel.whistleLabels.size())
+      {
+        audioChannel.whistleLabels.remove(labelIndex);
+        emit audioFileChanged(AudioFileInfo(audioFile));
+        updateActiveChannelLabels(audioFile, audioChannel);
+      }
+    }
+    return;
+  }
+}
+
+void WhistleLabEngine::updateActiveChannelLabels(const AudioFile& audioFile, const AudioChannel& audioChannel)
+{
+  if (activeChannelFile.channels.isEmpty() || activeChannelFile.path != audioFile.path
+      || activeChannelFile.channels[0].channel != audioChannel.channel)
+  {
+    return;
+  }
+  activeChannelFile.channels[0].whistleLabels = audioChannel.whistleLabels;
+  // The overlay is taken from the cache again unless the output of its detector depends on the labels.
+  startOverlay();
+}
+
+void WhistleLabEngine::selectOverlayDetector(const QString& name)
+{
+  overlayDetectorName = name.toStdString();
+  startOverlay();
+}
+
 void WhistleLabEngine::setPlaybackVolume(const qreal volume)
 {
   if (audioOutput != nullptr)
@@ -158,3 +414,259 @@ void WhistleLabEngine::updatePlaybackPosition()
   Q_ASSERT(audioOutput != nullptr);
   emit playbackPositionChanged(static_cast<unsigned int>(audioOutput->processedUSecs() * audioOutput->format().sampleRate() / 1000000));
 }
+
+void WhistleLabEngine::installDecodedFiles()
+{
+  std::vector<AudioFile> files;
+  {
+    std::lock_guard<std::mutex> lock(decoderMutex);
+    files.swap(decodedFiles);
+  }
+  if (files.empty())
+  {
+    return;
+  }
+  for (auto& decodedFile : files)
+  {
+    filesInstalled++;
+    if (!decodedFile.decoded)
+    {
+      continue;
+    }
+    // The labels may have been edited in the meantime, so only the samples are taken from the decoded copy.
+    for (auto& audioFile : sampleDatabase.audioFiles)
+    {
+      if (audioFile.id != decodedFile.id)
+      {
+        continue;
+      }
+      audioFile.sampleRate = decodedFile.sampleRate;
+      audioFile.samples = decodedFile.samples;
+      for (int i = 0; i < audioFile.channels.size() && i < decodedFile.channels.size(); i++)
+      {
+        audioFile.channels[i].samples = decodedFile.channels[i].samples;
+      }
+      audioFile.decoded = true;
+      emit audioFileChanged(AudioFileInfo(audioFile));
+      if (!pendingChannelPath.isEmpty() && audioFile.path == pendingChannelPath)
+      {
+        // selectChannel clears the pending channel, so the path must not be passed by reference.
+        const QString path = pendingChannelPath;
+        selectChannel(path, pendingChannel);
+      }
+      break;
+    }
+  }
+  emit decodingProgress(filesInstalled, filesToDecode);
+}
+
+void WhistleLabEngine::startDecoding()
+{
+  stopDecoding();
+  for (auto& audioFile : sampleDatabase.audioFiles)
+  {
+    // The decoder gets a copy that shares the channels (and labels) of the file until its samples are written.
+    AudioFile file;
+    file.id = audioFile.id;
+    file.path = audioFile.path;
+    file.filePath = audioFile.filePath;
+    file.numberOfChannels = audioFile.numberOfChannels;
+    file.channels = audioFile.channels;
+    decoderQueue.push_back(std::move(file));
+  }
+  filesToDecode = static_cast<unsigned int>(decoderQueue.size());
+  filesInstalled = 0;
+  emit decodingProgress(filesInstalled, filesToDecode);
+  decoderThread = std::thread(&WhistleLabEngine::runDecoder, this);
+}
+
+void WhistleLabEngine::stopDecoding()
+{
+  if (decoderThread.joinable())
+  {
+    decoderCancelled = true;
+    decoderThread.join();
+    decoderCancelled = false;
+  }
+  std::lock_guard<std::mutex> lock(decoderMutex);
+  decoderQueue.clear();
+  decodedFiles.clear();
+}
+
+SampleDatabase WhistleLabEngine::waitForDecoding()
+{
+  if (decoderThread.joinable())
+  {
+    // The thread terminates by itself when the queue is empty.
+    decoderThread.join();
+  }
+  installDecodedFiles();
+  // Files that could not be decoded have no samples, so they would be scored as if all of their whistles were missed.
+  SampleDatabase db = sampleDatabase;
+  db.audioFiles.clear();
+  for (const auto& audioFile : sampleDatabase.audioFiles)
+  {
+    if (audioFile.decoded)
+    {
+      db.audioFiles.append(audioFile);
+    }
+    else
+    {
+      std::cerr << "Excluding " << audioFile.path.toStdString() << " because it could not be decoded!\n";
+    }
+  }
+  if (db.audioFiles.size() < sampleDatabase.audioFiles.size())
+  {
+    std::cerr << sampleDatabase.audioFiles.size() - db.audioFiles.size() << " of " << sampleDatabase.audioFiles.size()
+              << " files could not be decoded and are excluded!\n";
+  }
+  return db;
+}
+
+void WhistleLabEngine::runDecoder()
+{
+  while (!decoderCancelled)
+  {
+    AudioFile file;
+    {
+      std::lock_guard<std::mutex> lock(decoderMutex);
+      if (decoderQueue.empty())
+      {
+        return;
+      }
+      file = std::move(decoderQueue.front());
+      decoderQueue.pop_front();
+    }
+    try
+    {
+      file.decode();
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "Could not decode " << file.path.toStdString() << ": " << e.what() << '\n';
+    }
+    {
+      std::lock_guard<std::mutex> lock(decoderMutex);
+      decodedFiles.push_back(std::move(file));
+    }
+    emit fileDecoded();
+  }
+}
+
+void WhistleLabEngine::startOverlay()
+{
+  stopOverlay();
+  emit overlayStarted();
+  if (overlayDetectorName.empty() || activeChannelFile.channels.isEmpty())
+  {
+    return;
+  }
+  std::shared_ptr<WhistleDetectorBase> detector;
+  try
+  {
+    detector = WhistleDetectorFactoryBase::make(overlayDetectorName);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Overlay failed: " << e.what() << '\n';
+    return;
+  }
+  // The channel is identified by its file and index. Its labels are only part of the key if the output depends on them.
+  std::ostringstream key;
+  key << overlayDetectorName << '|' << detector->getVersion() << '|' << activeChannelFile.path.toStdString() << '|'
+      << activeChannelFile.channels[0].channel;
+  for (const auto& parameter : detector->getParameters().get())
+  {
+    key << '|' << parameter.first << '=' << parameter.second;
+  }
+  if (detector->dependsOnLabels())
+  {
+    for (const auto& label : activeChannelFile.channels[0].whistleLabels)
+    {
+      key << '|' << label.start << '-' << label.end;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(overlayCacheMutex);
+    const auto cached = overlayCache.find(key.str());
+    if (cached != overlayCache.end())
+    {
+      overlayCacheUsage.splice(overlayCacheUsage.begin(), overlayCacheUsage, cached->second.usage);
+      emit overlayProgress(*cached->second.output);
+      return;
+    }
+  }
+  overlayCancelled = false;
+  overlayThread = std::thread(&WhistleLabEngine::runOverlay, this, detector, activeChannelFile, key.str());
+}
+
+void WhistleLabEngine::stopOverlay()
+{
+  if (overlayThread.joinable())
+  {
+    overlayCancelled = true;
+    overlayThread.join();
+  }
+}
+
+void WhistleLabEngine::runOverlay(std::shared_ptr<WhistleDetectorBase> detector, AudioFile file, std::string key)
+{
+  DetectorOutput result;
+  // A streaming detector that is fed directly does not see the labels, so a detector that depends on them is run
+  // through an evaluation handle to get the same output as in an evaluation.
+  auto* streamingDetector = detector->dependsOnLabels() ? nullptr : dynamic_cast<StreamingWhistleDetectorBase*>(detector.get());
+  if (streamingDetector != nullptr)
+  {
+    // Streaming detectors are fed in small chunks, so that their output can be shown while they are running.
+    if (!streamingDetector->reset(file.sampleRate))
+    {
+      return;
+    }
+    const QVector<float>& samples = file.channels[0].samples;
+    const unsigned int size = static_cast<unsigned int>(samples.size());
+    const unsigned int chunkSize = std::max(static_cast<unsigned int>(file.sampleRate * overlayChunkDuration), 1U);
+    DetectorOutput pending;
+    auto lastUpdate = std::chrono::steady_clock::now();
+    for (unsigned int pos = 0; pos < size; pos += chunkSize)
+    {
+      if (overlayCancelled)
+      {
+        return;
+      }
+      append(pending, streamingDetector->process(samples.constData() + pos, std::min(chunkSize, size - pos)));
+      const auto now = std::chrono::steady_clock::now();
+      if (now - lastUpdate >= overlayUpdateInterval && !(pending.detections.empty() && pending.scores.empty()))
+      {
+        append(result, pending);
+        emit overlayProgress(pending);
+        pending = DetectorOutput();
+        lastUpdate = now;
+      }
+    }
+    append(result, pending);
+    emit overlayProgress(pending);
+  }
+  else
+  {
+    EvaluationHandle eh(file);
+    detector->evaluate(eh);
+    if (overlayCancelled)
+    {
+      return;
+    }
+    append(result, eh.getOutput());
+    emit overlayProgress(result);
+  }
+  std::lock_guard<std::mutex> lock(overlayCacheMutex);
+  if (overlayCache.find(key) != overlayCache.end())
+  {
+    return;
+  }
+  overlayCacheUsage.push_front(key);
+  overlayCache[key] = { std::make_shared<const DetectorOutput>(std::move(result)), overlayCacheUsage.begin() };
+  while (overlayCache.size() > maxOverlayCacheEntries)
+  {
+    overlayCache.erase(overlayCacheUsage.back());
+    overlayCacheUsage.pop_back();
+  }
+}
@@ -4,16 +4,31 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <QAudio>
 #include <QAudioDeviceInfo>
 #include <QBuffer>
 #include <QByteArray>
 #include <QObject>
 
+#include "Detector/DetectorOutput.hpp"
+#include "Engine/AudioFileInfo.hpp"
+#include "Engine/Prelabeler.hpp"
 #include "Engine/SampleDatabase.hpp"
 
 
 class EvaluationResults;
+class NoiseAugmentation;
+class WhistleDetectorBase;
 class QAudioOutput;
 class QString;
 
@@ -29,12 +44,50 @@ public:
    * @param parent the parent object
    */
   WhistleLabEngine(QObject* parent = 0);
+  /**
+   * @brief ~WhistleLabEngine stops the overlay detector and the decoder
+   */
+  ~WhistleLabEngine();
 signals:
   /**
-   * @brief sampleDatabaseChanged signals that the sample database has changed
-   * @param sampleDatabase a reference to the new sample database
+   * @brief sampleDatabaseOpened signals that a sample database has been opened (its files follow one by one)
+   * @param name the name of the sample database
+   */
+  void sampleDatabaseOpened(const QString& name);
+  /**
+   * @brief sampleDatabaseClosed signals that the sample database has been closed
+   */
+  void sampleDatabaseClosed();
+  /**
+   * @brief audioFileAdded signals that a file has been added to the sample database
+   * @param info a description of the file
+   */
+  void audioFileAdded(const AudioFileInfo& info);
+  /**
+   * @brief audioFileChanged signals that the labels of a file have changed
+   * @param info the new description of the file
+   */
+  void audioFileChanged(const AudioFileInfo& info);
+  /**
+   * @brief audioFileRemoved signals that a file has been removed from the sample database
+   * @param id the id of the file
+   */
+  void audioFileRemoved(unsigned int id);
+  /**
+   * @brief decodingProgress is emitted when a file of the sample database has been decoded
+   * @param decodedFiles the number of files that have been decoded since the database has been opened
+   * @param totalFiles the number of files that are decoded in total
+   */
+  void decodingProgress(unsigned int decodedFiles, unsigned int totalFiles);
+  /**
+   * @brief fileDecoded is emitted by the decoder thread when it has decoded a file (only used internally)
    */
-  void sampleDatabaseChanged(const SampleDatabase& sampleDatabase);
+  void fileDecoded();
+  /**
+   * @brief whistlesProposed is emitted when whistle labels have been proposed for channels that are not completely labeled
+   * @param proposals the proposed labels
+   */
+  void whistlesProposed(const QVector<WhistleProposal>& proposals);
   /**
    * @brief channelChanged is emitted when the active channel has changed
    * @param audioChannel a reference to the new audio channel
@@ -50,17 +103,41 @@ signals:
    * @param results the results of the evaluation
    */
   void evaluationDone(const EvaluationResults& results);
+  /**
+   * @brief overlayStarted is emitted when the overlay of the active channel is discarded (before new results are streamed)
+   */
+  void overlayStarted();
+  /**
+   * @brief overlayProgress is emitted (from a background thread) when the overlay detector has emitted something
+   * @param output the detections and scores that have been emitted since the last signal
+   */
+  void overlayProgress(const DetectorOutput& output);
 public slots:
   /**
-   * @brief evaluateDetector evaluates a detector on the currently opened database
+   * @brief evaluateDetector evaluates a detector on the currently opened database (and at each SNR of the noise augmentation)
    * @param name the name of the detector
    */
   void evaluateDetector(const QString& name);
   /**
-   * @brief trainDetector trains a detector on the currently opened database
+   * @brief trainDetector trains a detector on the currently opened database (and its noisy copies from the noise augmentation)
    * @param name the name of the detector
    */
   void trainDetector(const QString& name);
+  /**
+   * @brief setNoiseAugmentation replaces the noise augmentation that is used for training and evaluation
+   * @param fileName the name of the file that specifies the noise augmentation (an empty string disables the augmentation)
+   */
+  void setNoiseAugmentation(const QString& fileName);
+  /**
+   * @brief sweepParameters evaluates a detector with many parameter configurations on the currently opened database
+   * @param fileName the name of the file that specifies the parameter sweep
+   */
+  void sweepParameters(const QString& fileName);
+  /**
+   * @brief prelabel proposes whistle labels for all channels that are not completely labeled
+   * @param name the name of the detector that finds the whistles
+   */
+  void prelabel(const QString& name);
   /**
    * @brief changeDatabase opens or closes the sample database
    * @param readFileName the name of the new database file or an empty string
@@ -73,6 +150,31 @@ public slots:
    * @param channel the channel number of the channel in the file
    */
   void selectChannel(const QString& path, const unsigned int channel);
+  /**
+   * @brief removeAudioFile removes a file from the sample database
+   * @param id the id of the file
+   */
+  void removeAudioFile(unsigned int id);
+  /**
+   * @brief addWhistleLabel adds a label to a channel
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param start the first sample belonging to the whistle
+   * @param end the first sample not belonging to the whistle anymore
+   */
+  void addWhistleLabel(unsigned int id, unsigned int channel, int start, int end);
+  /**
+   * @brief removeWhistleLabel removes a label from a channel
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param labelIndex the index of the label in the channel
+   */
+  void removeWhistleLabel(unsigned int id, unsigned int channel, int labelIndex);
+  /**
+   * @brief selectOverlayDetector selects the detector that is run on the active channel in the background
+   * @param name the name of the detector or an empty string if no detector should be run
+   */
+  void selectOverlayDetector(const QString& name);
   /**
    * @brief setPlaybackVolume sets the volume at which channels are played back
    * @param volume a number between 0 and 1
@@ -91,7 +193,49 @@ private slots:
    * @brief updatePlaybackPosition emits a playbackPositionChanged signal
    */
   void updatePlaybackPosition();
+  /**
+   * @brief installDecodedFiles moves the samples of decoded files into the database
+   */
+  void installDecodedFiles();
 private:
+  /**
+   * @brief startDecoding starts to decode all files of the database in the background
+   */
+  void startDecoding();
+  /**
+   * @brief stopDecoding cancels the decoder and discards everything it has not installed yet
+   */
+  void stopDecoding();
+  /**
+   * @brief waitForDecoding waits until all files of the database have been decoded and installs them
+   * @return a copy of the database without the files that could not be decoded (they are reported, the samples are shared)
+   */
+  SampleDatabase waitForDecoding();
+  /**
+   * @brief runDecoder is the main function of the decoder thread
+   */
+  void runDecoder();
+  /**
+   * @brief updateActiveChannelLabels copies the labels of a channel to the active channel if it is the same channel
+   * @param audioFile the file of the channel
+   * @param audioChannel the channel whose labels have changed
+   */
+  void updateActiveChannelLabels(const AudioFile& audioFile, const AudioChannel& audioChannel);
+  /**
+   * @brief startOverlay runs the overlay detector on the active channel (or takes its output from the cache)
+   */
+  void startOverlay();
+  /**
+   * @brief stopOverlay cancels the overlay detector and waits until it has stopped
+   */
+  void stopOverlay();
+  /**
+   * @brief runOverlay is the main function of the overlay thread
+   * @param detector the detector that is run
+   * @param file a file that contains only the active channel
+   * @param key the key under which the complete output is cached
+   */
+  void runOverlay(std::shared_ptr<WhistleDetectorBase> detector, AudioFile file, std::string key);
   /// info about the audio playback device
   QAudioDeviceInfo audioDeviceInfo;
   /// the audio output
@@ -102,4 +246,48 @@ private:
   QByteArray audioOutputArray;
   /// the open sample database
   SampleDatabase sampleDatabase;
+  /// the thread that decodes the files of the database
+  std::thread decoderThread;
+  /// whether the decoder thread should stop
+  std::atomic<bool> decoderCancelled;
+  /// the mutex that protects the decoder queue and the decoded files
+  std::mutex decoderMutex;
+  /// the files that have not been decoded yet (copies of the files in the database without samples)
+  std::deque<AudioFile> decoderQueue;
+  /// the files that have been decoded but whose samples have not been moved into the database yet
+  std::vector<AudioFile> decodedFiles;
+  /// the number of files that are decoded since the database has been opened
+  unsigned int filesToDecode = 0;
+  /// the number of files that have been installed since the database has been opened
+  unsigned int filesInstalled = 0;
+  /// the path of a file whose channel is selected as soon as the file has been decoded (empty if there is none)
+  QString pendingChannelPath;
+  /// the channel number of the channel that is selected as soon as its file has been decoded
+  unsigned int pendingChannel = 0;
+  /// a file that contains only the active channel (no channels if none is active)
+  AudioFile activeChannelFile;
+  /// the name of the overlay detector (empty if there is none)
+  std::string overlayDetectorName;
+  /// the thread that runs the overlay detector
+  std::thread overlayThread;
+  /// whether the overlay thread should stop
+  std::atomic<bool> overlayCancelled;
+  /// the mutex that protects the overlay cache
+  std::mutex overlayCacheMutex;
+  /**
+   * @struct OverlayCacheEntry is an output of the overlay detector in the cache
+   */
+  struct OverlayCacheEntry
+  {
+    /// the complete output
+    std::shared_ptr<const DetectorOutput> output;
+    /// the position of the output in the usage list
+    std::list<std::string>::iterator usage;
+  };
+  /// the complete outputs of the overlay detector by detector, version, parameters and channel
+  std::map<std::string, OverlayCacheEntry> overlayCache;
+  /// the keys of the cached overlay outputs from the most to the least recently used one
+  std::list<std::string> overlayCacheUsage;
+  /// the noise augmentation that is used for training and evaluation (nullptr if there is none)
+  std::unique_ptr<NoiseAugmentation> noiseAugmentation;
 };
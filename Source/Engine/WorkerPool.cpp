@@ -0,0 +1,113 @@
+/**
+ * @file WorkerPool.cpp implements methods of the worker pool class
+ */
+
+#include <algorithm>
+
+#include "Detector/Trace.hpp"
+
+#include "WorkerPool.hpp"
+
+
+WorkerPool::WorkerPool(const unsigned int numberOfThreads)
+  : nextTask(0)
+{
+  const unsigned int n = (numberOfThreads != 0) ? numberOfThreads : std::max(std::thread::hardware_concurrency(), 1U);
+  for (unsigned int i = 1; i < n; i++)
+  {
+    threads.emplace_back(&WorkerPool::workerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  startCondition.notify_all();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void WorkerPool::run(const unsigned int numberOfTasks, const std::function<void(unsigned int)>& task)
+{
+  if (numberOfTasks == 0)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentTask = &task;
+    this->numberOfTasks = numberOfTasks;
+    nextTask = 0;
+    exception = nullptr;
+    busyThreads = static_cast<unsigned int>(threads.size());
+    runNumber++;
+  }
+  startCondition.notify_all();
+  work();
+  std::exception_ptr e;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]{ return busyThreads == 0; });
+    currentTask = nullptr;
+    std::swap(e, exception);
+  }
+  if (e)
+  {
+    std::rethrow_exception(e);
+  }
+}
+
+unsigned int WorkerPool::getNumberOfThreads() const
+{
+  return static_cast<unsigned int>(threads.size()) + 1;
+}
+
+void WorkerPool::workerLoop()
+{
+  Trace::setThreadName("Worker pool");
+  unsigned int lastRunNumber = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      startCondition.wait(lock, [this, lastRunNumber]{ return stop || runNumber != lastRunNumber; });
+      if (stop)
+      {
+        return;
+      }
+      lastRunNumber = runNumber;
+    }
+    work();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--busyThreads == 0)
+      {
+        doneCondition.notify_one();
+      }
+    }
+  }
+}
+
+void WorkerPool::work()
+{
+  for (unsigned int i = nextTask++; i < numberOfTasks; i = nextTask++)
+  {
+    try
+    {
+      (*currentTask)(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!exception)
+      {
+        exception = std::current_exception();
+      }
+    }
+  }
+}
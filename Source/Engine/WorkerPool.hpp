@@ -0,0 +1,75 @@
+/**
+ * @file WorkerPool.hpp declares the worker pool class
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @class WorkerPool is a set of persistent threads that execute independent tasks in parallel
+ */
+class WorkerPool final
+{
+public:
+  /**
+   * @brief WorkerPool starts the threads
+   * @param numberOfThreads the number of threads that execute tasks (including the caller of run, 0 means one per core)
+   */
+  explicit WorkerPool(unsigned int numberOfThreads = 0);
+  /**
+   * @brief ~WorkerPool stops the threads
+   */
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  /**
+   * @brief run executes tasks on all threads (including the calling one) and returns when all of them are done
+   * @param numberOfTasks the number of tasks
+   * @param task the function that is called once for each task index in [0, numberOfTasks)
+   */
+  void run(unsigned int numberOfTasks, const std::function<void(unsigned int)>& task);
+  /**
+   * @brief getNumberOfThreads returns the number of threads that execute tasks (including the caller of run)
+   * @return the number of threads that execute tasks
+   */
+  unsigned int getNumberOfThreads() const;
+private:
+  /**
+   * @brief workerLoop is the main function of each thread of the pool
+   */
+  void workerLoop();
+  /**
+   * @brief work executes tasks of the current run until there are none left
+   */
+  void work();
+  /// the threads of the pool (the caller of run is an additional worker)
+  std::vector<std::thread> threads;
+  /// the mutex that protects the state below
+  std::mutex mutex;
+  /// notifies the threads that a new run has started or that they should stop
+  std::condition_variable startCondition;
+  /// notifies the caller of run that all threads are done
+  std::condition_variable doneCondition;
+  /// the function that executes a task of the current run
+  const std::function<void(unsigned int)>* currentTask = nullptr;
+  /// the number of tasks in the current run
+  unsigned int numberOfTasks = 0;
+  /// the index of the next task that has not been started
+  std::atomic<unsigned int> nextTask;
+  /// the number of the current run (threads wait until it changes)
+  unsigned int runNumber = 0;
+  /// the number of threads that have not finished the current run
+  unsigned int busyThreads = 0;
+  /// the first exception that has been thrown by a task of the current run
+  std::exception_ptr exception;
+  /// whether the threads should terminate
+  bool stop = false;
+};
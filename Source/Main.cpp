@@ -2,18 +2,248 @@
  * @file Main.cpp implements the main function
  */
 
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+#include <QCoreApplication>
+#include <QStringList>
+
+#include "Detector/DetectorOutput.hpp"
+#include "Detector/Trace.hpp"
 #include "Engine/AudioChannel.hpp"
+#include "Engine/AudioFileInfo.hpp"
+#include "Engine/Benchmark.hpp"
+#include "Engine/BenchmarkHistory.hpp"
+#include "Engine/CorpusGenerator.hpp"
 #include "Engine/EvaluationResults.hpp"
+#include "Engine/Prelabeler.hpp"
 #include "Engine/SampleDatabase.hpp"
+#include "Engine/ShardedEvaluation.hpp"
 
 #include "WhistleLabApplication.hpp"
 
 
+namespace
+{
+  /**
+   * @brief evaluate evaluates a detector without the GUI as coordinator or worker of a sharded evaluation
+   *
+   * The arguments are --evaluate <database> <detector> [--workers <n>] [<parameter>=<value> ...] for the coordinator.
+   * Workers are started by the coordinator with --evaluation-worker instead of --evaluate.
+   * @param arguments the command line arguments
+   * @return the exit code of the program
+   */
+  int evaluate(const QStringList& arguments)
+  {
+    const bool worker = arguments[1] == "--evaluation-worker";
+    unsigned int numberOfWorkers = std::thread::hardware_concurrency();
+    ParameterMap parameters;
+    QStringList positionalArguments;
+    for (int i = 2; i < arguments.size(); i++)
+    {
+      if (!worker && arguments[i] == "--workers" && i + 1 < arguments.size())
+      {
+        numberOfWorkers = arguments[++i].toUInt();
+      }
+      else if (!ShardedEvaluation::parseParameter(arguments[i], parameters))
+      {
+        positionalArguments << arguments[i];
+      }
+    }
+    if (positionalArguments.size() != 2)
+    {
+      std::cerr << "Usage: whistle --evaluate <database> <detector> [--workers <n>] [<parameter>=<value> ...]\n";
+      return 2;
+    }
+    ShardedEvaluation evaluation(positionalArguments[0], positionalArguments[1].toStdString(), parameters);
+    if (worker)
+    {
+      return evaluation.work();
+    }
+    try
+    {
+      EvaluationResults results;
+      return evaluation.run(results, numberOfWorkers) ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+  }
+
+  /**
+   * @brief generateCorpus synthesizes a corpus without the GUI
+   *
+   * The arguments are --generate-corpus <specification>.
+   * @param arguments the command line arguments
+   * @return the exit code of the program
+   */
+  int generateCorpus(const QStringList& arguments)
+  {
+    if (arguments.size() != 3)
+    {
+      std::cerr << "Usage: whistle --generate-corpus <specification>\n";
+      return 2;
+    }
+    try
+    {
+      CorpusGenerator generator;
+      generator.readFromFile(arguments[2]);
+      generator.run();
+      return 0;
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+  }
+
+  /**
+   * @brief benchmark benchmarks a detector without the GUI and appends the record to the benchmark history
+   *
+   * The arguments are --benchmark <database> <detector> [--commit <id>] [--history <file>] [<parameter>=<value> ...].
+   * @param arguments the command line arguments
+   * @return the exit code of the program
+   */
+  int benchmark(const QStringList& arguments)
+  {
+    QString commit;
+    QString historyFileName = BenchmarkHistory::defaultFileName;
+    ParameterMap parameters;
+    QStringList positionalArguments;
+    for (int i = 2; i < arguments.size(); i++)
+    {
+      if (arguments[i] == "--commit" && i + 1 < arguments.size())
+      {
+        commit = arguments[++i];
+      }
+      else if (arguments[i] == "--history" && i + 1 < arguments.size())
+      {
+        historyFileName = arguments[++i];
+      }
+      else if (!ShardedEvaluation::parseParameter(arguments[i], parameters))
+      {
+        positionalArguments << arguments[i];
+      }
+    }
+    if (positionalArguments.size() != 2)
+    {
+      std::cerr << "Usage: whistle --benchmark <database> <detector> [--commit <id>] [--history <file>] [<parameter>=<value> ...]\n";
+      return 2;
+    }
+    try
+    {
+      SampleDatabase db;
+      db.readFromFile(positionalArguments[0]);
+      BenchmarkRecord record = Benchmark::run(db, positionalArguments[1].toStdString(), parameters);
+      if (!commit.isEmpty())
+      {
+        record.commit = commit.toStdString();
+      }
+      BenchmarkHistory(historyFileName).append(record);
+      const float recall = record.positives > 0 ? static_cast<float>(record.truePositives) / static_cast<float>(record.positives) : 0.f;
+      std::cout << "Benchmarked " << record.detector << " at " << record.commit << " on " << record.machineDescription << '\n'
+                << "Recall: " << recall << ", false positives: " << record.falsePositives << ", ROC area: " << record.rocArea
+                << ", average delay: " << record.averageDelay << " s\n";
+      // The detectors must not allocate memory per buffer once they have been set up for a file.
+      if (record.steadyStateAllocations > 0)
+      {
+        std::cerr << record.detector << " has made " << record.steadyStateAllocations << " allocations ("
+                  << record.steadyStateAllocatedBytes << " bytes) in " << record.allocationTrackedBuffers
+                  << " buffers after the warm-up!\n";
+        return 1;
+      }
+      return 0;
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      return 1;
+    }
+  }
+
+  /**
+   * @brief compareBenchmarks compares two commits in the benchmark history
+   *
+   * The arguments are --compare-benchmarks <detector> [<baseline> [<candidate>]] [--history <file>].
+   * @param arguments the command line arguments
+   * @return 0 if there is no regression, 1 if there is a regression and 2 if the comparison is not possible
+   */
+  int compareBenchmarks(const QStringList& arguments)
+  {
+    QString historyFileName = BenchmarkHistory::defaultFileName;
+    QStringList positionalArguments;
+    for (int i = 2; i < arguments.size(); i++)
+    {
+      if (arguments[i] == "--history" && i + 1 < arguments.size())
+      {
+        historyFileName = arguments[++i];
+      }
+      else
+      {
+        positionalArguments << arguments[i];
+      }
+    }
+    if (positionalArguments.isEmpty() || positionalArguments.size() > 3)
+    {
+      std::cerr << "Usage: whistle --compare-benchmarks <detector> [<baseline> [<candidate>]] [--history <file>]\n";
+      return 2;
+    }
+    try
+    {
+      const std::string baseline = positionalArguments.size() > 1 ? positionalArguments[1].toStdString() : std::string();
+      const std::string candidate = positionalArguments.size() > 2 ? positionalArguments[2].toStdString() : std::string();
+      return BenchmarkHistory(historyFileName).compare(positionalArguments[0].toStdString(), baseline, candidate) ? 1 : 0;
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << '\n';
+      return 2;
+    }
+  }
+}
+
 int main(int argc, char* argv[])
 {
+  // Each worker of a sharded evaluation writes its own trace next to the one of the coordinator.
+  const char* traceVariable = std::getenv("WHISTLELAB_TRACE");
+  std::string traceFileName = traceVariable != nullptr ? traceVariable : "";
+  if (!traceFileName.empty() && argc > 1 && std::strcmp(argv[1], "--evaluation-worker") == 0)
+  {
+    traceFileName += "." + std::to_string(QCoreApplication::applicationPid());
+  }
+  const Trace::Session traceSession(traceFileName);
+  Trace::setThreadName("Main");
+  if (argc > 1 && (std::strcmp(argv[1], "--evaluate") == 0 || std::strcmp(argv[1], "--evaluation-worker") == 0))
+  {
+    QCoreApplication app(argc, argv);
+    return evaluate(QCoreApplication::arguments());
+  }
+  if (argc > 1 && std::strcmp(argv[1], "--generate-corpus") == 0)
+  {
+    QCoreApplication app(argc, argv);
+    return generateCorpus(QCoreApplication::arguments());
+  }
+  if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0)
+  {
+    QCoreApplication app(argc, argv);
+    return benchmark(QCoreApplication::arguments());
+  }
+  if (argc > 1 && std::strcmp(argv[1], "--compare-benchmarks") == 0)
+  {
+    QCoreApplication app(argc, argv);
+    return compareBenchmarks(QCoreApplication::arguments());
+  }
   qRegisterMetaType<AudioChannel>();
+  qRegisterMetaType<AudioFileInfo>();
+  qRegisterMetaType<DetectorOutput>();
   qRegisterMetaType<EvaluationResults>();
-  qRegisterMetaType<SampleDatabase>();
+  qRegisterMetaType<QVector<WhistleProposal>>();
   WhistleLabApplication app(argc, argv);
 
   return static_cast<QApplication&>(app).exec();
@@ -2,10 +2,17 @@
  * @file LabelWidget.cpp implements methods for the label widget class
  */
 
+#include <QComboBox>
 #include <QHBoxLayout>
 #include <QPushButton>
+#include <QVBoxLayout>
 #include <QWidget>
 
+#include "Detector/WhistleDetectorFactoryBase.hpp"
+
+#include "SpectrogramView.hpp"
+#include "WaveformView.hpp"
+
 #include "LabelWidget.hpp"
 
 
@@ -17,23 +24,56 @@ LabelWidget::LabelWidget(QWidget* parent)
 
   layoutWidget = new QWidget(this);
 
+  spectrogramView = new SpectrogramView(layoutWidget);
+  waveformView = new WaveformView(layoutWidget);
+  connect(waveformView, &WaveformView::viewChanged, spectrogramView, &SpectrogramView::setView);
+
   playButton = new QPushButton("Play", layoutWidget);
   connect(playButton, &QPushButton::clicked, this, &LabelWidget::playClicked);
 
   pauseButton = new QPushButton("Pause", layoutWidget);
   connect(pauseButton, &QPushButton::clicked, this, &LabelWidget::pauseClicked);
 
-  buttonLayout = new QHBoxLayout(layoutWidget);
+  overlayComboBox = new QComboBox(layoutWidget);
+  overlayComboBox->addItem(tr("No Overlay"), QString());
+  for (auto& name : WhistleDetectorFactoryBase::getDetectorNames())
+  {
+    overlayComboBox->addItem(QString::fromStdString(name), QString::fromStdString(name));
+  }
+  connect(overlayComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+    [this]{ emit overlayDetectorSelected(overlayComboBox->currentData().toString()); });
+
+  buttonLayout = new QHBoxLayout;
   buttonLayout->addWidget(playButton);
   buttonLayout->addWidget(pauseButton);
-  layoutWidget->setLayout(buttonLayout);
+  buttonLayout->addWidget(overlayComboBox);
+
+  mainLayout = new QVBoxLayout(layoutWidget);
+  mainLayout->addWidget(spectrogramView, 2);
+  mainLayout->addWidget(waveformView, 1);
+  mainLayout->addLayout(buttonLayout);
+  layoutWidget->setLayout(mainLayout);
   setWidget(layoutWidget);
 }
 
-void LabelWidget::updateChannel(const AudioChannel&)
+void LabelWidget::updateChannel(const AudioChannel& audioChannel)
+{
+  spectrogramView->setChannel(audioChannel);
+  waveformView->setChannel(audioChannel);
+}
+
+void LabelWidget::updatePlaybackPosition(const unsigned int pos)
+{
+  spectrogramView->setPlaybackPosition(pos);
+  waveformView->setPlaybackPosition(pos);
+}
+
+void LabelWidget::clearOverlay()
 {
+  waveformView->clearOverlay();
 }
 
-void LabelWidget::updatePlaybackPosition(const unsigned int)
+void LabelWidget::appendOverlay(const DetectorOutput& output)
 {
+  waveformView->appendOverlay(output);
 }
@@ -6,13 +6,18 @@
 
 #include <QDockWidget>
 
+#include "Detector/DetectorOutput.hpp"
 #include "Engine/AudioChannel.hpp"
 
 
+class QComboBox;
 class QHBoxLayout;
 class QPushButton;
 class QString;
+class QVBoxLayout;
 class QWidget;
+class SpectrogramView;
+class WaveformView;
 
 /**
  * @class LabelWidget is a widget that allows labeling of audio data
@@ -35,6 +40,11 @@ signals:
    * @brief pauseClicked is emitted when the pause button is clicked
    */
   void pauseClicked();
+  /**
+   * @brief overlayDetectorSelected is emitted when a detector has been chosen for the overlay
+   * @param name the name of the detector or an empty string if no detector should be run
+   */
+  void overlayDetectorSelected(const QString& name);
 public slots:
   /**
    * @brief updateChannel updates the channel that is labeled
@@ -46,7 +56,18 @@ public slots:
    * @param pos the new playback position in samples
    */
   void updatePlaybackPosition(const unsigned int pos);
+  /**
+   * @brief clearOverlay removes the output of the overlay detector
+   */
+  void clearOverlay();
+  /**
+   * @brief appendOverlay adds output of the overlay detector
+   * @param output the detections and scores that have been emitted since the last update
+   */
+  void appendOverlay(const DetectorOutput& output);
 private:
+  /// the layout that contains the views and the buttons
+  QVBoxLayout* mainLayout = nullptr;
   /// the layout that contains the buttons
   QHBoxLayout* buttonLayout = nullptr;
   /// a widget that contains the layout because a dock widget already has a layout
@@ -55,4 +76,10 @@ private:
   QPushButton* playButton = nullptr;
   /// the pause button
   QPushButton* pauseButton = nullptr;
+  /// the selection of the overlay detector
+  QComboBox* overlayComboBox = nullptr;
+  /// the view of the spectrogram of the channel (follows the waveform view)
+  SpectrogramView* spectrogramView = nullptr;
+  /// the view of the waveform of the channel
+  WaveformView* waveformView = nullptr;
 };
@@ -15,6 +15,7 @@
 #include "Engine/WhistleLabEngine.hpp"
 
 #include "LabelWidget.hpp"
+#include "ProposalWidget.hpp"
 #include "SampleDatabaseWidget.hpp"
 
 #include "MainWindow.hpp"
@@ -49,6 +50,13 @@ MainWindow::MainWindow(QWidget* parent)
     connect(action, &QAction::triggered, this,
       [this, name]{ emit evaluateDetectorClicked(QString::fromStdString(name)); });
   }
+  evaluateMenu->addSeparator();
+  QAction* sweepAction = evaluateMenu->addAction(tr("&Parameter Sweep..."));
+  connect(sweepAction, &QAction::triggered, this, &MainWindow::sweep);
+  noiseAugmentationAction = new QAction(tr("&Noise Augmentation..."), this);
+  noiseAugmentationAction->setCheckable(true);
+  connect(noiseAugmentationAction, &QAction::triggered, this, &MainWindow::selectNoiseAugmentation);
+  evaluateMenu->addAction(noiseAugmentationAction);
 
   trainMenu = menuBar()->addMenu(tr("&Train"));
   trainMenu->setEnabled(false);
@@ -58,6 +66,17 @@ MainWindow::MainWindow(QWidget* parent)
     connect(action, &QAction::triggered, this,
       [this, name]{ emit trainDetectorClicked(QString::fromStdString(name)); });
   }
+  trainMenu->addSeparator();
+  trainMenu->addAction(noiseAugmentationAction);
+
+  prelabelMenu = menuBar()->addMenu(tr("&Pre-label"));
+  prelabelMenu->setEnabled(false);
+  for (auto& name : detectorNames)
+  {
+    QAction* action = prelabelMenu->addAction(QString::fromStdString(name));
+    connect(action, &QAction::triggered, this,
+      [this, name]{ emit prelabelClicked(QString::fromStdString(name)); });
+  }
 
   viewMenu = menuBar()->addMenu(tr("&View"));
   connect(viewMenu, &QMenu::aboutToShow, this, &MainWindow::updateViewMenu);
@@ -70,12 +89,39 @@ MainWindow::MainWindow(QWidget* parent)
   connect(aboutQtAction, &QAction::triggered, qApp, &QApplication::aboutQt);
 
   sampleDatabaseWidget = new SampleDatabaseWidget(this);
-  connect(this, &MainWindow::sampleDatabaseChanged,
-    sampleDatabaseWidget, &SampleDatabaseWidget::updateSampleDatabase);
+  connect(this, &MainWindow::sampleDatabaseOpened,
+    sampleDatabaseWidget, &SampleDatabaseWidget::openSampleDatabase);
+  connect(this, &MainWindow::sampleDatabaseClosed,
+    sampleDatabaseWidget, &SampleDatabaseWidget::closeSampleDatabase);
+  connect(this, &MainWindow::audioFileAdded,
+    sampleDatabaseWidget, &SampleDatabaseWidget::addAudioFile);
+  connect(this, &MainWindow::audioFileChanged,
+    sampleDatabaseWidget, &SampleDatabaseWidget::changeAudioFile);
+  connect(this, &MainWindow::audioFileRemoved,
+    sampleDatabaseWidget, &SampleDatabaseWidget::removeAudioFile);
+  connect(this, &MainWindow::decodingProgress,
+    sampleDatabaseWidget, &SampleDatabaseWidget::updateDecodingProgress);
+  connect(sampleDatabaseWidget, &SampleDatabaseWidget::audioFileRemovalRequested,
+    this, &MainWindow::removeAudioFileClicked);
+  connect(sampleDatabaseWidget, &SampleDatabaseWidget::whistleLabelRemovalRequested,
+    this, &MainWindow::removeWhistleLabelClicked);
   connect(sampleDatabaseWidget, &SampleDatabaseWidget::channelSelectedForLabeling,
     this, &MainWindow::channelSelected);
   addDockWidget(Qt::LeftDockWidgetArea, sampleDatabaseWidget);
 
+  proposalWidget = new ProposalWidget(this);
+  connect(this, &MainWindow::whistlesProposed,
+    proposalWidget, &ProposalWidget::addProposals);
+  connect(this, &MainWindow::sampleDatabaseClosed,
+    proposalWidget, &ProposalWidget::clearProposals);
+  connect(this, &MainWindow::audioFileRemoved,
+    proposalWidget, &ProposalWidget::removeAudioFile);
+  connect(proposalWidget, &ProposalWidget::channelSelectedForLabeling,
+    this, &MainWindow::channelSelected);
+  connect(proposalWidget, &ProposalWidget::proposalAccepted,
+    this, &MainWindow::addWhistleLabelClicked);
+  addDockWidget(Qt::LeftDockWidgetArea, proposalWidget);
+
   labelWidget = new LabelWidget(this);
   connect(this, &MainWindow::channelChanged,
     labelWidget, &LabelWidget::updateChannel);
@@ -85,6 +131,12 @@ MainWindow::MainWindow(QWidget* parent)
     this, &MainWindow::playClicked);
   connect(labelWidget, &LabelWidget::pauseClicked,
     this, &MainWindow::pauseClicked);
+  connect(labelWidget, &LabelWidget::overlayDetectorSelected,
+    this, &MainWindow::overlayDetectorSelected);
+  connect(this, &MainWindow::overlayStarted,
+    labelWidget, &LabelWidget::clearOverlay);
+  connect(this, &MainWindow::overlayProgress,
+    labelWidget, &LabelWidget::appendOverlay);
   addDockWidget(Qt::RightDockWidgetArea, labelWidget);
 
   setWindowTitle(tr("WhistleLab"));
@@ -139,6 +191,7 @@ void MainWindow::openFile(const QString& fileName)
   fileCloseAction->setEnabled(true);
   evaluateMenu->setEnabled(true);
   trainMenu->setEnabled(true);
+  prelabelMenu->setEnabled(true);
 }
 
 void MainWindow::closeFile()
@@ -146,10 +199,43 @@ void MainWindow::closeFile()
   fileCloseAction->setEnabled(false);
   evaluateMenu->setEnabled(false);
   trainMenu->setEnabled(false);
+  prelabelMenu->setEnabled(false);
 
   emit fileChanged("", "");
 }
 
+void MainWindow::sweep()
+{
+  QString fileName = QFileDialog::getOpenFileName(this, tr("Open Parameter Sweep"), settings.value("SweepDirectory", "").toString(),
+    tr("Parameter Sweeps (*.json)"));
+  if (fileName.isEmpty())
+  {
+    return;
+  }
+  settings.setValue("SweepDirectory", QFileInfo(fileName).dir().path());
+
+  emit sweepClicked(fileName);
+}
+
+void MainWindow::selectNoiseAugmentation(const bool checked)
+{
+  if (!checked)
+  {
+    emit noiseAugmentationChanged("");
+    return;
+  }
+  QString fileName = QFileDialog::getOpenFileName(this, tr("Open Noise Augmentation"), settings.value("NoiseAugmentationDirectory", "").toString(),
+    tr("Noise Augmentations (*.json)"));
+  if (fileName.isEmpty())
+  {
+    noiseAugmentationAction->setChecked(false);
+    return;
+  }
+  settings.setValue("NoiseAugmentationDirectory", QFileInfo(fileName).dir().path());
+
+  emit noiseAugmentationChanged(fileName);
+}
+
 void MainWindow::updateFileMenu()
 {
   fileMenu->clear();
@@ -180,6 +266,11 @@ void MainWindow::updateViewMenu()
     viewMenu->addAction(sampleDatabaseWidget->toggleViewAction());
   }
 
+  if (proposalWidget != nullptr)
+  {
+    viewMenu->addAction(proposalWidget->toggleViewAction());
+  }
+
   if (labelWidget != nullptr)
   {
     viewMenu->addAction(labelWidget->toggleViewAction());
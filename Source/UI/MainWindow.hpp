@@ -7,16 +7,21 @@
 #include <QMainWindow>
 #include <QSettings>
 #include <QStringList>
+#include <QVector>
 
 
+class AudioFileInfo;
+struct DetectorOutput;
 class EvaluationResults;
 class LabelWidget;
+class ProposalWidget;
 class SampleDatabaseWidget;
 class QAction;
 class QCloseEvent;
 class QMenu;
 class QString;
 class QWidget;
+struct WhistleProposal;
 
 /**
  * @class MainWindow is the Qt main window class
@@ -42,10 +47,47 @@ signals:
    */
   void fileChanged(const QString& readFileName, const QString& writeFileName);
   /**
-   * @brief sampleDatabaseChanged signals that the sample database has changed
-   * @param sampleDatabase a reference to the new sample database
+   * @brief sampleDatabaseOpened signals that a sample database has been opened
+   * @param name the name of the sample database
    */
-  void sampleDatabaseChanged(const SampleDatabase& sampleDatabase);
+  void sampleDatabaseOpened(const QString& name);
+  /**
+   * @brief sampleDatabaseClosed signals that the sample database has been closed
+   */
+  void sampleDatabaseClosed();
+  /**
+   * @brief audioFileAdded signals that a file has been added to the sample database
+   * @param info a description of the file
+   */
+  void audioFileAdded(const AudioFileInfo& info);
+  /**
+   * @brief audioFileChanged signals that the labels of a file have changed
+   * @param info the new description of the file
+   */
+  void audioFileChanged(const AudioFileInfo& info);
+  /**
+   * @brief audioFileRemoved signals that a file has been removed from the sample database
+   * @param id the id of the file
+   */
+  void audioFileRemoved(unsigned int id);
+  /**
+   * @brief decodingProgress signals that a file of the sample database has been decoded
+   * @param decodedFiles the number of files that have been decoded
+   * @param totalFiles the number of files that are decoded in total
+   */
+  void decodingProgress(unsigned int decodedFiles, unsigned int totalFiles);
+  /**
+   * @brief removeAudioFileClicked is emitted when a file should be removed from the sample database
+   * @param id the id of the file
+   */
+  void removeAudioFileClicked(unsigned int id);
+  /**
+   * @brief removeWhistleLabelClicked is emitted when a label should be removed
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param labelIndex the index of the label in the channel
+   */
+  void removeWhistleLabelClicked(unsigned int id, unsigned int channel, int labelIndex);
   /**
    * @brief evaluateDetectorClicked is emitted when an evaluate button is clicked
    * @param name the name of the detector that is to be evaluated
@@ -56,6 +98,34 @@ signals:
    * @param name the name of the detector that is to be trained
    */
   void trainDetectorClicked(const QString& name);
+  /**
+   * @brief prelabelClicked is emitted when a pre-label button is clicked
+   * @param name the name of the detector that finds the whistles
+   */
+  void prelabelClicked(const QString& name);
+  /**
+   * @brief whistlesProposed is emitted when whistle labels have been proposed
+   * @param proposals the proposed labels
+   */
+  void whistlesProposed(const QVector<WhistleProposal>& proposals);
+  /**
+   * @brief addWhistleLabelClicked is emitted when a label should be added
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param start the first sample belonging to the whistle
+   * @param end the first sample not belonging to the whistle anymore
+   */
+  void addWhistleLabelClicked(unsigned int id, unsigned int channel, int start, int end);
+  /**
+   * @brief sweepClicked is emitted when a parameter sweep specification has been chosen
+   * @param fileName the name of the file that specifies the parameter sweep
+   */
+  void sweepClicked(const QString& fileName);
+  /**
+   * @brief noiseAugmentationChanged is emitted when a noise augmentation specification has been chosen or disabled
+   * @param fileName the name of the file that specifies the noise augmentation or an empty string
+   */
+  void noiseAugmentationChanged(const QString& fileName);
   /**
    * @brief channelSelected is emitted when a channel is selected
    * @param path the path of the audio file in the sample database
@@ -85,6 +155,20 @@ signals:
    * @param results the results of the evaluation
    */
   void evaluationDone(const EvaluationResults& results);
+  /**
+   * @brief overlayDetectorSelected is emitted when a detector has been chosen for the overlay
+   * @param name the name of the detector or an empty string if no detector should be run
+   */
+  void overlayDetectorSelected(const QString& name);
+  /**
+   * @brief overlayStarted is emitted when the overlay of the active channel is discarded
+   */
+  void overlayStarted();
+  /**
+   * @brief overlayProgress is emitted when the overlay detector has emitted something
+   * @param output the detections and scores that have been emitted since the last signal
+   */
+  void overlayProgress(const DetectorOutput& output);
 private slots:
   /**
    * @brief about shows a message box with information about this program
@@ -103,6 +187,15 @@ private slots:
    * @brief closeFile is called by a close action
    */
   void closeFile();
+  /**
+   * @brief sweep is called by a parameter sweep action
+   */
+  void sweep();
+  /**
+   * @brief selectNoiseAugmentation is called by the noise augmentation action
+   * @param checked whether a noise augmentation should be used
+   */
+  void selectNoiseAugmentation(bool checked);
   /**
    * @brief updateFileMenu updates the recent files in the file menu
    */
@@ -125,12 +218,16 @@ private:
   QAction* fileCloseAction = nullptr;
   /// an action that terminates the program
   QAction* fileExitAction = nullptr;
+  /// an action that chooses or disables a noise augmentation
+  QAction* noiseAugmentationAction = nullptr;
   /// the menu containing file actions
   QMenu* fileMenu = nullptr;
   /// the menu containing evaluate actions
   QMenu* evaluateMenu = nullptr;
   /// the menu containing train actions
   QMenu* trainMenu = nullptr;
+  /// the menu containing pre-label actions
+  QMenu* prelabelMenu = nullptr;
   /// the menu containing view actions
   QMenu* viewMenu = nullptr;
   /// the menu containing help actions
@@ -141,6 +238,8 @@ private:
   QStringList recentFiles;
   /// the widget that allows labeling of audio data
   LabelWidget* labelWidget = nullptr;
+  /// the widget in which proposed labels are reviewed
+  ProposalWidget* proposalWidget = nullptr;
   /// the widget that views the sample database
   SampleDatabaseWidget* sampleDatabaseWidget = nullptr;
 };
@@ -0,0 +1,121 @@
+/**
+ * @file ProposalWidget.cpp implements methods for the proposal widget class
+ */
+
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include "ProposalWidget.hpp"
+
+
+ProposalWidget::ProposalWidget(QWidget* parent)
+  : QDockWidget(parent)
+{
+  setAllowedAreas(Qt::LeftDockWidgetArea);
+
+  layoutWidget = new QWidget(this);
+
+  listWidget = new QListWidget(layoutWidget);
+  // All rows have the same height, so that long queues do not have to be measured.
+  listWidget->setUniformItemSizes(true);
+  connect(listWidget, &QListWidget::activated, this, [this](const QModelIndex& index){ open(index.row()); });
+
+  acceptButton = new QPushButton(tr("Accept"), layoutWidget);
+  connect(acceptButton, &QPushButton::clicked, this, &ProposalWidget::accept);
+
+  rejectButton = new QPushButton(tr("Reject"), layoutWidget);
+  connect(rejectButton, &QPushButton::clicked, this, &ProposalWidget::reject);
+
+  buttonLayout = new QHBoxLayout;
+  buttonLayout->addWidget(acceptButton);
+  buttonLayout->addWidget(rejectButton);
+
+  mainLayout = new QVBoxLayout(layoutWidget);
+  mainLayout->addWidget(listWidget);
+  mainLayout->addLayout(buttonLayout);
+  layoutWidget->setLayout(mainLayout);
+  setWidget(layoutWidget);
+
+  updateTitle();
+}
+
+void ProposalWidget::addProposals(const QVector<WhistleProposal>& proposals)
+{
+  for (auto& proposal : proposals)
+  {
+    listWidget->addItem(QFileInfo(proposal.path).fileName() + " [" + QString::number(proposal.channel) + "]: "
+      + QString::number(static_cast<double>(proposal.label.start) / proposal.sampleRate) + " - "
+      + QString::number(static_cast<double>(proposal.label.end) / proposal.sampleRate));
+    this->proposals.append(proposal);
+  }
+  if (listWidget->currentRow() < 0 && !this->proposals.isEmpty())
+  {
+    listWidget->setCurrentRow(0);
+  }
+  updateTitle();
+}
+
+void ProposalWidget::clearProposals()
+{
+  listWidget->clear();
+  proposals.clear();
+  updateTitle();
+}
+
+void ProposalWidget::removeAudioFile(const unsigned int id)
+{
+  for (int row = proposals.size() - 1; row >= 0; row--)
+  {
+    if (proposals[row].fileId == id)
+    {
+      removeProposal(row);
+    }
+  }
+}
+
+void ProposalWidget::accept()
+{
+  const int row = listWidget->currentRow();
+  if (row < 0 || row >= proposals.size())
+  {
+    return;
+  }
+  const WhistleProposal& proposal = proposals[row];
+  emit proposalAccepted(proposal.fileId, proposal.channel, proposal.label.start, proposal.label.end);
+  removeProposal(row);
+}
+
+void ProposalWidget::reject()
+{
+  const int row = listWidget->currentRow();
+  if (row < 0 || row >= proposals.size())
+  {
+    return;
+  }
+  removeProposal(row);
+}
+
+void ProposalWidget::open(const int row)
+{
+  if (row >= 0 && row < proposals.size())
+  {
+    emit channelSelectedForLabeling(proposals[row].path, proposals[row].channel);
+  }
+}
+
+void ProposalWidget::removeProposal(const int row)
+{
+  // The list selects the following proposal by itself, so that the queue can be worked through with the buttons.
+  delete listWidget->takeItem(row);
+  proposals.remove(row);
+  updateTitle();
+}
+
+void ProposalWidget::updateTitle()
+{
+  setWindowTitle(tr("Proposals") + " (" + QString::number(proposals.size()) + ")");
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ProposalWidget.hpp declares the proposal widget class
+ */
+
+#pragma once
+
+#include <QDockWidget>
+#include <QVector>
+
+#include "Engine/Prelabeler.hpp"
+
+
+class QHBoxLayout;
+class QListWidget;
+class QPushButton;
+class QString;
+class QVBoxLayout;
+class QWidget;
+
+/**
+ * @class ProposalWidget is a widget in which proposed whistle labels are accepted or rejected
+ */
+class ProposalWidget : public QDockWidget
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief ProposalWidget creates the proposal UI
+   * @param parent the parent object
+   */
+  ProposalWidget(QWidget* parent = 0);
+signals:
+  /**
+   * @brief channelSelectedForLabeling is emitted when the channel of a proposal should be opened
+   * @param path the path of the audio file in the sample database
+   * @param channel the channel number of the channel in the file
+   */
+  void channelSelectedForLabeling(const QString& path, const unsigned int channel);
+  /**
+   * @brief proposalAccepted is emitted when a proposal has been accepted and should become a label
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param start the first sample belonging to the whistle
+   * @param end the first sample not belonging to the whistle anymore
+   */
+  void proposalAccepted(unsigned int id, unsigned int channel, int start, int end);
+public slots:
+  /**
+   * @brief addProposals appends proposals to the queue
+   * @param proposals the proposals
+   */
+  void addProposals(const QVector<WhistleProposal>& proposals);
+  /**
+   * @brief clearProposals removes all proposals from the queue
+   */
+  void clearProposals();
+  /**
+   * @brief removeAudioFile removes the proposals for a file from the queue
+   * @param id the id of the file
+   */
+  void removeAudioFile(unsigned int id);
+private slots:
+  /**
+   * @brief accept accepts the selected proposal and selects the next one
+   */
+  void accept();
+  /**
+   * @brief reject rejects the selected proposal and selects the next one
+   */
+  void reject();
+  /**
+   * @brief open opens the channel of a proposal
+   * @param row the row of the proposal
+   */
+  void open(int row);
+private:
+  /**
+   * @brief removeProposal removes a proposal from the queue
+   * @param row the row of the proposal
+   */
+  void removeProposal(int row);
+  /**
+   * @brief updateTitle shows the number of proposals in the title
+   */
+  void updateTitle();
+  /// the proposals in the order of the list
+  QVector<WhistleProposal> proposals;
+  /// the widget that contains the layouts
+  QWidget* layoutWidget = nullptr;
+  /// the list of proposals
+  QListWidget* listWidget = nullptr;
+  /// a button that accepts the selected proposal
+  QPushButton* acceptButton = nullptr;
+  /// a button that rejects the selected proposal
+  QPushButton* rejectButton = nullptr;
+  /// the layout of the buttons
+  QHBoxLayout* buttonLayout = nullptr;
+  /// the layout of the list and the buttons
+  QVBoxLayout* mainLayout = nullptr;
+};
@@ -0,0 +1,320 @@
+/**
+ * @file SampleDatabaseModel.cpp implements methods for the sample database model class
+ */
+
+#include <algorithm>
+
+#include <QColor>
+
+#include "SampleDatabaseModel.hpp"
+
+
+constexpr int SampleDatabaseModel::fileBatchSize;
+constexpr int SampleDatabaseModel::labelBatchSize;
+
+namespace
+{
+  /// the number of bits of the internal id that are used for the channel index
+  constexpr quintptr channelBits = 16;
+  /// the number of bits of the internal id that are used for the file id
+  constexpr quintptr fileIdBits = 32;
+}
+
+SampleDatabaseModel::SampleDatabaseModel(QObject* parent)
+  : QAbstractItemModel(parent)
+{
+  static_assert(sizeof(quintptr) * 8 >= channelBits + fileIdBits + 2, "The internal id is too small for the identity of an item!");
+}
+
+QModelIndex SampleDatabaseModel::index(const int row, const int column, const QModelIndex& parent) const
+{
+  if (row < 0 || column != 0 || row >= rowCount(parent))
+  {
+    return QModelIndex();
+  }
+  if (!parent.isValid())
+  {
+    return createIndex(row, column, makeInternalId(FileLevel, 0, 0));
+  }
+  const File* file = getFile(parent);
+  if (getLevel(parent) == FileLevel)
+  {
+    return createIndex(row, column, makeInternalId(ChannelLevel, file->info.id, 0));
+  }
+  return createIndex(row, column, makeInternalId(LabelLevel, file->info.id, parent.row()));
+}
+
+QModelIndex SampleDatabaseModel::parent(const QModelIndex& child) const
+{
+  if (!child.isValid())
+  {
+    return QModelIndex();
+  }
+  const quintptr fileId = (child.internalId() >> channelBits) & ((quintptr(1) << fileIdBits) - 1);
+  switch (getLevel(child))
+  {
+    case ChannelLevel:
+    {
+      const int row = rowById.value(static_cast<unsigned int>(fileId), -1);
+      return row >= 0 ? createIndex(row, 0, makeInternalId(FileLevel, 0, 0)) : QModelIndex();
+    }
+    case LabelLevel:
+      return createIndex(static_cast<int>(child.internalId() & ((quintptr(1) << channelBits) - 1)), 0,
+                         makeInternalId(ChannelLevel, static_cast<unsigned int>(fileId), 0));
+    default:
+      return QModelIndex();
+  }
+}
+
+int SampleDatabaseModel::rowCount(const QModelIndex& parent) const
+{
+  if (!parent.isValid())
+  {
+    return fetchedFiles;
+  }
+  const File* file = getFile(parent);
+  if (file == nullptr || parent.column() != 0)
+  {
+    return 0;
+  }
+  switch (getLevel(parent))
+  {
+    case FileLevel:
+      return file->info.channels.size();
+    case ChannelLevel:
+      return file->fetchedLabels.value(parent.row());
+    default:
+      return 0;
+  }
+}
+
+int SampleDatabaseModel::columnCount(const QModelIndex&) const
+{
+  return 1;
+}
+
+bool SampleDatabaseModel::hasChildren(const QModelIndex& parent) const
+{
+  if (!parent.isValid())
+  {
+    return !files.isEmpty();
+  }
+  const File* file = getFile(parent);
+  if (file == nullptr)
+  {
+    return false;
+  }
+  switch (getLevel(parent))
+  {
+    case FileLevel:
+      return !file->info.channels.isEmpty();
+    case ChannelLevel:
+      return parent.row() < file->info.channels.size() && !file->info.channels[parent.row()].whistleLabels.isEmpty();
+    default:
+      return false;
+  }
+}
+
+QVariant SampleDatabaseModel::data(const QModelIndex& index, const int role) const
+{
+  const File* file = getFile(index);
+  if (file == nullptr)
+  {
+    return QVariant();
+  }
+  const Level level = getLevel(index);
+  const int channelIndex = (level == ChannelLevel) ? index.row() : index.parent().row();
+  switch (role)
+  {
+    case Qt::DisplayRole:
+      if (level == FileLevel)
+      {
+        return file->info.path;
+      }
+      if (level == ChannelLevel)
+      {
+        return QString::number(file->info.channels[channelIndex].channel);
+      }
+      {
+        const WhistleLabel& label = file->info.channels[channelIndex].whistleLabels[index.row()];
+        return QString::number(static_cast<double>(label.start) / file->info.sampleRate)
+          + " - " + QString::number(static_cast<double>(label.end) / file->info.sampleRate);
+      }
+    case Qt::ForegroundRole:
+      // Files whose samples are still being decoded cannot be opened yet.
+      return file->info.decoded ? QVariant() : QVariant(QColor(Qt::gray));
+    case FileIdRole:
+      return file->info.id;
+    case PathRole:
+      return file->info.path;
+    case ChannelRole:
+      return level != FileLevel ? QVariant(file->info.channels[channelIndex].channel) : QVariant();
+    case LabelIndexRole:
+      return level == LabelLevel ? QVariant(index.row()) : QVariant();
+    default:
+      return QVariant();
+  }
+}
+
+QVariant SampleDatabaseModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+  if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole)
+  {
+    return name;
+  }
+  return QVariant();
+}
+
+bool SampleDatabaseModel::canFetchMore(const QModelIndex& parent) const
+{
+  if (!parent.isValid())
+  {
+    return fetchedFiles < files.size();
+  }
+  const File* file = getFile(parent);
+  return file != nullptr && getLevel(parent) == ChannelLevel
+    && file->fetchedLabels.value(parent.row()) < file->info.channels[parent.row()].whistleLabels.size();
+}
+
+void SampleDatabaseModel::fetchMore(const QModelIndex& parent)
+{
+  if (!canFetchMore(parent))
+  {
+    return;
+  }
+  if (!parent.isValid())
+  {
+    const int count = std::min(fileBatchSize, files.size() - fetchedFiles);
+    beginInsertRows(parent, fetchedFiles, fetchedFiles + count - 1);
+    fetchedFiles += count;
+    endInsertRows();
+    return;
+  }
+  File& file = files[rowById.value(getFile(parent)->info.id)];
+  int& fetched = file.fetchedLabels[parent.row()];
+  const int count = std::min(labelBatchSize, file.info.channels[parent.row()].whistleLabels.size() - fetched);
+  beginInsertRows(parent, fetched, fetched + count - 1);
+  fetched += count;
+  endInsertRows();
+}
+
+void SampleDatabaseModel::openDatabase(const QString& name)
+{
+  beginResetModel();
+  this->name = name;
+  files.clear();
+  rowById.clear();
+  fetchedFiles = 0;
+  endResetModel();
+  emit headerDataChanged(Qt::Horizontal, 0, 0);
+}
+
+void SampleDatabaseModel::closeDatabase()
+{
+  openDatabase(QString());
+}
+
+void SampleDatabaseModel::addFile(const AudioFileInfo& info)
+{
+  File file;
+  file.info = info;
+  file.fetchedLabels.fill(0, info.channels.size());
+  rowById.insert(info.id, files.size());
+  // The first batch is shown right away, further files are inserted when the view asks for them.
+  if (fetchedFiles == files.size() && fetchedFiles < fileBatchSize)
+  {
+    beginInsertRows(QModelIndex(), fetchedFiles, fetchedFiles);
+    files.append(file);
+    fetchedFiles++;
+    endInsertRows();
+    return;
+  }
+  files.append(file);
+}
+
+void SampleDatabaseModel::changeFile(const AudioFileInfo& info)
+{
+  const int row = rowById.value(info.id, -1);
+  if (row < 0)
+  {
+    return;
+  }
+  File& file = files[row];
+  file.info = info;
+  if (row >= fetchedFiles)
+  {
+    return;
+  }
+  const QModelIndex fileIndex = index(row, 0);
+  for (int c = 0; c < file.fetchedLabels.size() && c < info.channels.size(); c++)
+  {
+    const QModelIndex channelIndex = index(c, 0, fileIndex);
+    const int labels = info.channels[c].whistleLabels.size();
+    int& fetched = file.fetchedLabels[c];
+    if (fetched > labels)
+    {
+      beginRemoveRows(channelIndex, labels, fetched - 1);
+      fetched = labels;
+      endRemoveRows();
+    }
+    if (fetched > 0)
+    {
+      emit dataChanged(index(0, 0, channelIndex), index(fetched - 1, 0, channelIndex));
+    }
+  }
+}
+
+void SampleDatabaseModel::removeFile(const unsigned int id)
+{
+  const int row = rowById.value(id, -1);
+  if (row < 0)
+  {
+    return;
+  }
+  if (row < fetchedFiles)
+  {
+    beginRemoveRows(QModelIndex(), row, row);
+    files.remove(row);
+    fetchedFiles--;
+    updateRows();
+    endRemoveRows();
+    return;
+  }
+  files.remove(row);
+  updateRows();
+}
+
+quintptr SampleDatabaseModel::makeInternalId(const Level level, const unsigned int fileId, const int channelIndex)
+{
+  return (static_cast<quintptr>(level) << (channelBits + fileIdBits)) | (static_cast<quintptr>(fileId) << channelBits)
+    | static_cast<quintptr>(channelIndex);
+}
+
+SampleDatabaseModel::Level SampleDatabaseModel::getLevel(const QModelIndex& index)
+{
+  return static_cast<Level>(index.internalId() >> (channelBits + fileIdBits));
+}
+
+const SampleDatabaseModel::File* SampleDatabaseModel::getFile(const QModelIndex& index) const
+{
+  if (!index.isValid())
+  {
+    return nullptr;
+  }
+  if (getLevel(index) == FileLevel)
+  {
+    return index.row() < files.size() ? &files[index.row()] : nullptr;
+  }
+  const unsigned int fileId = static_cast<unsigned int>((index.internalId() >> channelBits) & ((quintptr(1) << fileIdBits) - 1));
+  const int row = rowById.value(fileId, -1);
+  return row >= 0 ? &files[row] : nullptr;
+}
+
+void SampleDatabaseModel::updateRows()
+{
+  rowById.clear();
+  for (int r = 0; r < files.size(); r++)
+  {
+    rowById.insert(files[r].info.id, r);
+  }
+}
@@ -0,0 +1,188 @@
+/**
+ * @file SampleDatabaseModel.hpp declares the sample database model class
+ */
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "Engine/AudioFileInfo.hpp"
+
+
+/**
+ * @class SampleDatabaseModel is a tree model of the files, channels and labels of a sample database
+ *
+ * The model mirrors the descriptions of the files that the engine sends and is updated per file. Items refer to
+ * their file by its id, so that indices stay valid when other files are added or removed. Files and labels are only
+ * inserted into the model in batches when a view asks for them, so that opening a large database or expanding a
+ * channel with many labels does not create all rows at once.
+ */
+class SampleDatabaseModel : public QAbstractItemModel
+{
+  Q_OBJECT
+public:
+  /**
+   * @enum Role are the custom data roles of the model
+   */
+  enum Role
+  {
+    /// the id of the file to which an item belongs
+    FileIdRole = Qt::UserRole,
+    /// the path of the file to which an item belongs
+    PathRole,
+    /// the channel number of the channel to which an item belongs (only for channels and labels)
+    ChannelRole,
+    /// the index of a label in its channel (only for labels)
+    LabelIndexRole
+  };
+  /**
+   * @brief SampleDatabaseModel creates an empty model
+   * @param parent the parent object
+   */
+  SampleDatabaseModel(QObject* parent = 0);
+  /**
+   * @brief index returns the index of an item
+   * @param row the row of the item
+   * @param column the column of the item
+   * @param parent the index of the parent of the item
+   * @return the index of the item (invalid if it does not exist)
+   */
+  QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+  /**
+   * @brief parent returns the index of the parent of an item
+   * @param child the index of the item
+   * @return the index of the parent (invalid for files)
+   */
+  QModelIndex parent(const QModelIndex& child) const override;
+  /**
+   * @brief rowCount returns the number of children of an item that have been fetched
+   * @param parent the index of the item
+   * @return the number of fetched children
+   */
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  /**
+   * @brief columnCount returns the number of columns
+   * @param parent the index of an item
+   * @return 1
+   */
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  /**
+   * @brief hasChildren returns whether an item has children (even if they have not been fetched yet)
+   * @param parent the index of the item
+   * @return whether the item has children
+   */
+  bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+  /**
+   * @brief data returns the data of an item
+   * @param index the index of the item
+   * @param role the role of the data
+   * @return the data
+   */
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  /**
+   * @brief headerData returns the name of the database as header
+   * @param section the section of the header
+   * @param orientation the orientation of the header
+   * @param role the role of the data
+   * @return the header data
+   */
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+  /**
+   * @brief canFetchMore returns whether there are children of an item that have not been fetched
+   * @param parent the index of the item
+   * @return whether more children can be fetched
+   */
+  bool canFetchMore(const QModelIndex& parent) const override;
+  /**
+   * @brief fetchMore inserts the next batch of children of an item
+   * @param parent the index of the item
+   */
+  void fetchMore(const QModelIndex& parent) override;
+public slots:
+  /**
+   * @brief openDatabase resets the model for a newly opened database
+   * @param name the name of the database
+   */
+  void openDatabase(const QString& name);
+  /**
+   * @brief closeDatabase removes everything from the model
+   */
+  void closeDatabase();
+  /**
+   * @brief addFile appends a file
+   * @param info a description of the file
+   */
+  void addFile(const AudioFileInfo& info);
+  /**
+   * @brief changeFile updates the labels of a file
+   * @param info the new description of the file
+   */
+  void changeFile(const AudioFileInfo& info);
+  /**
+   * @brief removeFile removes a file
+   * @param id the id of the file
+   */
+  void removeFile(unsigned int id);
+private:
+  /**
+   * @enum Level is the depth of an item in the tree
+   */
+  enum Level : quintptr
+  {
+    /// the item is a file
+    FileLevel = 0,
+    /// the item is a channel
+    ChannelLevel = 1,
+    /// the item is a label
+    LabelLevel = 2
+  };
+  /**
+   * @struct File is a file in the model
+   */
+  struct File
+  {
+    /// the description of the file
+    AudioFileInfo info;
+    /// the number of labels that have been fetched per channel
+    QVector<int> fetchedLabels;
+  };
+  /**
+   * @brief makeInternalId packs the identity of an item into the internal id of its index
+   * @param level the depth of the item
+   * @param fileId the id of the file to which the item belongs (0 for files since their parent is the root)
+   * @param channelIndex the index of the channel to which the item belongs (0 for files and channels)
+   * @return the internal id
+   */
+  static quintptr makeInternalId(Level level, unsigned int fileId, int channelIndex);
+  /**
+   * @brief getLevel extracts the depth of an item from its index
+   * @param index the index of the item
+   * @return the depth of the item
+   */
+  static Level getLevel(const QModelIndex& index);
+  /**
+   * @brief getFile returns the file to which an item belongs
+   * @param index the index of the item
+   * @return the file (nullptr if it does not exist anymore)
+   */
+  const File* getFile(const QModelIndex& index) const;
+  /**
+   * @brief updateRows rebuilds the map from ids to rows
+   */
+  void updateRows();
+  /// the number of files that are inserted at once
+  static constexpr int fileBatchSize = 256;
+  /// the number of labels that are inserted at once
+  static constexpr int labelBatchSize = 1024;
+  /// the name of the database
+  QString name;
+  /// all files that have been received (only the first fetchedFiles are in the model)
+  QVector<File> files;
+  /// the number of files that are in the model
+  int fetchedFiles = 0;
+  /// the row of each file by its id
+  QHash<unsigned int, int> rowById;
+};
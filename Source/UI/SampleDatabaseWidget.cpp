@@ -4,8 +4,12 @@
 
 #include <QHeaderView>
 #include <QMenu>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QProgressBar>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include "SampleDatabaseModel.hpp"
 
 #include "SampleDatabaseWidget.hpp"
 
@@ -16,66 +20,97 @@ SampleDatabaseWidget::SampleDatabaseWidget(QWidget* parent)
   setAllowedAreas(Qt::LeftDockWidgetArea);
   setWindowTitle(tr("Sample Database"));
 
-  treeWidget = new QTreeWidget(this);
-  connect(treeWidget, &QTreeWidget::customContextMenuRequested, this, &SampleDatabaseWidget::prepareMenu);
-  treeWidget->setContextMenuPolicy(Qt::NoContextMenu);
-  treeWidget->header()->hide();
+  model = new SampleDatabaseModel(this);
+
+  layoutWidget = new QWidget(this);
+
+  treeView = new QTreeView(layoutWidget);
+  // All rows have the same height, so that the view does not have to measure every expanded label.
+  treeView->setUniformRowHeights(true);
+  treeView->setModel(model);
+  connect(treeView, &QTreeView::customContextMenuRequested, this, &SampleDatabaseWidget::prepareMenu);
+  treeView->setContextMenuPolicy(Qt::NoContextMenu);
+  treeView->header()->hide();
+
+  progressBar = new QProgressBar(layoutWidget);
+  progressBar->setFormat(tr("Decoding %v of %m files"));
+  progressBar->hide();
 
-  setWidget(treeWidget);
+  mainLayout = new QVBoxLayout(layoutWidget);
+  mainLayout->addWidget(treeView);
+  mainLayout->addWidget(progressBar);
+  layoutWidget->setLayout(mainLayout);
+  setWidget(layoutWidget);
 }
 
-void SampleDatabaseWidget::updateSampleDatabase(const SampleDatabase& sampleDatabase)
+void SampleDatabaseWidget::openSampleDatabase(const QString& name)
 {
-  treeWidget->clear();
-  if (!sampleDatabase.exists)
-  {
-    treeWidget->setContextMenuPolicy(Qt::NoContextMenu);
-    treeWidget->header()->hide();
-    return;
-  }
-  treeWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-  treeWidget->setHeaderLabel(sampleDatabase.name);
-  treeWidget->header()->show();
-  QTreeWidgetItem* root = treeWidget->invisibleRootItem();
-  for (auto& file : sampleDatabase.audioFiles)
-  {
-    QTreeWidgetItem* fileItem = new QTreeWidgetItem(root);
-    fileItem->setText(0, file.path);
-    for (auto& channel : file.channels)
-    {
-      QTreeWidgetItem* channelItem = new QTreeWidgetItem(fileItem);
-      channelItem->setText(0, QString::number(channel.channel));
-      for (auto& label : channel.whistleLabels)
-      {
-        QTreeWidgetItem* labelItem = new QTreeWidgetItem(channelItem);
-        labelItem->setText(0, QString::number(static_cast<double>(label.start) / file.sampleRate)
-          + " - " + QString::number(static_cast<double>(label.end) / file.sampleRate));
-      }
-    }
-  }
+  model->openDatabase(name);
+  treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+  treeView->header()->show();
+}
+
+void SampleDatabaseWidget::closeSampleDatabase()
+{
+  model->closeDatabase();
+  treeView->setContextMenuPolicy(Qt::NoContextMenu);
+  treeView->header()->hide();
+  progressBar->hide();
+}
+
+void SampleDatabaseWidget::addAudioFile(const AudioFileInfo& info)
+{
+  model->addFile(info);
+}
+
+void SampleDatabaseWidget::changeAudioFile(const AudioFileInfo& info)
+{
+  model->changeFile(info);
+}
+
+void SampleDatabaseWidget::removeAudioFile(const unsigned int id)
+{
+  model->removeFile(id);
+}
+
+void SampleDatabaseWidget::updateDecodingProgress(const unsigned int decodedFiles, const unsigned int totalFiles)
+{
+  progressBar->setRange(0, static_cast<int>(totalFiles));
+  progressBar->setValue(static_cast<int>(decodedFiles));
+  progressBar->setVisible(decodedFiles < totalFiles);
 }
 
 void SampleDatabaseWidget::prepareMenu(const QPoint& pos)
 {
-  QTreeWidgetItem* item = treeWidget->itemAt(pos);
+  const QModelIndex index = treeView->indexAt(pos);
   QMenu menu;
-  if (item != nullptr)
+  if (index.isValid())
   {
-    if (item->parent() == nullptr)
+    // The actions capture the ids instead of the index because the model may change while the menu is open.
+    const unsigned int id = index.data(SampleDatabaseModel::FileIdRole).toUInt();
+    if (!index.parent().isValid())
     {
       QAction* removeFileAction = new QAction(tr("&Remove File"), this);
+      connect(removeFileAction, &QAction::triggered, this,
+        [this, id]{ emit audioFileRemovalRequested(id); });
       menu.addAction(removeFileAction);
     }
-    else if (item->parent()->parent() == nullptr)
+    else if (!index.parent().parent().isValid())
     {
+      const QString path = index.data(SampleDatabaseModel::PathRole).toString();
+      const unsigned int channel = index.data(SampleDatabaseModel::ChannelRole).toUInt();
       QAction* openInLabelWidgetAction = new QAction(tr("&Open in Label Widget"), this);
       connect(openInLabelWidgetAction, &QAction::triggered, this,
-        [this, item]{ emit channelSelectedForLabeling(item->parent()->data(0, 0).toString(), item->data(0, 0).toUInt()); });
+        [this, path, channel]{ emit channelSelectedForLabeling(path, channel); });
       menu.addAction(openInLabelWidgetAction);
     }
     else
     {
+      const unsigned int channel = index.data(SampleDatabaseModel::ChannelRole).toUInt();
+      const int labelIndex = index.data(SampleDatabaseModel::LabelIndexRole).toInt();
       QAction* removeLabelAction = new QAction(tr("Remove &Label"), this);
+      connect(removeLabelAction, &QAction::triggered, this,
+        [this, id, channel, labelIndex]{ emit whistleLabelRemovalRequested(id, channel, labelIndex); });
       menu.addAction(removeLabelAction);
 
       QAction* setIntervalAction = new QAction(tr("&Set Interval"), this);
@@ -87,5 +122,5 @@ void SampleDatabaseWidget::prepareMenu(const QPoint& pos)
     QAction* addFileAction = new QAction(tr("&Add File"), this);
     menu.addAction(addFileAction);
   }
-  menu.exec(treeWidget->mapToGlobal(pos));
+  menu.exec(treeView->mapToGlobal(pos));
 }
@@ -6,13 +6,16 @@
 
 #include <QDockWidget>
 
-#include "Engine/SampleDatabase.hpp"
+#include "Engine/AudioFileInfo.hpp"
 
 
 class QPoint;
+class QProgressBar;
 class QString;
-class QTreeWidget;
+class QTreeView;
+class QVBoxLayout;
 class QWidget;
+class SampleDatabaseModel;
 
 /**
  * @class SampleDatabaseWidget is a widget that views a sample database
@@ -33,12 +36,49 @@ signals:
    * @param channel the channel number of the channel in the file
    */
   void channelSelectedForLabeling(const QString& path, const unsigned int channel);
+  /**
+   * @brief audioFileRemovalRequested is emitted when a file should be removed from the sample database
+   * @param id the id of the file
+   */
+  void audioFileRemovalRequested(unsigned int id);
+  /**
+   * @brief whistleLabelRemovalRequested is emitted when a label should be removed
+   * @param id the id of the file
+   * @param channel the channel number of the channel in the file
+   * @param labelIndex the index of the label in the channel
+   */
+  void whistleLabelRemovalRequested(unsigned int id, unsigned int channel, int labelIndex);
 public slots:
   /**
-   * @brief updateSampleDatabase updates the sample database that is viewed
-   * @param sampleDatabase a reference to the new sample database
+   * @brief openSampleDatabase starts viewing a new sample database
+   * @param name the name of the sample database
+   */
+  void openSampleDatabase(const QString& name);
+  /**
+   * @brief closeSampleDatabase stops viewing the sample database
+   */
+  void closeSampleDatabase();
+  /**
+   * @brief addAudioFile adds a file to the view
+   * @param info a description of the file
+   */
+  void addAudioFile(const AudioFileInfo& info);
+  /**
+   * @brief changeAudioFile updates a file in the view
+   * @param info the new description of the file
+   */
+  void changeAudioFile(const AudioFileInfo& info);
+  /**
+   * @brief removeAudioFile removes a file from the view
+   * @param id the id of the file
+   */
+  void removeAudioFile(unsigned int id);
+  /**
+   * @brief updateDecodingProgress shows how many files of the sample database have been decoded
+   * @param decodedFiles the number of files that have been decoded
+   * @param totalFiles the number of files that are decoded in total
    */
-  void updateSampleDatabase(const SampleDatabase& sampleDatabase);
+  void updateDecodingProgress(unsigned int decodedFiles, unsigned int totalFiles);
 private slots:
   /**
    * @brief prepareMenu prepares a context menu depending on the type of the clicked item
@@ -46,6 +86,14 @@ private slots:
    */
   void prepareMenu(const QPoint& pos);
 private:
+  /// the model of the sample database
+  SampleDatabaseModel* model = nullptr;
+  /// the widget that contains the layout
+  QWidget* layoutWidget = nullptr;
   /// the tree that displays the sample database
-  QTreeWidget* treeWidget = nullptr;
+  QTreeView* treeView = nullptr;
+  /// the progress bar that is shown while files are decoded
+  QProgressBar* progressBar = nullptr;
+  /// the layout of the tree and the progress bar
+  QVBoxLayout* mainLayout = nullptr;
 };
@@ -0,0 +1,131 @@
+/**
+ * @file SpectrogramView.cpp implements methods for the spectrogram view class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <QLineF>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRectF>
+
+#include "SpectrogramView.hpp"
+
+
+constexpr std::size_t SpectrogramView::cacheSize;
+constexpr unsigned int SpectrogramView::maxPlaceholderLevels;
+
+SpectrogramView::SpectrogramView(QWidget* parent)
+  : QWidget(parent)
+{
+  setMinimumHeight(100);
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  // The colors go from black over red and yellow to white.
+  colorTable.reserve(256);
+  for (int i = 0; i < 256; i++)
+  {
+    colorTable.append(qRgb(std::min(3 * i, 255), std::min(std::max(3 * i - 255, 0), 255), std::max(3 * i - 510, 0)));
+  }
+  connect(this, &SpectrogramView::tileReady, this, [this]{ update(); }, Qt::QueuedConnection);
+  tiles.reset(new SpectrogramTiles(cacheSize, [this]{ emit tileReady(); }));
+}
+
+SpectrogramView::~SpectrogramView()
+{
+  // The background thread has to be stopped before the signal that it emits is destroyed.
+  tiles.reset();
+}
+
+void SpectrogramView::setChannel(const AudioChannel& audioChannel)
+{
+  numberOfSamples = static_cast<unsigned int>(audioChannel.samples.size());
+  playbackPosition = 0;
+  tiles->setSamples(audioChannel.samples);
+  update();
+}
+
+void SpectrogramView::setPlaybackPosition(const unsigned int pos)
+{
+  const double oldX = sampleToX(playbackPosition);
+  playbackPosition = pos;
+  const double newX = sampleToX(playbackPosition);
+  update(static_cast<int>(oldX) - 1, 0, 3, height());
+  update(static_cast<int>(newX) - 1, 0, 3, height());
+}
+
+void SpectrogramView::setView(const double firstSample, const double samplesPerPixel)
+{
+  this->firstSample = firstSample;
+  this->samplesPerPixel = samplesPerPixel;
+  update();
+}
+
+void SpectrogramView::paintEvent(QPaintEvent* event)
+{
+  QPainter painter(this);
+  painter.fillRect(event->rect(), Qt::black);
+  if (numberOfSamples == 0)
+  {
+    return;
+  }
+  // The coarsest level whose columns are not wider than a pixel is used.
+  unsigned int level = 0;
+  while (level + 1 < SpectrogramTiles::numberOfLevels && SpectrogramTiles::getHopSize(level + 1) <= samplesPerPixel)
+  {
+    level++;
+  }
+  const double tileSamples = static_cast<double>(SpectrogramTiles::getHopSize(level)) * SpectrogramTiles::tileWidth;
+  const double lastSample = std::min(firstSample + width() * samplesPerPixel, static_cast<double>(numberOfSamples));
+  const unsigned int firstTile = static_cast<unsigned int>(firstSample / tileSamples);
+  const unsigned int endTile = static_cast<unsigned int>(std::ceil(lastSample / tileSamples));
+  std::vector<SpectrogramTiles::Key> missing;
+  for (unsigned int index = firstTile; index < endTile; index++)
+  {
+    const double startX = sampleToX(index * tileSamples);
+    const QRectF target(startX, 0.0, sampleToX((index + 1) * tileSamples) - startX, height());
+    if (auto tile = tiles->getTile({ level, index }))
+    {
+      drawTile(painter, target, *tile, 0, SpectrogramTiles::tileWidth);
+      continue;
+    }
+    missing.push_back({ level, index });
+    for (unsigned int k = 1; k <= maxPlaceholderLevels && level + k < SpectrogramTiles::numberOfLevels; k++)
+    {
+      if (auto coarseTile = tiles->getTile({ level + k, index >> k }))
+      {
+        const unsigned int columns = SpectrogramTiles::tileWidth >> k;
+        drawTile(painter, target, *coarseTile, (index & ((1U << k) - 1)) * columns, columns);
+        break;
+      }
+    }
+  }
+  // The tiles in the center of the view are computed first.
+  const int centerTile = static_cast<int>((firstTile + endTile) / 2);
+  std::stable_sort(missing.begin(), missing.end(), [centerTile](const SpectrogramTiles::Key& a, const SpectrogramTiles::Key& b)
+  {
+    return std::abs(static_cast<int>(a.index) - centerTile) < std::abs(static_cast<int>(b.index) - centerTile);
+  });
+  tiles->request(missing);
+
+  const double playheadX = sampleToX(playbackPosition);
+  painter.setPen(Qt::green);
+  painter.drawLine(QLineF(playheadX, 0.0, playheadX, height()));
+}
+
+void SpectrogramView::drawTile(QPainter& painter, const QRectF& target, const SpectrogramTiles::Tile& tile, const unsigned int firstColumn,
+                               const unsigned int columns) const
+{
+  // The image only wraps the intensities of the tile, so nothing is copied.
+  QImage image(tile.intensities.data(), SpectrogramTiles::tileWidth, SpectrogramTiles::numberOfBins, SpectrogramTiles::tileWidth,
+               QImage::Format_Indexed8);
+  image.setColorTable(colorTable);
+  painter.drawImage(target, image, QRectF(firstColumn, 0.0, columns, SpectrogramTiles::numberOfBins));
+}
+
+double SpectrogramView::sampleToX(const double sample) const
+{
+  return (sample - firstSample) / samplesPerPixel;
+}
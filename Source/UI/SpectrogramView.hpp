@@ -0,0 +1,101 @@
+/**
+ * @file SpectrogramView.hpp declares the spectrogram view class
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <QImage>
+#include <QVector>
+#include <QWidget>
+
+#include "Engine/AudioChannel.hpp"
+#include "Engine/SpectrogramTiles.hpp"
+
+
+class QPainter;
+class QPaintEvent;
+class QRectF;
+
+/**
+ * @class SpectrogramView is a widget that draws the spectrogram of an audio channel
+ *
+ * The spectrogram is drawn from tiles that are computed in the background. Only the visible tiles are requested,
+ * the ones closest to the center of the view first. Until a tile is available, a part of a coarser tile is drawn
+ * in its place if there is one in the cache.
+ */
+class SpectrogramView : public QWidget
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief SpectrogramView creates the view and starts the computation of tiles
+   * @param parent the parent object
+   */
+  SpectrogramView(QWidget* parent = 0);
+  /**
+   * @brief ~SpectrogramView stops the computation of tiles
+   */
+  ~SpectrogramView();
+  /**
+   * @brief setChannel replaces the channel that is drawn
+   * @param audioChannel a reference to the new audio channel
+   */
+  void setChannel(const AudioChannel& audioChannel);
+  /**
+   * @brief setPlaybackPosition moves the playhead
+   * @param pos the new playback position in samples
+   */
+  void setPlaybackPosition(unsigned int pos);
+signals:
+  /**
+   * @brief tileReady is emitted (from the background thread) when new tiles have been computed
+   */
+  void tileReady();
+public slots:
+  /**
+   * @brief setView changes the visible range
+   * @param firstSample the sample position at the left border of the view
+   * @param samplesPerPixel the number of samples per pixel
+   */
+  void setView(double firstSample, double samplesPerPixel);
+protected:
+  /**
+   * @brief paintEvent draws the available tiles and requests the missing ones
+   * @param event the paint event
+   */
+  void paintEvent(QPaintEvent* event) override;
+private:
+  /**
+   * @brief drawTile draws some columns of a tile
+   * @param painter the painter of the widget
+   * @param target the rectangle in which the columns are drawn
+   * @param tile the tile
+   * @param firstColumn the first column that is drawn
+   * @param columns the number of columns that are drawn
+   */
+  void drawTile(QPainter& painter, const QRectF& target, const SpectrogramTiles::Tile& tile, unsigned int firstColumn, unsigned int columns) const;
+  /**
+   * @brief sampleToX converts a sample position to a horizontal widget coordinate
+   * @param sample the sample position
+   * @return the x coordinate
+   */
+  double sampleToX(double sample) const;
+  /// the memory budget of the tile cache in bytes
+  static constexpr std::size_t cacheSize = 64 << 20;
+  /// the number of coarser levels that are searched for a placeholder of a missing tile
+  static constexpr unsigned int maxPlaceholderLevels = 3;
+  /// the number of samples of the channel
+  unsigned int numberOfSamples = 0;
+  /// the sample position at the left border of the view
+  double firstSample = 0.0;
+  /// the number of samples per pixel
+  double samplesPerPixel = 1.0;
+  /// the current playback position in samples
+  unsigned int playbackPosition = 0;
+  /// the colors of the intensities
+  QVector<QRgb> colorTable;
+  /// the tiles of the spectrogram of the channel
+  std::unique_ptr<SpectrogramTiles> tiles;
+};
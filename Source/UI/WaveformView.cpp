@@ -0,0 +1,260 @@
+/**
+ * @file WaveformView.cpp implements methods for the waveform view class
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QColor>
+#include <QCursor>
+#include <QLineF>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+#include <QWheelEvent>
+
+#include "Engine/WaveformPyramid.hpp"
+
+#include "WaveformView.hpp"
+
+
+constexpr double WaveformView::minSamplesPerPixel;
+
+WaveformView::WaveformView(QWidget* parent)
+  : QWidget(parent)
+{
+  setMinimumHeight(100);
+  setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void WaveformView::setChannel(const AudioChannel& audioChannel)
+{
+  channel = audioChannel;
+  playbackPosition = 0;
+  firstSample = 0.0;
+  samplesPerPixel = static_cast<double>(channel.samples.size()) / std::max(width(), 1);
+  clampView();
+  update();
+}
+
+void WaveformView::setPlaybackPosition(const unsigned int pos)
+{
+  const double oldX = sampleToX(playbackPosition);
+  playbackPosition = pos;
+  const double newX = sampleToX(playbackPosition);
+  if (newX < 0.0 || newX >= width())
+  {
+    // The view jumps by whole pages, so that the waveform does not move under the mouse all the time.
+    firstSample = playbackPosition;
+    clampView();
+    update();
+    return;
+  }
+  update(static_cast<int>(oldX) - 1, 0, 3, height());
+  update(static_cast<int>(newX) - 1, 0, 3, height());
+}
+
+void WaveformView::clearOverlay()
+{
+  overlayDetections.clear();
+  overlayScores.clear();
+  minOverlayScore = 0.f;
+  maxOverlayScore = 0.f;
+  update();
+}
+
+void WaveformView::appendOverlay(const DetectorOutput& output)
+{
+  // The output arrives mostly in order, so only the new part has to be sorted before it is merged.
+  const std::size_t oldDetections = overlayDetections.size();
+  overlayDetections.insert(overlayDetections.end(), output.detections.begin(), output.detections.end());
+  std::sort(overlayDetections.begin() + static_cast<std::ptrdiff_t>(oldDetections), overlayDetections.end());
+  std::inplace_merge(overlayDetections.begin(), overlayDetections.begin() + static_cast<std::ptrdiff_t>(oldDetections), overlayDetections.end());
+  const auto byPosition = [](const ScoredFrame& a, const ScoredFrame& b){ return a.position < b.position; };
+  const std::size_t oldScores = overlayScores.size();
+  for (const auto& frame : output.scores)
+  {
+    if (overlayScores.empty())
+    {
+      minOverlayScore = frame.score;
+      maxOverlayScore = frame.score;
+    }
+    minOverlayScore = std::min(minOverlayScore, frame.score);
+    maxOverlayScore = std::max(maxOverlayScore, frame.score);
+    overlayScores.push_back(frame);
+  }
+  std::sort(overlayScores.begin() + static_cast<std::ptrdiff_t>(oldScores), overlayScores.end(), byPosition);
+  std::inplace_merge(overlayScores.begin(), overlayScores.begin() + static_cast<std::ptrdiff_t>(oldScores), overlayScores.end(), byPosition);
+  update();
+}
+
+void WaveformView::paintEvent(QPaintEvent* event)
+{
+  QPainter painter(this);
+  painter.fillRect(event->rect(), palette().color(QPalette::Base));
+  if (channel.samples.isEmpty() || channel.waveform == nullptr)
+  {
+    return;
+  }
+  const double center = height() / 2.0;
+  const double scale = height() / 2.0;
+  // Only the columns that have to be repainted are drawn (e.g. when only the playhead has moved).
+  const int firstX = std::max(event->rect().left(), 0);
+  const int lastX = std::min(event->rect().right() + 1, width());
+
+  // 1. Labels
+  for (auto& label : channel.whistleLabels)
+  {
+    const double startX = std::max(sampleToX(label.start), static_cast<double>(firstX));
+    const double endX = std::min(sampleToX(label.end), static_cast<double>(lastX));
+    if (startX < endX)
+    {
+      painter.fillRect(QRectF(startX, 0.0, endX - startX, height()), QColor(255, 200, 0, 80));
+    }
+  }
+
+  // 2. Waveform
+  if (samplesPerPixel < WaveformPyramid::baseBucketSize)
+  {
+    // Few samples per pixel are drawn directly.
+    const int size = channel.samples.size();
+    const int first = std::max(static_cast<int>(std::floor(firstSample + (firstX - 1) * samplesPerPixel)), 0);
+    const int last = std::min(static_cast<int>(std::ceil(firstSample + (lastX + 1) * samplesPerPixel)) + 1, size);
+    QPolygonF polyline;
+    polyline.reserve(std::max(last - first, 0));
+    for (int i = first; i < last; i++)
+    {
+      polyline << QPointF(sampleToX(i), center - channel.samples[i] * scale);
+    }
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawPolyline(polyline);
+  }
+  else
+  {
+    // Each column shows the range of its samples and, inside it, their RMS.
+    QVector<QLineF> envelope, rms;
+    envelope.reserve(lastX - firstX);
+    rms.reserve(lastX - firstX);
+    for (int x = firstX; x < lastX; x++)
+    {
+      const double begin = firstSample + x * samplesPerPixel;
+      if (begin >= channel.samples.size())
+      {
+        break;
+      }
+      const WaveformPyramid::Summary summary = channel.waveform->summarize(static_cast<unsigned int>(begin),
+        static_cast<unsigned int>(begin + samplesPerPixel));
+      envelope.append(QLineF(x + 0.5, center - summary.maximum * scale, x + 0.5, center - summary.minimum * scale));
+      rms.append(QLineF(x + 0.5, center - summary.rms * scale, x + 0.5, center + summary.rms * scale));
+    }
+    painter.setPen(palette().color(QPalette::Dark));
+    painter.drawLines(envelope);
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawLines(rms);
+  }
+
+  // 3. Overlay
+  drawOverlay(painter, firstX, lastX);
+
+  // 4. Playhead
+  const double playheadX = sampleToX(playbackPosition);
+  if (playheadX >= firstX - 1 && playheadX <= lastX + 1)
+  {
+    painter.setPen(Qt::red);
+    painter.drawLine(QLineF(playheadX, 0.0, playheadX, height()));
+  }
+}
+
+void WaveformView::wheelEvent(QWheelEvent* event)
+{
+  // The cursor position is used instead of the event position because the accessor of the latter differs between Qt versions.
+  const int x = mapFromGlobal(QCursor::pos()).x();
+  const double anchor = firstSample + x * samplesPerPixel;
+  samplesPerPixel *= std::pow(0.8, event->angleDelta().y() / 120.0);
+  firstSample = anchor - x * samplesPerPixel;
+  clampView();
+  update();
+  event->accept();
+}
+
+void WaveformView::mousePressEvent(QMouseEvent* event)
+{
+  lastMouseX = event->x();
+}
+
+void WaveformView::mouseMoveEvent(QMouseEvent* event)
+{
+  if (!(event->buttons() & Qt::LeftButton))
+  {
+    return;
+  }
+  firstSample -= (event->x() - lastMouseX) * samplesPerPixel;
+  lastMouseX = event->x();
+  clampView();
+  update();
+}
+
+void WaveformView::drawOverlay(QPainter& painter, const int firstX, const int lastX) const
+{
+  const double firstVisible = std::max(firstSample + (firstX - 1) * samplesPerPixel, 0.0);
+  const double lastVisible = firstSample + (lastX + 1) * samplesPerPixel;
+  painter.setPen(QColor(0, 120, 255));
+  for (auto detection = std::lower_bound(overlayDetections.begin(), overlayDetections.end(), static_cast<unsigned int>(firstVisible));
+       detection != overlayDetections.end() && *detection <= lastVisible; detection++)
+  {
+    const double x = sampleToX(*detection);
+    painter.drawLine(QLineF(x, 0.0, x, height()));
+  }
+  if (overlayScores.empty())
+  {
+    return;
+  }
+  // The scores are scaled to the range that has been seen so far and reduced to their maximum per column.
+  const float range = std::max(maxOverlayScore - minOverlayScore, std::numeric_limits<float>::min());
+  QPolygonF curve;
+  int column = 0;
+  float columnMaximum = 0.f;
+  bool hasColumn = false;
+  for (auto frame = std::lower_bound(overlayScores.begin(), overlayScores.end(), static_cast<unsigned int>(firstVisible),
+                                     [](const ScoredFrame& a, const unsigned int position){ return a.position < position; });
+       frame != overlayScores.end() && frame->position <= lastVisible; frame++)
+  {
+    const int x = static_cast<int>(std::floor(sampleToX(frame->position)));
+    if (hasColumn && x == column)
+    {
+      columnMaximum = std::max(columnMaximum, frame->score);
+      continue;
+    }
+    if (hasColumn)
+    {
+      curve << QPointF(column + 0.5, height() * (1.0 - (columnMaximum - minOverlayScore) / range));
+    }
+    column = x;
+    columnMaximum = frame->score;
+    hasColumn = true;
+  }
+  if (hasColumn)
+  {
+    curve << QPointF(column + 0.5, height() * (1.0 - (columnMaximum - minOverlayScore) / range));
+  }
+  painter.setPen(QColor(200, 0, 200));
+  painter.drawPolyline(curve);
+}
+
+void WaveformView::clampView()
+{
+  const double size = channel.samples.size();
+  const double visibleWidth = std::max(width(), 1);
+  samplesPerPixel = std::max(std::min(samplesPerPixel, size / visibleWidth), minSamplesPerPixel);
+  firstSample = std::max(std::min(firstSample, size - samplesPerPixel * visibleWidth), 0.0);
+  emit viewChanged(firstSample, samplesPerPixel);
+}
+
+double WaveformView::sampleToX(const double sample) const
+{
+  return (sample - firstSample) / samplesPerPixel;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file WaveformView.hpp declares the waveform view class
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QWidget>
+
+#include "Detector/DetectorOutput.hpp"
+#include "Engine/AudioChannel.hpp"
+
+
+class QMouseEvent;
+class QPainter;
+class QPaintEvent;
+class QWheelEvent;
+
+/**
+ * @class WaveformView is a widget that draws the waveform of an audio channel together with its labels
+ *
+ * Ranges that are longer than a few samples per pixel are drawn from the waveform pyramid of the channel, so that a
+ * repaint costs about the same for a whole game as for a single whistle.
+ */
+class WaveformView : public QWidget
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief WaveformView creates the view
+   * @param parent the parent object
+   */
+  WaveformView(QWidget* parent = 0);
+  /**
+   * @brief setChannel replaces the channel that is drawn and shows all of it
+   * @param audioChannel a reference to the new audio channel
+   */
+  void setChannel(const AudioChannel& audioChannel);
+  /**
+   * @brief setPlaybackPosition moves the playhead (the view follows it when it leaves the visible range)
+   * @param pos the new playback position in samples
+   */
+  void setPlaybackPosition(unsigned int pos);
+  /**
+   * @brief clearOverlay removes all detections and scores of the overlay detector
+   */
+  void clearOverlay();
+  /**
+   * @brief appendOverlay adds detections and scores of the overlay detector
+   * @param output the new detections and scores
+   */
+  void appendOverlay(const DetectorOutput& output);
+signals:
+  /**
+   * @brief viewChanged is emitted when the visible range has changed (so that other views can follow)
+   * @param firstSample the sample position at the left border of the view
+   * @param samplesPerPixel the number of samples per pixel
+   */
+  void viewChanged(double firstSample, double samplesPerPixel);
+protected:
+  /**
+   * @brief paintEvent draws the labels, the waveform and the playhead
+   * @param event the paint event
+   */
+  void paintEvent(QPaintEvent* event) override;
+  /**
+   * @brief wheelEvent zooms around the mouse cursor
+   * @param event the wheel event
+   */
+  void wheelEvent(QWheelEvent* event) override;
+  /**
+   * @brief mousePressEvent starts scrolling by dragging
+   * @param event the mouse event
+   */
+  void mousePressEvent(QMouseEvent* event) override;
+  /**
+   * @brief mouseMoveEvent scrolls while the left button is held
+   * @param event the mouse event
+   */
+  void mouseMoveEvent(QMouseEvent* event) override;
+private:
+  /**
+   * @brief clampView keeps the zoom and the scroll position inside the channel and announces the new view
+   */
+  void clampView();
+  /**
+   * @brief drawOverlay draws the scores of the overlay detector as a curve and its detections as lines
+   * @param painter the painter of the widget
+   * @param firstX the first column that is drawn
+   * @param lastX the column after the last one that is drawn
+   */
+  void drawOverlay(QPainter& painter, int firstX, int lastX) const;
+  /**
+   * @brief sampleToX converts a sample position to a horizontal widget coordinate
+   * @param sample the sample position
+   * @return the x coordinate
+   */
+  double sampleToX(double sample) const;
+  /// the channel that is drawn (the samples are shared with the engine)
+  AudioChannel channel;
+  /// the sample position at the left border of the view
+  double firstSample = 0.0;
+  /// the number of samples per pixel
+  double samplesPerPixel = 1.0;
+  /// the current playback position in samples
+  unsigned int playbackPosition = 0;
+  /// the positions of the detections of the overlay detector (sorted)
+  std::vector<unsigned int> overlayDetections;
+  /// the scores of the overlay detector (sorted by position)
+  std::vector<ScoredFrame> overlayScores;
+  /// the smallest score of the overlay detector
+  float minOverlayScore = 0.f;
+  /// the largest score of the overlay detector
+  float maxOverlayScore = 0.f;
+  /// the x coordinate of the last mouse event while dragging
+  int lastMouseX = 0;
+  /// the smallest number of samples per pixel (i.e. the largest zoom)
+  static constexpr double minSamplesPerPixel = 1.0 / 16.0;
+};
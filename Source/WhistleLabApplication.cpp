@@ -20,15 +20,32 @@ WhistleLabApplication::WhistleLabApplication(int& argc, char** argv)
   whistleLabEngine->moveToThread(workerThread);
 
   connect(&mainWindow, &MainWindow::fileChanged, whistleLabEngine, &WhistleLabEngine::changeDatabase);
-  connect(whistleLabEngine, &WhistleLabEngine::sampleDatabaseChanged, &mainWindow, &MainWindow::sampleDatabaseChanged);
+  connect(whistleLabEngine, &WhistleLabEngine::sampleDatabaseOpened, &mainWindow, &MainWindow::sampleDatabaseOpened);
+  connect(whistleLabEngine, &WhistleLabEngine::sampleDatabaseClosed, &mainWindow, &MainWindow::sampleDatabaseClosed);
+  connect(whistleLabEngine, &WhistleLabEngine::audioFileAdded, &mainWindow, &MainWindow::audioFileAdded);
+  connect(whistleLabEngine, &WhistleLabEngine::audioFileChanged, &mainWindow, &MainWindow::audioFileChanged);
+  connect(whistleLabEngine, &WhistleLabEngine::audioFileRemoved, &mainWindow, &MainWindow::audioFileRemoved);
+  connect(whistleLabEngine, &WhistleLabEngine::decodingProgress, &mainWindow, &MainWindow::decodingProgress);
+  connect(&mainWindow, &MainWindow::removeAudioFileClicked, whistleLabEngine, &WhistleLabEngine::removeAudioFile);
+  connect(&mainWindow, &MainWindow::removeWhistleLabelClicked, whistleLabEngine, &WhistleLabEngine::removeWhistleLabel);
   connect(&mainWindow, &MainWindow::evaluateDetectorClicked, whistleLabEngine, &WhistleLabEngine::evaluateDetector);
   connect(&mainWindow, &MainWindow::trainDetectorClicked, whistleLabEngine, &WhistleLabEngine::trainDetector);
+  connect(&mainWindow, &MainWindow::prelabelClicked, whistleLabEngine, &WhistleLabEngine::prelabel);
+  connect(whistleLabEngine, &WhistleLabEngine::whistlesProposed, &mainWindow, &MainWindow::whistlesProposed);
+  connect(&mainWindow, &MainWindow::addWhistleLabelClicked, whistleLabEngine, &WhistleLabEngine::addWhistleLabel);
+  connect(&mainWindow, &MainWindow::sweepClicked, whistleLabEngine, &WhistleLabEngine::sweepParameters);
+  connect(&mainWindow, &MainWindow::noiseAugmentationChanged, whistleLabEngine, &WhistleLabEngine::setNoiseAugmentation);
   connect(&mainWindow, &MainWindow::channelSelected, whistleLabEngine, &WhistleLabEngine::selectChannel);
   connect(whistleLabEngine, &WhistleLabEngine::channelChanged, &mainWindow, &MainWindow::channelChanged);
   connect(&mainWindow, &MainWindow::playClicked, whistleLabEngine, &WhistleLabEngine::startPlayback);
   connect(&mainWindow, &MainWindow::pauseClicked, whistleLabEngine, &WhistleLabEngine::stopPlayback);
   connect(whistleLabEngine, &WhistleLabEngine::playbackPositionChanged, &mainWindow, &MainWindow::playbackPositionChanged);
   connect(whistleLabEngine, &WhistleLabEngine::evaluationDone, &mainWindow, &MainWindow::evaluationDone);
+  connect(&mainWindow, &MainWindow::overlayDetectorSelected, whistleLabEngine, &WhistleLabEngine::selectOverlayDetector);
+  connect(whistleLabEngine, &WhistleLabEngine::overlayStarted, &mainWindow, &MainWindow::overlayStarted);
+  connect(whistleLabEngine, &WhistleLabEngine::overlayProgress, &mainWindow, &MainWindow::overlayProgress);
+  // The engine is destroyed in its own thread, so that it can stop its background work.
+  connect(workerThread, &QThread::finished, whistleLabEngine, &QObject::deleteLater);
 
   workerThread->start(QThread::NormalPriority);
 
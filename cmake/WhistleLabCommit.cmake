@@ -0,0 +1,38 @@
+# Writes the commit of the source tree to a header. This script runs on every build (see CMakeLists.txt), but the
+# header is only rewritten if the commit has changed, so that nothing is recompiled otherwise.
+#
+# Variables: SOURCE_DIR (the root of the source tree), OUTPUT (the header that is written)
+
+execute_process(COMMAND git rev-parse --short HEAD
+  WORKING_DIRECTORY "${SOURCE_DIR}"
+  OUTPUT_VARIABLE COMMIT
+  OUTPUT_STRIP_TRAILING_WHITESPACE
+  ERROR_QUIET)
+if(NOT COMMIT)
+  set(COMMIT "unknown")
+else()
+  # Benchmarks of a tree with uncommitted changes to tracked files must not be attributed to the commit itself.
+  execute_process(COMMAND git status --porcelain --untracked-files=no
+    WORKING_DIRECTORY "${SOURCE_DIR}"
+    OUTPUT_VARIABLE CHANGES
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+  if(CHANGES)
+    set(COMMIT "${COMMIT}-dirty")
+  endif()
+endif()
+
+set(CONTENT "/**
+ * @file WhistleLabCommit.hpp defines the commit of the source tree (generated by cmake/WhistleLabCommit.cmake)
+ */
+
+#pragma once
+
+#define WHISTLELAB_COMMIT \"${COMMIT}\"
+")
+if(EXISTS "${OUTPUT}")
+  file(READ "${OUTPUT}" OLD_CONTENT)
+endif()
+if(NOT CONTENT STREQUAL OLD_CONTENT)
+  file(WRITE "${OUTPUT}" "${CONTENT}")
+endif()